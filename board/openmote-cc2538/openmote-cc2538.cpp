@@ -118,6 +118,10 @@
 #define UART_INT                ( INT_UART0 )
 #define UART_BAUDRATE           ( 115200 )
 #define UART_MODE               ( UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE )
+#define UART_FIFO               ( true )
+#define UART_FIFO_RX            ( UART_FIFO_RX4_8 )
+#define UART_DMA_TX_CH          ( UDMA_CH9_UART0TX )
+#define UART_DMA_RX_CH          ( 0 ) // UDMA_CH8_UART0RX to receive with uDMA
 
 #define UART_RX_PORT            ( GPIO_A_BASE )
 #define UART_RX_PIN             ( GPIO_PIN_0 )
@@ -249,7 +253,7 @@ Spi spi(spi_miso, spi_mosi, spi_clk, spi_ncs, spi_cfg);
 // UART peripheral
 GpioConfig uart_rx_cfg = {UART_RX_PORT, UART_RX_PIN, UART_RX_IOC, 0, 0};
 GpioConfig uart_tx_cfg = {UART_TX_PORT, UART_TX_PIN, UART_TX_IOC, 0, 0};
-UartConfig uart_cfg = {UART_PERIPHERAL, UART_BASE, UART_CLOCK, UART_INT, UART_BAUDRATE, UART_MODE};
+UartConfig uart_cfg = {UART_PERIPHERAL, UART_BASE, UART_CLOCK, UART_INT, UART_BAUDRATE, UART_MODE, UART_FIFO, UART_FIFO_RX, UART_DMA_TX_CH, UART_DMA_RX_CH};
 Gpio uart_rx(uart_rx_cfg);
 Gpio uart_tx(uart_tx_cfg);
 Uart uart(uart_rx, uart_tx, uart_cfg);
@@ -90,6 +90,9 @@ task.h is included from an application file. */
 static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
 static size_t xNextFreeByte = ( size_t ) 0;
 
+/* Count the blocks handed out, see vPortGetHeapStats(). */
+static size_t xNumberOfSuccessfulAllocations = 0;
+
 /*-----------------------------------------------------------*/
 
 void *pvPortMalloc( size_t xWantedSize )
@@ -122,6 +125,7 @@ static uint8_t *pucAlignedHeap = NULL;
 			block. */
 			pvReturn = pucAlignedHeap + xNextFreeByte;
 			xNextFreeByte += xWantedSize;
+			xNumberOfSuccessfulAllocations++;
 		}
 
 		traceMALLOC( pvReturn, xWantedSize );
@@ -165,6 +169,28 @@ size_t xPortGetFreeHeapSize( void )
 {
 	return ( configADJUSTED_HEAP_SIZE - xNextFreeByte );
 }
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t *pxHeapStats )
+{
+size_t xFree;
+
+	vTaskSuspendAll();
+	{
+		/* Nothing is ever freed, so the rest of the heap is a single block
+		and the free bytes only go down. */
+		xFree = configADJUSTED_HEAP_SIZE - xNextFreeByte;
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFree;
+		pxHeapStats->xSizeOfLargestFreeBlockInBytes = xFree;
+		pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xFree;
+		pxHeapStats->xNumberOfFreeBlocks = ( xFree > 0 ) ? 1 : 0;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xFree;
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = 0;
+	}
+	( void ) xTaskResumeAll();
+}
 
 
 
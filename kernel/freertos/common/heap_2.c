@@ -113,6 +113,11 @@ static BlockLink_t xStart, xEnd;
 /* Keeps track of the number of free bytes remaining, but says nothing about
 fragmentation. */
 static size_t xFreeBytesRemaining = configADJUSTED_HEAP_SIZE;
+static size_t xMinimumEverFreeBytesRemaining = configADJUSTED_HEAP_SIZE;
+
+/* Count the blocks handed out and returned, see vPortGetHeapStats(). */
+static size_t xNumberOfSuccessfulAllocations = 0;
+static size_t xNumberOfSuccessfulFrees = 0;
 
 /* STATIC FUNCTIONS ARE DEFINED AS MACROS TO MINIMIZE THE FUNCTION CALL DEPTH. */
 
@@ -213,6 +218,13 @@ void *pvReturn = NULL;
 				}
 
 				xFreeBytesRemaining -= pxBlock->xBlockSize;
+
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+
+				xNumberOfSuccessfulAllocations++;
 			}
 		}
 
@@ -254,6 +266,7 @@ BlockLink_t *pxLink;
 			/* Add this block to the list of free blocks. */
 			prvInsertBlockIntoFreeList( ( ( BlockLink_t * ) pxLink ) );
 			xFreeBytesRemaining += pxLink->xBlockSize;
+			xNumberOfSuccessfulFrees++;
 			traceFREE( pv, pxLink->xBlockSize );
 		}
 		( void ) xTaskResumeAll();
@@ -267,6 +280,59 @@ size_t xPortGetFreeHeapSize( void )
 }
 /*-----------------------------------------------------------*/
 
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t *pxHeapStats )
+{
+BlockLink_t *pxBlock;
+size_t xBlocks = 0, xMaxSize = 0, xMinSize = 0;
+
+	vTaskSuspendAll();
+	{
+		pxBlock = xStart.pxNextFreeBlock;
+
+		if( pxBlock == NULL )
+		{
+			/* The heap is initialised by the first pvPortMalloc() call, until
+			then it is a single free block. */
+			xBlocks = 1;
+			xMaxSize = configADJUSTED_HEAP_SIZE;
+			xMinSize = configADJUSTED_HEAP_SIZE;
+		}
+		else
+		{
+			/* The free blocks are ordered by size, smallest first, up to the
+			end marker. */
+			while( pxBlock != &xEnd )
+			{
+				if( xBlocks == 0 )
+				{
+					xMinSize = pxBlock->xBlockSize;
+				}
+
+				xMaxSize = pxBlock->xBlockSize;
+				xBlocks++;
+
+				pxBlock = pxBlock->pxNextFreeBlock;
+			}
+		}
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xSizeOfLargestFreeBlockInBytes = xMaxSize;
+		pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xMinSize;
+		pxHeapStats->xNumberOfFreeBlocks = xBlocks;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+	}
+	( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
 void vPortInitialiseBlocks( void )
 {
 	/* This just exists to keep the linker quiet. */
@@ -87,6 +87,10 @@ task.h is included from an application file. */
 
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
+/* Count the blocks handed out and returned, see vPortGetHeapStats(). */
+static size_t xNumberOfSuccessfulAllocations = 0;
+static size_t xNumberOfSuccessfulFrees = 0;
+
 /*-----------------------------------------------------------*/
 
 void *pvPortMalloc( size_t xWantedSize )
@@ -96,6 +100,10 @@ void *pvReturn;
 	vTaskSuspendAll();
 	{
 		pvReturn = malloc( xWantedSize );
+		if( pvReturn != NULL )
+		{
+			xNumberOfSuccessfulAllocations++;
+		}
 		traceMALLOC( pvReturn, xWantedSize );
 	}
 	( void ) xTaskResumeAll();
@@ -121,11 +129,30 @@ void vPortFree( void *pv )
 		vTaskSuspendAll();
 		{
 			free( pv );
+			xNumberOfSuccessfulFrees++;
 			traceFREE( pv, 0 );
 		}
 		( void ) xTaskResumeAll();
 	}
 }
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t *pxHeapStats )
+{
+	/* The C library owns the heap, so only the calls are counted and the
+	sizes are left at zero. */
+	vTaskSuspendAll();
+	{
+		pxHeapStats->xAvailableHeapSpaceInBytes = 0;
+		pxHeapStats->xSizeOfLargestFreeBlockInBytes = 0;
+		pxHeapStats->xSizeOfSmallestFreeBlockInBytes = 0;
+		pxHeapStats->xNumberOfFreeBlocks = 0;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = 0;
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+	}
+	( void ) xTaskResumeAll();
+}
 
 
 
@@ -372,6 +372,23 @@ void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Used to pass information about the heap out of vPortGetHeapStats(). All the
+ * heap_x.c files implement it, but heap_3.c only counts the calls.
+ */
+typedef struct xHEAP_STATS
+{
+	size_t xAvailableHeapSpaceInBytes;		/*<< The sum of all the free blocks, not the largest block that can be allocated. */
+	size_t xSizeOfLargestFreeBlockInBytes;	/*<< The size of the largest free block. */
+	size_t xSizeOfSmallestFreeBlockInBytes;	/*<< The size of the smallest free block. */
+	size_t xNumberOfFreeBlocks;				/*<< The number of free blocks in the heap. */
+	size_t xMinimumEverFreeBytesRemaining;	/*<< The minimum amount of free heap since the system booted. */
+	size_t xNumberOfSuccessfulAllocations;	/*<< The number of calls to pvPortMalloc() that returned a block. */
+	size_t xNumberOfSuccessfulFrees;		/*<< The number of calls to vPortFree() that returned a block. */
+} HeapStats_t;
+
+void vPortGetHeapStats( HeapStats_t *pxHeapStats ) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
@@ -13,8 +13,11 @@
 
 #include "EthernetFrame.h"
 
+#include "Crc.h"
+
 /*================================ define ===================================*/
 
+static const uint32_t MIN_ETHERNET_LENGTH = 64;
 static const uint32_t MAX_ETHERNET_LENGTH = 1518;
 
 /*================================ typedef ==================================*/
@@ -51,9 +54,26 @@ void EthernetFrame::setLength(uint32_t length)
     buffer_len = length;
 }
 
+/**
+ * Checks the length and the CRC-32 FCS of a frame whose buffer still holds
+ * the FCS in its last four bytes, as sent on the wire.
+ */
 bool EthernetFrame::isValid()
 {
-    return false;
+    CrcEthernet crc;
+
+    // Check that the frame length is within the Ethernet limits
+    if ((buffer_len < MIN_ETHERNET_LENGTH) ||
+        (buffer_len > MAX_ETHERNET_LENGTH))
+    {
+        return false;
+    }
+
+    // A frame followed by its FCS leaves the CRC-32 residue behind
+    crc.init();
+    crc.update(buffer_ptr, buffer_len);
+
+    return crc.check();
 }
 
 /*=============================== protected =================================*/
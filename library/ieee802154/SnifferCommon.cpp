@@ -15,9 +15,20 @@
 
 #include "SnifferCommon.h"
 #include "Gpio.h"
+#include "Crc.h"
 
 /*================================ define ===================================*/
 
+/**
+ * When set, the trailer carries the IEEE 802.15.4 FCS rebuilt from the
+ * payload instead of the RSSI and CRC_OK/LQI bytes that Radio::getPacket
+ * leaves in its place. Frames that failed the radio CRC check get an
+ * inverted FCS so that they still fail on the host.
+ */
+#ifndef SNIFFER_FCS
+#define SNIFFER_FCS                         ( 0 )
+#endif
+
 /*================================ typedef ==================================*/
 
 /*=============================== prototypes ================================*/
@@ -32,12 +43,8 @@ const uint8_t SnifferCommon::ethernetType[2]     = {0x80, 0x9A};
 
 /*================================= public ==================================*/
 
-SnifferCommon::SnifferCommon(Board& board, Radio& radio):
-    board_(board), radio_(radio), semaphore(false), \
-    snifferRadioRxInitCallback_(this, &SnifferCommon::radioRxInitCallback), \
-    snifferRadioRxDoneCallback_(this, &SnifferCommon::radioRxDoneCallback), \
-    radioBuffer_ptr(radioBuffer), radioBuffer_len(sizeof(radioBuffer)), \
-    outputBuffer_ptr(outputBuffer), outputBuffer_len(sizeof(outputBuffer))
+SnifferCommon::SnifferCommon(Board& board, Radio& radio, PacketPool& pool):
+    board_(board), radio_(radio), pool_(pool), queue_()
 {
 }
 
@@ -47,12 +54,18 @@ void SnifferCommon::init(void)
     board_.getEUI48(macAddress);
 
     // Set Radio receive callbacks
-    radio_.setRxCallbacks(&snifferRadioRxInitCallback_, \
-                          &snifferRadioRxDoneCallback_);
+    radio_.setRxCallbacks(Delegate::create<SnifferCommon, &SnifferCommon::radioRxInitCallback>(this), \
+                          Delegate::create<SnifferCommon, &SnifferCommon::radioRxDoneCallback>(this));
+
+    // Keep receiving, the radio hands each frame over in a packet
+    radio_.enableContinuous(pool_, queue_);
 
     // Enable Radio module
     radio_.enable();
     radio_.enableInterrupts();
+
+    // Capture every frame on the channel, whoever it is for
+    radio_.setPromiscuous();
 }
 
 void SnifferCommon::start(void)
@@ -76,40 +89,48 @@ void SnifferCommon::setChannel(uint8_t channel)
     radio_.setChannel(channel);
 }
 
-void SnifferCommon::initFrame(uint8_t* buffer, uint8_t length, int8_t rssi, uint8_t lqi, uint8_t crc)
+/**
+ * Wraps the IEEE 802.15.4 payload held in the packet into an Ethernet
+ * frame in place: the Ethernet header is prepended into the headroom and
+ * the padding and trailer are appended into the tailroom, so the payload
+ * is never copied. Returns false if the packet does not have the room.
+ */
+bool SnifferCommon::initFrame(Packet* packet, int8_t rssi, uint8_t lqi, uint8_t crc)
 {
+    uint8_t* header;
+    uint8_t* padding;
+    uint8_t* trailer;
+
     // Pre-calculate the frame length
+    uint32_t length = packet->getLength();
     uint32_t frameLength = 6 + 2 + 6 + length + 2;
 
-    // Check that we do not overflow the Ethernet buffer
-    if (frameLength > outputBuffer_len)
+#if (SNIFFER_FCS == 1)
+    // Rebuild the IEEE 802.15.4 FCS, keeping bad frames bad
+    uint16_t fcs = CrcIeee802154::compute(packet->getData(), length);
+    if (!crc)
     {
-        return;
+        fcs = ~fcs;
     }
+#endif
 
-    // Reset the Ethernet buffer length
-    outputBuffer_len = 0;
+    // Prepend the Ethernet header to the IEEE 802.15.4 payload
+    header = packet->prepend(6 + 6 + 2);
+    if (header == nullptr) return false;
 
     // Set MAC destination address
-    memcpy(&outputBuffer[0], SnifferCommon::broadcastAddress, 6);
-    outputBuffer_len += 6;
+    memcpy(&header[0], SnifferCommon::broadcastAddress, 6);
 
     // Set MAC source address
-    memcpy(&outputBuffer[6], &macAddress, 6);
-    outputBuffer_len += 6;
+    memcpy(&header[6], &macAddress, 6);
 
     // Set MAC type
-    memcpy(&outputBuffer[12], SnifferCommon::ethernetType, 2);
-    outputBuffer_len += 2;
+    memcpy(&header[12], SnifferCommon::ethernetType, 2);
 
     // Need to set the PHR field?
     // memset(&ethernetBuffer[14], length, 1);
     // ethernetBuffer_len += 1;
 
-    // Copy the IEEE 802.15.4 payload
-    memcpy(&outputBuffer[14], buffer, length);
-    outputBuffer_len += length;
-
     // Ensure that we meet the minimum Ethernet frame size
     if (frameLength < 60)
     {
@@ -117,17 +138,28 @@ void SnifferCommon::initFrame(uint8_t* buffer, uint8_t length, int8_t rssi, uint
         uint32_t bytes = 60 - frameLength;
 
         // Fill the remaining space with zeros
-        memset(&outputBuffer[outputBuffer_len], 0x00, bytes);
-        outputBuffer_len += bytes;
+        padding = packet->append(bytes);
+        if (padding == nullptr) return false;
+        memset(padding, 0x00, bytes);
     }
 
+    // Append the trailer
+    trailer = packet->append(2);
+    if (trailer == nullptr) return false;
+
+#if (SNIFFER_FCS == 1)
+    // Copy the IEEE 802.15.4 FCS, least significant byte first
+    trailer[0] = (uint8_t) (fcs >> 0);
+    trailer[1] = (uint8_t) (fcs >> 8);
+#else
     // Copy the IEEE 802.15.4 RSSI
-    outputBuffer[outputBuffer_len] = rssi;
-    outputBuffer_len += 1;
+    trailer[0] = rssi;
 
     // Copy the IEEE 802.15.4 CRC and LQI
-    outputBuffer[outputBuffer_len] = crc | lqi;
-    outputBuffer_len += 1;
+    trailer[1] = crc | lqi;
+#endif
+
+    return true;
 }
 
 /*================================ private ==================================*/
@@ -140,5 +172,4 @@ void SnifferCommon::radioRxInitCallback(void)
 void SnifferCommon::radioRxDoneCallback(void)
 {
     led_red.off();
-    semaphore.giveFromInterrupt();
 }
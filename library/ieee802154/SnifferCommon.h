@@ -14,47 +14,33 @@
 
 #include "Board.h"
 #include "Callback.h"
-#include "Semaphore.h"
+#include "Packet.h"
 #include "Radio.h"
 
-class SnifferCommon;
-
-typedef GenericCallback<SnifferCommon> SnifferCallback;
-
 class SnifferCommon
 {
 public:
-    SnifferCommon(Board& board, Radio& radio);
+    SnifferCommon(Board& board, Radio& radio, PacketPool& pool);
     void init(void);
     void start(void);
     void stop(void);
     void setChannel(uint8_t channel);
     virtual void processRadioFrame(void) = 0;
-    void initFrame(uint8_t* buffer, uint8_t length, int8_t rssi, uint8_t lqi, uint8_t crc);
+    bool initFrame(Packet* packet, int8_t rssi, uint8_t lqi, uint8_t crc);
 protected:
     void radioRxInitCallback(void);
     void radioRxDoneCallback(void);
 protected:
     Board& board_;
     Radio& radio_;
+    PacketPool& pool_;
 
-    SemaphoreBinary semaphore;
-
-    SnifferCallback snifferRadioRxInitCallback_;
-    SnifferCallback snifferRadioRxDoneCallback_;
+    RadioRxQueue queue_;
 
     uint8_t macAddress[6];
     static const uint8_t broadcastAddress[6];
     static const uint8_t ethernetType[2];
 
-    uint8_t  radioBuffer[128];
-    uint8_t* radioBuffer_ptr;
-    uint8_t  radioBuffer_len;
-
-    uint8_t  outputBuffer[255];
-    uint8_t* outputBuffer_ptr;
-    uint32_t outputBuffer_len;
-
     int8_t  rssi;
     uint8_t lqi;
     uint8_t crc;
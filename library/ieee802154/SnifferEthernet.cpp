@@ -25,8 +25,8 @@
 
 /*================================= public ==================================*/
 
-SnifferEthernet::SnifferEthernet(Board& board, Radio& radio, Ethernet& ethernet):
-    SnifferCommon(board, radio), ethernet_(ethernet)
+SnifferEthernet::SnifferEthernet(Board& board, Radio& radio, PacketPool& pool, Ethernet& ethernet):
+    SnifferCommon(board, radio, pool), ethernet_(ethernet)
 {
 }
 
@@ -39,28 +39,25 @@ void SnifferEthernet::init(void)
 void SnifferEthernet::processRadioFrame(void)
 {
     RadioResult result;
+    Packet* packet;
 
-    // This call blocks until a radio frame is received
-    if (semaphore.take())
+    // This call blocks until the radio hands over a frame
+    if (queue_.receive(packet))
     {
-        // Get packet from the radio
-        radioBuffer_ptr = radioBuffer;
-        radioBuffer_len = sizeof(radioBuffer);
-        result = radio_.getPacket(radioBuffer_ptr, &radioBuffer_len, &rssi, &lqi, &crc);
+        // Take the RSSI and CRC/LQI bytes off the radio frame
+        result = radio_.getPacket(packet, &rssi, &lqi, &crc);
 
-        if (result == RadioResult_Success)
+        // Wrap the radio frame in place
+        if (result == RadioResult_Success &&
+            initFrame(packet, rssi, lqi, crc))
         {
-            // Turn off the radio
-            radio_.off();
-
-            // Initialize Ethernet frame
-            outputBuffer_ptr = outputBuffer;
-            outputBuffer_len = sizeof(outputBuffer);
-            initFrame(radioBuffer_ptr, radioBuffer_len, rssi, lqi, crc);
-
-            // Transmit the radio frame over Ethernet
-            ethernet_.transmitFrame(outputBuffer_ptr, outputBuffer_len);
+            // Transmit the radio frame over Ethernet, which returns once
+            // the controller has taken it
+            ethernet_.transmitFrame(packet->getData(), packet->getLength());
         }
+
+        // Release the packet buffer
+        packet->release();
     }
 }
 
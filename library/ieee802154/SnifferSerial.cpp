@@ -25,36 +25,37 @@
 
 /*================================= public ==================================*/
 
-SnifferSerial::SnifferSerial(Board& board, Radio& radio, Serial& serial):
-    SnifferCommon(board, radio), serial_(serial)
+SnifferSerial::SnifferSerial(Board& board, Radio& radio, PacketPool& pool, Serial& serial):
+    SnifferCommon(board, radio, pool), serial_(serial)
 {
 }
 
 void SnifferSerial::processRadioFrame(void)
 {
     RadioResult result;
+    Packet* packet;
 
-    // This call blocks until a radio frame is received
-    if (semaphore.take())
+    // This call blocks until the radio hands over a frame
+    if (queue_.receive(packet))
     {
-        // Get packet from the radio
-        radioBuffer_ptr = radioBuffer;
-        radioBuffer_len = sizeof(radioBuffer);
-        result = radio_.getPacket(radioBuffer_ptr, &radioBuffer_len, &rssi, &lqi, &crc);
+        // Take the RSSI and CRC/LQI bytes off the radio frame
+        result = radio_.getPacket(packet, &rssi, &lqi, &crc);
 
-        if (result == RadioResult_Success)
+        // Wrap the radio frame in place
+        if (result == RadioResult_Success &&
+            initFrame(packet, rssi, lqi, crc))
         {
-            // Turn off the radio
-            radio_.off();
-
-            // Initialize Serial frame
-            outputBuffer_ptr = outputBuffer;
-            outputBuffer_len = sizeof(outputBuffer);
-            initFrame(radioBuffer_ptr, radioBuffer_len, rssi, lqi, crc);
-
-            // Transmit the radio frame over Serial
-            serial_.write(outputBuffer_ptr, outputBuffer_len);
+            // Keep the packet until the frame has been sent over Serial
+            packet->retain();
+            if (!serial_.write(packet->getData(), packet->getLength(), \
+                               Delegate::create<Packet, &Packet::release>(packet)))
+            {
+                packet->release();
+            }
         }
+
+        // Release the packet buffer
+        packet->release();
     }
 }
 
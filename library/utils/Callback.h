@@ -53,4 +53,51 @@ private:
 
 /*****************************************************************************/
 
+/**
+ * Callback without a vtable: an object pointer and a stub that calls the
+ * member function or plain function the delegate was created for. The
+ * target is a template argument, so the stub calls it directly and the
+ * dispatch costs a single indirect call. The arguments, if any, are passed
+ * on to the target, e.g. a received frame to its handler. A Delegate can
+ * also wrap a Callback explicitly, for GenericCallback and PlainCallback
+ * objects that have not moved over yet, but that adds the stub to the
+ * virtual call and is slower than the Callback alone, see
+ * test/host/callback.
+ *
+ *   Delegate::create<Serial, &Serial::rxCallback>(this)
+ *   Delegate::create<radioRxDoneCallback>()
+ */
+template<typename... Args>
+class BasicDelegate
+{
+public:
+    BasicDelegate(void):
+                  object_(nullptr), stub_(nullptr){}
+    explicit BasicDelegate(Callback* callback):
+                  object_(callback), stub_(callback ? &callbackStub : nullptr)
+                  {static_assert(sizeof...(Args) == 0, "A Callback takes no arguments!");}
+    template<typename T, void(T:: *Method)(Args...)>
+    static BasicDelegate create(T* object) {return BasicDelegate(object, &methodStub<T, Method>);}
+    template<void(*Function)(Args...)>
+    static BasicDelegate create(void) {return BasicDelegate(nullptr, &functionStub<Function>);}
+    void execute(Args... args) const {stub_(object_, args...);}
+    bool isValid(void) const {return (stub_ != nullptr);}
+private:
+    typedef void(*stub_t)(void*, Args...);
+    BasicDelegate(void* object, stub_t stub):
+                  object_(object), stub_(stub){}
+    template<typename T, void(T:: *Method)(Args...)>
+    static void methodStub(void* object, Args... args) {(static_cast<T*>(object)->*Method)(args...);}
+    template<void(*Function)(Args...)>
+    static void functionStub(void* object, Args... args) {Function(args...);}
+    static void callbackStub(void* object, Args... args) {static_cast<Callback*>(object)->execute();}
+private:
+    void* object_;
+    stub_t stub_;
+};
+
+typedef BasicDelegate<> Delegate;
+
+/*****************************************************************************/
+
 #endif /* CALLBACK_H_ */
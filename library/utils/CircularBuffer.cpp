@@ -26,50 +26,289 @@
 /*================================= public ==================================*/
 
 CircularBuffer::CircularBuffer(uint8_t* buffer, uint32_t length):
-    Buffer(buffer, length)
-{   
+    buffer_(buffer), length_(length), head_(0), tail_(0)
+{
 }
 
+/**
+ * Discards the buffer contents. Unlike the other methods this touches both
+ * indices, so it may only be called while neither the producer nor the
+ * consumer is using the buffer (e.g. with the interrupt source disabled).
+ */
 void CircularBuffer::reset(void)
 {
-	Buffer::reset();
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_release);
 }
 
 uint32_t CircularBuffer::getSize(void)
 {
-	return Buffer::getSize();
+    uint32_t head = head_.load(std::memory_order_acquire);
+    uint32_t tail = tail_.load(std::memory_order_acquire);
+
+    return distance(tail, head);
+}
+
+uint32_t CircularBuffer::getFree(void)
+{
+    return (length_ - getSize());
 }
 
 bool CircularBuffer::isEmpty(void)
 {
-	return Buffer::isEmpty();
+    return (getSize() == 0);
 }
 
 bool CircularBuffer::isFull(void)
 {
-	return Buffer::isFull();	
+    return (getSize() == length_);
 }
 
 bool CircularBuffer::read(uint8_t* data)
 {
-	return Buffer::read(data);
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    uint32_t head = head_.load(std::memory_order_acquire);
+
+    // Check if buffer is empty
+    if (head == tail)
+    {
+        return false;
+    }
+
+    // Read data out
+    *data = buffer_[offset(tail)];
+
+    // Release the slot to the producer
+    tail_.store(advance(tail, 1), std::memory_order_release);
+
+    return true;
 }
 
 bool CircularBuffer::read(uint8_t* buffer, uint32_t length)
 {
-	return Buffer::read(buffer, length);
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    uint32_t head = head_.load(std::memory_order_acquire);
+    uint32_t position, first;
+
+    // Check that all the requested data is available
+    if (distance(tail, head) < length)
+    {
+        return false;
+    }
+
+    // Copy the segment up to the end of the buffer
+    position = offset(tail);
+    first = length_ - position;
+    if (first > length)
+    {
+        first = length;
+    }
+    memcpy(buffer, &buffer_[position], first);
+
+    // Copy the segment that wrapped to the start of the buffer
+    memcpy(&buffer[first], buffer_, length - first);
+
+    // Release the slots to the producer
+    tail_.store(advance(tail, length), std::memory_order_release);
+
+    return true;
 }
 
 bool CircularBuffer::write(uint8_t data)
 {
-	return Buffer::write(data);
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t tail = tail_.load(std::memory_order_acquire);
+
+    // Check if buffer is full
+    if (distance(tail, head) == length_)
+    {
+        return false;
+    }
+
+    // Write data in
+    buffer_[offset(head)] = data;
+
+    // Publish the byte to the consumer
+    head_.store(advance(head, 1), std::memory_order_release);
+
+    return true;
 }
 
 bool CircularBuffer::write(const uint8_t* data, uint32_t length)
 {
-	return Buffer::write(data, length);
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t tail = tail_.load(std::memory_order_acquire);
+    uint32_t position, first;
+
+    // Check that all the data fits
+    if (length_ - distance(tail, head) < length)
+    {
+        return false;
+    }
+
+    // Copy the segment up to the end of the buffer
+    position = offset(head);
+    first = length_ - position;
+    if (first > length)
+    {
+        first = length;
+    }
+    memcpy(&buffer_[position], data, first);
+
+    // Copy the segment that wraps to the start of the buffer
+    memcpy(buffer_, &data[first], length - first);
+
+    // Publish the bytes to the consumer
+    head_.store(advance(head, length), std::memory_order_release);
+
+    return true;
+}
+
+/**
+ * Returns the number of pending bytes that can be read contiguously from
+ * *data. The bytes stay in the buffer until they are released with
+ * commitRead, so this may only be called from the consumer side.
+ */
+uint32_t CircularBuffer::peekRead(uint8_t** data)
+{
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    uint32_t head = head_.load(std::memory_order_acquire);
+    uint32_t position, available, contiguous;
+
+    position = offset(tail);
+    available = distance(tail, head);
+    contiguous = length_ - position;
+
+    *data = &buffer_[position];
+
+    return (available < contiguous ? available : contiguous);
+}
+
+bool CircularBuffer::commitRead(uint32_t length)
+{
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    uint32_t head = head_.load(std::memory_order_acquire);
+
+    // Check that we do not release more than is pending
+    if (distance(tail, head) < length)
+    {
+        return false;
+    }
+
+    // Release the slots to the producer
+    tail_.store(advance(tail, length), std::memory_order_release);
+
+    return true;
+}
+
+/**
+ * Returns the number of free bytes that can be written contiguously to
+ * *data. Nothing is visible to the consumer until the bytes are published
+ * with commitWrite, so this may only be called from the producer side.
+ */
+uint32_t CircularBuffer::peekWrite(uint8_t** data)
+{
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t tail = tail_.load(std::memory_order_acquire);
+    uint32_t position, available, contiguous;
+
+    position = offset(head);
+    available = length_ - distance(tail, head);
+    contiguous = length_ - position;
+
+    *data = &buffer_[position];
+
+    return (available < contiguous ? available : contiguous);
+}
+
+/**
+ * Copies data to the free space, start bytes past the head. The
+ * bytes are not visible to the consumer until they are published with
+ * commitWrite, so this may only be called from the producer side.
+ */
+bool CircularBuffer::writeAt(uint32_t start, const uint8_t* data, uint32_t length)
+{
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t tail = tail_.load(std::memory_order_acquire);
+    uint32_t position, first;
+
+    // Check that the data fits in the free space
+    if (length_ - distance(tail, head) < start + length)
+    {
+        return false;
+    }
+
+    // Copy the segment up to the end of the buffer
+    position = offset(advance(head, start));
+    first = length_ - position;
+    if (first > length)
+    {
+        first = length;
+    }
+    memcpy(&buffer_[position], data, first);
+
+    // Copy the segment that wraps to the start of the buffer
+    memcpy(buffer_, &data[first], length - first);
+
+    return true;
+}
+
+bool CircularBuffer::commitWrite(uint32_t length)
+{
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t tail = tail_.load(std::memory_order_acquire);
+
+    // Check that we do not publish more than is free
+    if (length_ - distance(tail, head) < length)
+    {
+        return false;
+    }
+
+    // Publish the bytes to the consumer
+    head_.store(advance(head, length), std::memory_order_release);
+
+    return true;
 }
 
 /*=============================== protected =================================*/
 
 /*================================ private ==================================*/
+
+uint32_t CircularBuffer::distance(uint32_t from, uint32_t to)
+{
+    // Indices wrap at twice the buffer length
+    if (to >= from)
+    {
+        return (to - from);
+    }
+    else
+    {
+        return (to + 2 * length_ - from);
+    }
+}
+
+uint32_t CircularBuffer::advance(uint32_t index, uint32_t count)
+{
+    index += count;
+
+    // Indices wrap at twice the buffer length
+    if (index >= 2 * length_)
+    {
+        index -= 2 * length_;
+    }
+
+    return index;
+}
+
+uint32_t CircularBuffer::offset(uint32_t index)
+{
+    // Map the index to a position in the buffer
+    if (index >= length_)
+    {
+        return (index - length_);
+    }
+    else
+    {
+        return index;
+    }
+}
@@ -12,21 +12,50 @@
 #ifndef CIRCULAR_BUFFER_H_
 #define CIRCULAR_BUFFER_H_
 
-#include "Buffer.h"
+#include <stdint.h>
 
-class CircularBuffer : public Buffer
+#include <atomic>
+
+/**
+ * Single-producer/single-consumer ring buffer. The producer only updates
+ * head_ and the consumer only updates tail_, so one side may run from an
+ * interrupt handler and the other from a task without taking any lock.
+ * Indices run over [0, 2 * length) so that a full and an empty buffer can
+ * be told apart without sacrificing one slot.
+ *
+ * The bulk read/write methods are all-or-nothing and copy at most two
+ * contiguous segments. The peek/commit methods expose the contiguous
+ * region at the head (free space) or tail (pending data) so that callers
+ * can fill or drain the ring in place, and writeAt stages data anywhere in
+ * the free space so that a record can be published in one commitWrite.
+ */
+class CircularBuffer
 {
 public:
     CircularBuffer(uint8_t* buffer, uint32_t length);
     void reset(void);
     uint32_t getSize(void);
+    uint32_t getFree(void);
     bool isEmpty(void);
     bool isFull(void);
     bool read(uint8_t* data);
     bool read(uint8_t* buffer, uint32_t length);
     bool write(uint8_t data);
     bool write(const uint8_t* data, uint32_t length);
+    uint32_t peekRead(uint8_t** data);
+    bool commitRead(uint32_t length);
+    uint32_t peekWrite(uint8_t** data);
+    bool writeAt(uint32_t start, const uint8_t* data, uint32_t length);
+    bool commitWrite(uint32_t length);
+private:
+    uint32_t distance(uint32_t from, uint32_t to);
+    uint32_t advance(uint32_t index, uint32_t count);
+    uint32_t offset(uint32_t index);
 private:
+    uint8_t* buffer_;
+    uint32_t length_;
+    std::atomic<uint32_t> head_;
+    std::atomic<uint32_t> tail_;
 };
 
 #endif /* CIRCULAR_BUFFER_H_ */
@@ -0,0 +1,261 @@
+/**
+ * @file       Crc.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Table-driven CRC engine with tables generated at compile time.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef CRC_H_
+#define CRC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Compile-time index sequence, built in logarithmic depth
+template<uint32_t... I>
+struct CrcSequence {};
+
+template<typename S1, typename S2>
+struct CrcConcat;
+
+template<uint32_t... I1, uint32_t... I2>
+struct CrcConcat<CrcSequence<I1...>, CrcSequence<I2...>>
+{
+    typedef CrcSequence<I1..., (sizeof...(I1) + I2)...> type;
+};
+
+template<uint32_t N>
+struct CrcMakeSequence
+{
+    typedef typename CrcConcat<typename CrcMakeSequence<N / 2>::type,
+                               typename CrcMakeSequence<N - N / 2>::type>::type type;
+};
+
+template<>
+struct CrcMakeSequence<0>
+{
+    typedef CrcSequence<> type;
+};
+
+template<>
+struct CrcMakeSequence<1>
+{
+    typedef CrcSequence<0> type;
+};
+
+/**
+ * Generates the lookup tables of a CRC when compiling. table[k][x] is the
+ * contribution of byte x once k more bytes have been folded in, i.e. the
+ * plain table (k = 0) advanced by k zero bytes.
+ */
+template<typename T, T Polynomial, bool Reflected, bool MsbFirst, uint32_t Slices>
+struct CrcTable
+{
+    T value[Slices][256];
+
+    static const uint32_t width = 8 * sizeof(T);
+
+    // Shift count bits through the polynomial division
+    static constexpr T bits(T crc, uint32_t count)
+    {
+        return (count == 0) ? crc :
+               Reflected ? bits((T) ((crc & 1) ? ((crc >> 1) ^ Polynomial) : (crc >> 1)), count - 1) :
+                           bits((T) (((crc >> (width - 1)) & 1) ? ((crc << 1) ^ Polynomial) : (crc << 1)), count - 1);
+    }
+
+    static constexpr T entry(uint8_t byte)
+    {
+        return Reflected ? bits((T) byte, 8) : bits((T) ((T) byte << (width - 8)), 8);
+    }
+
+    // Same fold as Crc::set, on entries computed instead of looked up
+    static constexpr T step(T crc, uint8_t byte)
+    {
+        return MsbFirst ? (T) (entry(byte ^ (uint8_t) (crc >> (width - 8))) ^ (crc << 8)) :
+                          (T) (entry(byte ^ (uint8_t) crc) ^ (crc >> 8));
+    }
+
+    static constexpr T slice(uint32_t k, uint8_t byte)
+    {
+        return (k == 0) ? entry(byte) : step(slice(k - 1, byte), 0);
+    }
+
+    template<uint32_t... I>
+    static constexpr CrcTable make(CrcSequence<I...>)
+    {
+        return CrcTable{{slice(I / 256, (uint8_t) (I % 256))...}};
+    }
+};
+
+/**
+ * CRC engine parameterised by register type, polynomial, bit order, seed,
+ * final XOR and residue. The polynomial is given in the bit order of the
+ * table, i.e. already reflected when Reflected is set (0x8408 rather than
+ * 0x1021). MsbFirst selects which end of the register each byte is folded
+ * into; it normally matches Reflected, but the HDLC CRC of this code base
+ * folds MSB-first over a reflected table and is kept for compatibility.
+ *
+ * update() folds Slices bytes per round, one lookup per byte, and needs
+ * Slices tables of 256 entries. All of them are generated when compiling,
+ * so every CRC shares one kernel and the slice tables are bit-exact with
+ * the plain table by construction.
+ */
+template<typename T, T Polynomial, bool Reflected, bool MsbFirst,
+         T Seed, T XorOut, T Residue, uint32_t Slices>
+class Crc
+{
+    static_assert(sizeof(T) >= 2, "The CRC register must be at least 16 bits!");
+    static_assert(Slices == 1 || Slices >= sizeof(T), "Slices must cover the CRC register!");
+public:
+    typedef CrcTable<T, Polynomial, Reflected, MsbFirst, Slices> Table;
+public:
+    Crc();
+    void init(void);
+    T get(void);
+    void set(uint8_t byte);
+    void update(const uint8_t* data, size_t length);
+    bool check(void);
+    static T compute(const uint8_t* data, size_t length);
+private:
+    static T fold(T crc, uint8_t byte);
+    template<uint32_t I>
+    static T fold(const uint8_t* data, T crc, CrcSequence<I>);
+    static T fold(const uint8_t* data, T crc, CrcSequence<Slices>);
+private:
+    static const uint32_t width = 8 * sizeof(T);
+    static constexpr Table table = Table::make(typename CrcMakeSequence<Slices * 256>::type());
+    T crc;
+};
+
+/*================================= public ==================================*/
+
+template<typename T, T Polynomial, bool Reflected, bool MsbFirst, T Seed, T XorOut, T Residue, uint32_t Slices>
+Crc<T, Polynomial, Reflected, MsbFirst, Seed, XorOut, Residue, Slices>::Crc():
+    crc(Seed)
+{
+}
+
+template<typename T, T Polynomial, bool Reflected, bool MsbFirst, T Seed, T XorOut, T Residue, uint32_t Slices>
+void Crc<T, Polynomial, Reflected, MsbFirst, Seed, XorOut, Residue, Slices>::init(void)
+{
+    crc = Seed;
+}
+
+template<typename T, T Polynomial, bool Reflected, bool MsbFirst, T Seed, T XorOut, T Residue, uint32_t Slices>
+T Crc<T, Polynomial, Reflected, MsbFirst, Seed, XorOut, Residue, Slices>::get(void)
+{
+    return (T) (crc ^ XorOut);
+}
+
+template<typename T, T Polynomial, bool Reflected, bool MsbFirst, T Seed, T XorOut, T Residue, uint32_t Slices>
+void Crc<T, Polynomial, Reflected, MsbFirst, Seed, XorOut, Residue, Slices>::set(uint8_t byte)
+{
+    crc = fold(crc, byte);
+}
+
+template<typename T, T Polynomial, bool Reflected, bool MsbFirst, T Seed, T XorOut, T Residue, uint32_t Slices>
+void Crc<T, Polynomial, Reflected, MsbFirst, Seed, XorOut, Residue, Slices>::update(const uint8_t* data, size_t length)
+{
+    T value = crc;
+
+    // Fold Slices bytes per round, the register only overlaps the first ones
+    while (Slices > 1 && length >= Slices)
+    {
+        value = fold(data, value, CrcSequence<0>());
+        data += Slices;
+        length -= Slices;
+    }
+
+    // Fold the remaining bytes one at a time
+    while (length--)
+    {
+        value = fold(value, *data++);
+    }
+
+    crc = value;
+}
+
+template<typename T, T Polynomial, bool Reflected, bool MsbFirst, T Seed, T XorOut, T Residue, uint32_t Slices>
+bool Crc<T, Polynomial, Reflected, MsbFirst, Seed, XorOut, Residue, Slices>::check(void)
+{
+    return (crc == Residue);
+}
+
+template<typename T, T Polynomial, bool Reflected, bool MsbFirst, T Seed, T XorOut, T Residue, uint32_t Slices>
+T Crc<T, Polynomial, Reflected, MsbFirst, Seed, XorOut, Residue, Slices>::compute(const uint8_t* data, size_t length)
+{
+    Crc engine;
+
+    engine.update(data, length);
+
+    return engine.get();
+}
+
+/*================================ private ==================================*/
+
+template<typename T, T Polynomial, bool Reflected, bool MsbFirst, T Seed, T XorOut, T Residue, uint32_t Slices>
+inline T Crc<T, Polynomial, Reflected, MsbFirst, Seed, XorOut, Residue, Slices>::fold(T crc, uint8_t byte)
+{
+    // Fold one byte into the register end selected by MsbFirst
+    if (MsbFirst)
+    {
+        return (T) (table.value[0][byte ^ (uint8_t) (crc >> (width - 8))] ^ (crc << 8));
+    }
+    else
+    {
+        return (T) (table.value[0][byte ^ (uint8_t) crc] ^ (crc >> 8));
+    }
+}
+
+/**
+ * Folds byte I of a Slices round and recurses into byte I + 1, so that the
+ * round is unrolled at compile time. The register is consumed one byte at a
+ * time and runs out to zero past its width.
+ */
+template<typename T, T Polynomial, bool Reflected, bool MsbFirst, T Seed, T XorOut, T Residue, uint32_t Slices>
+template<uint32_t I>
+inline T Crc<T, Polynomial, Reflected, MsbFirst, Seed, XorOut, Residue, Slices>::fold(const uint8_t* data, T crc, CrcSequence<I>)
+{
+    if (MsbFirst)
+    {
+        return (T) (table.value[Slices - 1 - I][data[I] ^ (uint8_t) (crc >> (width - 8))] ^
+                    fold(data, (T) (crc << 8), CrcSequence<I + 1>()));
+    }
+    else
+    {
+        return (T) (table.value[Slices - 1 - I][data[I] ^ (uint8_t) crc] ^
+                    fold(data, (T) (crc >> 8), CrcSequence<I + 1>()));
+    }
+}
+
+template<typename T, T Polynomial, bool Reflected, bool MsbFirst, T Seed, T XorOut, T Residue, uint32_t Slices>
+inline T Crc<T, Polynomial, Reflected, MsbFirst, Seed, XorOut, Residue, Slices>::fold(const uint8_t* data, T crc, CrcSequence<Slices>)
+{
+    // Past the last byte of the round
+    return 0;
+}
+
+template<typename T, T Polynomial, bool Reflected, bool MsbFirst, T Seed, T XorOut, T Residue, uint32_t Slices>
+constexpr typename Crc<T, Polynomial, Reflected, MsbFirst, Seed, XorOut, Residue, Slices>::Table
+Crc<T, Polynomial, Reflected, MsbFirst, Seed, XorOut, Residue, Slices>::table;
+
+/*================================ typedef ==================================*/
+
+/**
+ * IEEE 802.15.4 FCS (ITU-T CRC-16, reflected, zero seed). The FCS is sent
+ * least significant byte first and a frame with its FCS leaves a zero
+ * register behind.
+ */
+typedef Crc<uint16_t, 0x8408, true, false, 0x0000, 0x0000, 0x0000, 4> CrcIeee802154;
+
+/**
+ * IEEE 802.3 FCS (CRC-32, reflected). The FCS is sent least significant
+ * byte first and a frame with its FCS leaves the 0xDEBB20E3 residue behind.
+ */
+typedef Crc<uint32_t, 0xEDB88320, true, false, 0xFFFFFFFF, 0xFFFFFFFF, 0xDEBB20E3, 4> CrcEthernet;
+
+#endif /* CRC_H_ */
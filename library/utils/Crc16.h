@@ -12,18 +12,25 @@
 #ifndef CRC16_H_
 #define CRC16_H_
 
-#include <stdint.h>
+#include "Crc.h"
 
-class Crc16
-{
-public:
-    Crc16();
-    void init(void);
-    uint16_t get(void);
-    void set(uint8_t byte);
-    bool check(void);
-private:
-    uint16_t crc;
-};
+/**
+ * Number of bytes folded per table lookup round by Crc16::update. Each
+ * slice adds a 512-byte table to flash: 1 keeps the single 512-byte table,
+ * 4, 8 and 16 use 2, 4 and 8 KB respectively.
+ */
+#ifndef CRC16_SLICES
+#define CRC16_SLICES                        ( 4 )
+#endif
+
+/**
+ * CRC-16 of the HDLC framing, shared with python/library/Crc16.py. It uses
+ * the reflected X.25 table folded MSB-first, seeded with 0xFFFF, and a
+ * frame followed by its CRC (most significant byte first) checks to zero.
+ */
+typedef Crc<uint16_t, 0x8408, true, true, 0xFFFF, 0x0000, 0x0000, CRC16_SLICES> Crc16;
+
+// The tables are instantiated once, in Crc16.cpp
+extern template class Crc<uint16_t, 0x8408, true, true, 0xFFFF, 0x0000, 0x0000, CRC16_SLICES>;
 
 #endif /* CRC16_H_ */
@@ -1,5 +1,5 @@
 /**
- * @file       SemaphoreBinary.cpp
+ * @file       CriticalSection.cpp
  * @author     Pere Tuset-Peiro (peretuset@openmote.com)
  * @version    v0.1
  * @date       May, 2015
@@ -11,46 +11,195 @@
 
 /*================================ include ==================================*/
 
+#include <string.h>
+
 #include "CriticalSection.h"
 
 /*================================ define ===================================*/
 
-#define enterCriticalSection(lock)          \
+/**
+ * Access to the Cortex-M3 interrupt masks, which the host test replaces.
+ */
+#ifndef getPrimask
+#define getPrimask(lock)                    \
+  do {                                      \
+    asm volatile (                          \
+        "mrs %[output], PRIMASK"            \
+        : [output] "=r" (lock));            \
+  } while(0)
+
+#define setPrimask(lock)                    \
+  do {                                      \
+    asm volatile (                          \
+        "msr PRIMASK, %[input]"             \
+        :: [input] "r" (lock) : "memory");  \
+  } while(0)
+
+#define disableInterrupts()                 \
+  do {                                      \
+    asm volatile (                          \
+        "cpsid I"                           \
+        ::: "memory");                      \
+  } while(0)
+
+#define getBasepri(lock)                    \
   do {                                      \
-    asm (                                   \
-        "mrs r0, PRIMASK\n\t"               \
-        "cpsid I\n\t"                       \
-        "strb r0, %[output]"                \
-        : [output] "=m" (lock) :: "r0");    \
+    asm volatile (                          \
+        "mrs %[output], BASEPRI"            \
+        : [output] "=r" (lock));            \
   } while(0)
 
-#define exitCriticalSection(lock)           \
+#define setBasepri(lock)                    \
   do {                                      \
-    asm (                                   \
-        "ldrb r0, %[input]\n\t"             \
-        "msr PRIMASK,r0;\n\t"               \
-        ::[input] "m" (lock) : "r0");       \
+    asm volatile (                          \
+        "msr BASEPRI, %[input]"             \
+        :: [input] "r" (lock) : "memory");  \
   } while(0)
 
+// Only writes BASEPRI if it masks more interrupts than it already does
+#define raiseBasepri(priority)              \
+  do {                                      \
+    asm volatile (                          \
+        "msr BASEPRI_MAX, %[input]"         \
+        :: [input] "r" (priority) : "memory"); \
+  } while(0)
+#endif
+
+/**
+ * Timestamp of the sections, the DWT cycle counter at the CPU clock.
+ */
+#ifndef CRITICAL_SECTION_TIMESTAMP
+#define DEMCR                               ( *(volatile uint32_t *) 0xE000EDFC )
+#define DEMCR_TRCENA                        ( 1 << 24 )
+#define DWT_CTRL                            ( *(volatile uint32_t *) 0xE0001000 )
+#define DWT_CTRL_CYCCNTENA                  ( 1 << 0 )
+#define DWT_CYCCNT                          ( *(volatile uint32_t *) 0xE0001004 )
+
+#define CRITICAL_SECTION_TIMESTAMP()        ( DWT_CYCCNT )
+#define CRITICAL_SECTION_TIMESTAMP_START()  do { DEMCR |= DEMCR_TRCENA; DWT_CYCCNT = 0; DWT_CTRL |= DWT_CTRL_CYCCNTENA; } while (0)
+#endif
+
 /*================================ typedef ==================================*/
 
 /*=============================== variables =================================*/
 
+#if CRITICAL_SECTION_STATS
+static CriticalSectionStats section_stats;
+#endif
+
 /*=============================== prototypes ================================*/
 
 /*================================= public ==================================*/
 
-CriticalSection::CriticalSection(void)
+CriticalSection::CriticalSection(uint8_t priority):
+    priority_(priority)
 {
-    enterCriticalSection(lock);
+    // Record the current masks, to be restored on exit
+    getPrimask(primask_);
+    getBasepri(basepri_);
+
+    // Mask the interrupts
+    if (priority_ == CRITICAL_SECTION_ALL)
+    {
+        disableInterrupts();
+    }
+    else
+    {
+        raiseBasepri(priority_);
+    }
+
+#if CRITICAL_SECTION_STATS
+    // Time the outermost section only, the nested ones are part of it
+    if (primask_ == 0 && basepri_ == 0)
+    {
+        caller_ = __builtin_return_address(0);
+        start_ = CRITICAL_SECTION_TIMESTAMP();
+    }
+#endif
 }
 
 CriticalSection::~CriticalSection(void)
 {
-    exitCriticalSection(lock);
+#if CRITICAL_SECTION_STATS
+    uint32_t cycles;
+    lock_t primask;
+
+    // Account for the outermost section with every interrupt masked, as a
+    // BASEPRI section leaves the higher priority ones running
+    if (primask_ == 0 && basepri_ == 0)
+    {
+        cycles = CRITICAL_SECTION_TIMESTAMP() - start_;
+
+        getPrimask(primask);
+        disableInterrupts();
+
+        section_stats.count++;
+        section_stats.cycles += cycles;
+
+        // Keep the caller of the longest section
+        if (cycles > section_stats.maxCycles)
+        {
+            section_stats.maxCycles = cycles;
+            section_stats.maxCaller = caller_;
+        }
+
+        setPrimask(primask);
+    }
+#endif
+
+    // Restore the masks that were in place
+    if (priority_ == CRITICAL_SECTION_ALL)
+    {
+        setPrimask(primask_);
+    }
+    else
+    {
+        setBasepri(basepri_);
+    }
+}
+
+/**
+ * Starts the DWT cycle counter and clears the statistics. Sections are
+ * only timed once the counter runs.
+ */
+void CriticalSection::startStats(void)
+{
+    lock_t primask;
+
+    getPrimask(primask);
+    disableInterrupts();
+
+    // Enable the trace unit and the cycle counter
+    CRITICAL_SECTION_TIMESTAMP_START();
+
+#if CRITICAL_SECTION_STATS
+    memset(&section_stats, 0, sizeof(section_stats));
+#endif
+
+    setPrimask(primask);
+}
+
+/**
+ * Copies the number of outermost sections, the cycles that they have held
+ * the interrupts masked in total and the longest one, with the address
+ * that it was entered from, which can be looked up in the map file.
+ */
+void CriticalSection::getStats(CriticalSectionStats& stats)
+{
+    lock_t primask;
+
+    getPrimask(primask);
+    disableInterrupts();
+
+#if CRITICAL_SECTION_STATS
+    stats = section_stats;
+#else
+    memset(&stats, 0, sizeof(stats));
+#endif
+
+    setPrimask(primask);
 }
 
 /*=============================== protected =================================*/
 
 /*================================ private ==================================*/
-
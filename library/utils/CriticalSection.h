@@ -14,14 +14,66 @@
 
 #include <stdint.h>
 
+#include "FreeRTOS.h"
+
+/**
+ * Priority that masks every interrupt, through PRIMASK instead of BASEPRI.
+ */
+#define CRITICAL_SECTION_ALL                ( 0 )
+
+/**
+ * Priority that a critical section masks by default, as written to BASEPRI.
+ * It matches the kernel critical sections, so that interrupts with a higher
+ * priority keep running. Such interrupts may not call the FreeRTOS API. The
+ * radio interrupts run there and pend a lower one to reach the kernel, so
+ * the sections that share state with them pass RADIO_INTERRUPT_PRIORITY.
+ * The UART interrupt, whose callbacks give semaphores, stays at the lowest
+ * priority and is masked by default.
+ */
+#ifndef CRITICAL_SECTION_PRIORITY
+#define CRITICAL_SECTION_PRIORITY           ( configMAX_SYSCALL_INTERRUPT_PRIORITY )
+#endif
+
+/**
+ * Whether the outermost critical sections are timed with the DWT cycle
+ * counter, see CriticalSection::getStats. Off by default, as it lengthens
+ * every section.
+ */
+#ifndef CRITICAL_SECTION_STATS
+#define CRITICAL_SECTION_STATS              ( 0 )
+#endif
+
 typedef uint32_t lock_t;
 
+struct CriticalSectionStats
+{
+    uint32_t count;
+    uint32_t cycles;
+    uint32_t maxCycles;
+    void* maxCaller;
+};
+
+/**
+ * Masks the interrupts with the given priority and below for as long as it
+ * is in scope. Sections nest, and an inner one never lowers the mask of an
+ * outer one. Kernel calls restore BASEPRI to zero when they return, so they
+ * must not be made from a BASEPRI critical section.
+ */
 class CriticalSection
 {
-    CriticalSection(void);
+public:
+    CriticalSection(uint8_t priority = CRITICAL_SECTION_PRIORITY);
     ~CriticalSection(void);
+    static void startStats(void);
+    static void getStats(CriticalSectionStats& stats);
 private:
-    lock_t lock;
+    uint8_t priority_;
+    lock_t primask_;
+    lock_t basepri_;
+#if CRITICAL_SECTION_STATS
+    uint32_t start_;
+    void* caller_;
+#endif
 };
 
 #endif /* CRITICAL_SECTION_H_ */
@@ -19,6 +19,9 @@ static const uint8_t HDLC_FLAG        = 0x7E;
 static const uint8_t HDLC_ESCAPE      = 0x7D;
 static const uint8_t HDLC_ESCAPE_MASK = 0x20;
 
+static const uint8_t HDLC_CRC_LENGTH    = 2;
+static const uint8_t HDLC_HEADER_LENGTH = 2;
+
 /*================================ typedef ==================================*/
 
 /*=============================== variables =================================*/
@@ -28,15 +31,21 @@ static const uint8_t HDLC_ESCAPE_MASK = 0x20;
 /*================================= public ==================================*/
 
 Hdlc::Hdlc(CircularBuffer& rxCircularBuffer, CircularBuffer& txCircularBuffer):
-    rxCircularBuffer_(rxCircularBuffer), txCircularBuffer_(txCircularBuffer)
+    rxCircularBuffer_(rxCircularBuffer), txCircularBuffer_(txCircularBuffer), \
+    txLength(0)
 {
 }
 
+/**
+ * Resets the receive state and discards the frame being received, if any.
+ * Complete frames that are already queued in the receive buffer are kept.
+ */
 HdlcResult Hdlc::rxOpen(void)
 {
     rxStatus = HdlcStatus_Idle;
     rxLastByte = 0;
     rxIsEscaping = false;
+    rxLength = 0;
     rxCrc.init();
 
     return HdlcResult_Ok;
@@ -80,33 +89,104 @@ HdlcStatus Hdlc::getRxStatus(void){
     return rxStatus;
 }
 
+/**
+ * Checks the CRC of the frame that has just been received and, if it is
+ * correct, publishes it to the receive buffer as a two-byte length (least
+ * significant byte first) followed by the payload without the CRC. The
+ * receiver is then ready for the next frame, which may share the flag.
+ */
 HdlcResult Hdlc::rxClose(void)
 {
-    HdlcResult result;
+    HdlcResult result = HdlcResult_Error;
+    uint8_t header[HDLC_HEADER_LENGTH];
+    uint32_t length;
+    bool status;
 
-    // Return the status of the receive CRC
-    result = rxCrc.check() ? HdlcResult_Ok : HdlcResult_Error;
+    // Check the length and the CRC of the received frame
+    if (rxLength >= HDLC_CRC_LENGTH && rxCrc.check())
+    {
+        // Stage the payload length in front of the payload
+        length = rxLength - HDLC_CRC_LENGTH;
+        header[0] = (length >> 0) & 0xFF;
+        header[1] = (length >> 8) & 0xFF;
+        status = rxCircularBuffer_.writeAt(0, header, sizeof(header));
+
+        // Publish the header and the payload at once
+        if (status)
+        {
+            rxCircularBuffer_.commitWrite(HDLC_HEADER_LENGTH + length);
+            result = HdlcResult_Ok;
+        }
+    }
+
+    // Get ready for the next frame, the closing flag may also open it
+    rxOpen();
+    rxLastByte = HDLC_FLAG;
 
     return result;
 }
 
+/**
+ * Copies the oldest queued frame to the buffer and returns its length. A
+ * frame that does not fit in the buffer is dropped and 0 is returned, as
+ * when there is no frame queued. This may only be called from the consumer
+ * side of the receive buffer.
+ */
+uint32_t Hdlc::rxRead(uint8_t* buffer, uint32_t size)
+{
+    uint8_t header[HDLC_HEADER_LENGTH];
+    uint32_t length;
+    bool status;
+
+    // Read the frame length
+    status = rxCircularBuffer_.read(header, sizeof(header));
+    if (!status) return 0;
+
+    length = (header[0] << 0) | (header[1] << 8);
+
+    // Check that the frame fits in the buffer, otherwise drop it
+    if (length > size)
+    {
+        rxCircularBuffer_.commitRead(length);
+        return 0;
+    }
+
+    // Copy the frame to the buffer
+    rxCircularBuffer_.read(buffer, length);
+
+    return length;
+}
+
+/**
+ * Returns the number of bytes that a payload of the given size takes in the
+ * transmit buffer in the worst case, i.e. with every payload and CRC byte
+ * escaped, including the opening and closing flags.
+ */
+uint32_t Hdlc::getTxMaxLength(uint32_t size)
+{
+    return (1 + 2 * (size + 2) + 1);
+}
+
+/**
+ * Starts encoding a frame. The encoded bytes are staged in the transmit
+ * buffer and only published by txClose, so that the reader never sees a
+ * partial frame and a frame that does not fit leaves nothing behind.
+ */
 HdlcResult Hdlc::txOpen(void)
 {
-    int32_t status;
+    uint8_t flag = HDLC_FLAG;
 
     // Initialize the transmit CRC module
     txCrc.init();
+    txLength = 0;
 
     // Write the opening HDLC flag to the transmit buffer
-    status = txCircularBuffer_.write(HDLC_FLAG);
-    if (!status) return HdlcResult_Error;
-
-    return HdlcResult_Ok;
+    return txStage(&flag, 1);
 }
 
 HdlcResult Hdlc::txPut(uint8_t byte)
 {
-    bool status;
+    uint8_t escaped[2];
 
     // Push the byte to the transmit CRC module
     txCrc.set(byte);
@@ -114,66 +194,154 @@ HdlcResult Hdlc::txPut(uint8_t byte)
     // Check if we are transmitting and HDLC flag or escape byte
     if (byte == HDLC_FLAG || byte == HDLC_ESCAPE)
     {
-        // If so, write an HDLC escape symbol to the transmit buffer
-        status = txCircularBuffer_.write(HDLC_ESCAPE);
-        if (!status) return HdlcResult_Error;
-
-        // Transform the current byte
-        byte ^= HDLC_ESCAPE_MASK;
+        // If so, write an HDLC escape symbol followed by the transformed byte
+        escaped[0] = HDLC_ESCAPE;
+        escaped[1] = byte ^ HDLC_ESCAPE_MASK;
+        return txStage(escaped, sizeof(escaped));
     }
 
     // Write the current byte to the transmit buffer
-    status = txCircularBuffer_.write(byte);
-    if (!status) return HdlcResult_Error;
-
-    return HdlcResult_Ok;
+    return txStage(&byte, 1);
 }
 
 HdlcResult Hdlc::txPut(uint8_t* buffer, int32_t size)
 {
-    HdlcResult status = HdlcResult_Ok;
-
-    while (size-- && status == HdlcResult_Ok)
-    {
-        status = txPut(*buffer++);
-    }
+    // Check the buffer size
+    if (size < 0) return HdlcResult_Error;
 
-    return status;
+    // Encode the buffer and push it to the transmit CRC module
+    return txEncode(buffer, size, true);
 }
 
+/**
+ * Finishes the frame and publishes it, see txFinish and txCommit.
+ */
 HdlcResult Hdlc::txClose(void)
 {
     HdlcResult result;
-    uint32_t status;
-    uint16_t crc;
-    uint8_t byte;
+
+    // Stage the CRC and the closing flag
+    result = txFinish();
+    if (result != HdlcResult_Ok) return HdlcResult_Error;
+
+    // Publish the whole frame at once
+    txCommit();
+
+    return HdlcResult_Ok;
+}
+
+/**
+ * Stages the CRC and the closing flag without publishing the frame, so
+ * that the caller can act on its final length (see getTxLength) before
+ * the reader can see it.
+ */
+HdlcResult Hdlc::txFinish(void)
+{
+    HdlcResult result;
+    uint8_t flag = HDLC_FLAG;
+    uint8_t crc[2];
+    uint16_t value;
 
     // Get the CRC value
-    crc = txCrc.get();
+    value = txCrc.get();
+    crc[0] = (value >> 8) & 0xFF;
+    crc[1] = (value >> 0) & 0xFF;
 
     // Write the CRC value to the transmit buffer
-    byte = (crc >> 8) & 0xFF;
-    result = txPut(byte);
-    if (result != HdlcResult_Ok) return HdlcResult_Error;
-
-    byte = (crc >> 0) & 0xFF;
-    result = txPut(byte);
+    result = txEncode(crc, sizeof(crc), false);
     if (result != HdlcResult_Ok) return HdlcResult_Error;
 
     // Write the closing HDLC flag to the transmit buffer
-    status = txCircularBuffer_.write(HDLC_FLAG);
-    if (!status) return HdlcResult_Error;
+    result = txStage(&flag, 1);
+    if (result != HdlcResult_Ok) return HdlcResult_Error;
 
     return HdlcResult_Ok;
 }
 
+void Hdlc::txCommit(void)
+{
+    // Publish the staged frame to the reader
+    txCircularBuffer_.commitWrite(txLength);
+}
+
+/**
+ * Returns the number of bytes that the frame being encoded, or the last
+ * one published by txClose, takes in the transmit buffer.
+ */
+uint32_t Hdlc::getTxLength(void)
+{
+    return txLength;
+}
+
 /*=============================== protected =================================*/
 
 /*================================ private ==================================*/
 
+/**
+ * Scans ahead for the next byte that needs escaping and copies the clean
+ * run before it to the transmit buffer in bulk, folding the CRC over the
+ * same run while it is still in the cache.
+ */
+HdlcResult Hdlc::txEncode(const uint8_t* buffer, uint32_t size, bool crc)
+{
+    const uint8_t* end = buffer + size;
+    const uint8_t* run;
+    uint8_t escaped[2];
+    HdlcResult result;
+
+    while (buffer < end)
+    {
+        // Find the end of the run of bytes that do not need escaping
+        run = buffer;
+        while (run < end && *run != HDLC_FLAG && *run != HDLC_ESCAPE)
+        {
+            run++;
+        }
+
+        // Push the run to the transmit CRC module
+        if (crc) txCrc.update(buffer, run - buffer);
+
+        // Copy the run to the transmit buffer
+        result = txStage(buffer, run - buffer);
+        if (result != HdlcResult_Ok) return HdlcResult_Error;
+
+        buffer = run;
+
+        // Check if the run stopped at an HDLC flag or escape byte
+        if (buffer < end)
+        {
+            // Push the byte to the transmit CRC module
+            if (crc) txCrc.set(*buffer);
+
+            // Write the HDLC escape symbol followed by the transformed byte
+            escaped[0] = HDLC_ESCAPE;
+            escaped[1] = *buffer ^ HDLC_ESCAPE_MASK;
+            result = txStage(escaped, sizeof(escaped));
+            if (result != HdlcResult_Ok) return HdlcResult_Error;
+
+            buffer++;
+        }
+    }
+
+    return HdlcResult_Ok;
+}
+
+HdlcResult Hdlc::txStage(const uint8_t* buffer, uint32_t size)
+{
+    bool status;
+
+    // Stage the bytes after the ones already encoded
+    status = txCircularBuffer_.writeAt(txLength, buffer, size);
+    if (!status) return HdlcResult_Error;
+
+    txLength += size;
+
+    return HdlcResult_Ok;
+}
+
 HdlcResult Hdlc::rxParse(uint8_t byte)
 {
-    int32_t status;
+    bool status;
 
     // Check the received byte
     if (byte == HDLC_ESCAPE)
@@ -192,9 +360,11 @@ HdlcResult Hdlc::rxParse(uint8_t byte)
             rxIsEscaping = false;
         }
 
-        // Write a byte to the receive buffer
-        status = rxCircularBuffer_.write(byte);
-        if (status == -1) return HdlcResult_Error;
+        // Stage the byte in the receive buffer after the frame header
+        status = rxCircularBuffer_.writeAt(HDLC_HEADER_LENGTH + rxLength, &byte, 1);
+        if (!status) return HdlcResult_Error;
+
+        rxLength++;
 
         // Push the byte to the CRC module
         rxCrc.set(byte);
@@ -38,15 +38,22 @@ public:
     HdlcResult rxOpen(void);
     HdlcResult rxPut(uint8_t byte);
     HdlcResult rxClose(void);
+    uint32_t rxRead(uint8_t* buffer, uint32_t size);
     HdlcStatus getRxStatus(void);
 
+    static uint32_t getTxMaxLength(uint32_t size);
     HdlcResult txOpen(void);
     HdlcResult txPut(uint8_t byte);
     HdlcResult txPut(uint8_t* buffer, int32_t size);
     HdlcResult txClose(void);
+    HdlcResult txFinish(void);
+    void txCommit(void);
+    uint32_t getTxLength(void);
 
 private:
     HdlcResult rxParse(uint8_t byte);
+    HdlcResult txEncode(const uint8_t* buffer, uint32_t size, bool crc);
+    HdlcResult txStage(const uint8_t* buffer, uint32_t size);
 
 private:
     CircularBuffer& rxCircularBuffer_;
@@ -55,6 +62,8 @@ private:
     HdlcStatus rxStatus;
     uint8_t rxLastByte;
     bool rxIsEscaping;
+    uint32_t rxLength;
+    uint32_t txLength;
 
     Crc16 rxCrc;
     Crc16 txCrc;
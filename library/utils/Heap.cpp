@@ -0,0 +1,71 @@
+/**
+ * @file       Heap.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Statistics of the kernel heap.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include "Heap.h"
+
+/*================================ define ===================================*/
+
+/*================================ typedef ==================================*/
+
+/*=============================== variables =================================*/
+
+/*=============================== prototypes ================================*/
+
+/*================================= public ==================================*/
+
+/**
+ * Takes the statistics of the heap: the free bytes now and at the lowest
+ * point since startup, the largest and the number of free blocks, and the
+ * number of blocks handed out and returned. The free list is walked with
+ * the scheduler suspended.
+ */
+void Heap::getStats(HeapStats& stats)
+{
+    HeapStats_t heapStats;
+
+    vPortGetHeapStats(&heapStats);
+
+    stats.size = configTOTAL_HEAP_SIZE;
+    stats.free = heapStats.xAvailableHeapSpaceInBytes;
+    stats.minimumFree = heapStats.xMinimumEverFreeBytesRemaining;
+    stats.largestBlock = heapStats.xSizeOfLargestFreeBlockInBytes;
+    stats.freeBlocks = heapStats.xNumberOfFreeBlocks;
+    stats.allocations = heapStats.xNumberOfSuccessfulAllocations;
+    stats.frees = heapStats.xNumberOfSuccessfulFrees;
+}
+
+/**
+ * Returns the share of the free bytes that are not in the largest free
+ * block, in tenths of a percent: 0 when any allocation that fits in the
+ * free bytes would succeed, approaching 1000 as the free bytes scatter.
+ * The sizes are scaled down to 22 bits, so that the math fits in 32 bits.
+ */
+uint16_t Heap::getFragmentation(const HeapStats& stats)
+{
+    uint32_t largest = stats.largestBlock;
+    uint32_t free = stats.free;
+
+    if (free == 0 || largest >= free) return 0;
+
+    while (free >= (1UL << 22))
+    {
+        largest >>= 1;
+        free >>= 1;
+    }
+
+    return (uint16_t) (1000 - (largest * 1000) / free);
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
@@ -0,0 +1,43 @@
+/**
+ * @file       Heap.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Statistics of the kernel heap.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef HEAP_H_
+#define HEAP_H_
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+struct HeapStats
+{
+    uint32_t size;
+    uint32_t free;
+    uint32_t minimumFree;
+    uint32_t largestBlock;
+    uint32_t freeBlocks;
+    uint32_t allocations;
+    uint32_t frees;
+};
+
+/**
+ * Statistics of the kernel heap, which the project selects with USE_HEAP
+ * in its Makefile. heap_1 never frees, so its free bytes are one block, and
+ * heap_3 leaves the heap to the C library, so it only counts the calls.
+ */
+class Heap
+{
+public:
+    static void getStats(HeapStats& stats);
+    static uint16_t getFragmentation(const HeapStats& stats);
+private:
+};
+
+#endif /* HEAP_H_ */
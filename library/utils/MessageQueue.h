@@ -0,0 +1,393 @@
+/**
+ * @file       MessageQueue.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Typed, statically allocated message queue.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef MESSAGE_QUEUE_H_
+#define MESSAGE_QUEUE_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <new>
+#include <utility>
+
+#include "Semaphore.h"
+
+/**
+ * Bounded queue of N messages of type T, held in the queue object itself.
+ * Messages are constructed in their slot and moved out of it when they are
+ * received, so a queue of descriptors (e.g. Packet*) hands buffers over
+ * without copying them.
+ *
+ * Any number of tasks and interrupts may send, and any number of tasks may
+ * receive. Each slot carries a sequence number that tells whether it holds
+ * a message for the current lap, so that claiming a slot takes a single
+ * compare-and-swap and never masks interrupts. The semaphores are only used
+ * to wake up the tasks that block on an empty or a full queue, and they are
+ * only given when some task is actually waiting.
+ *
+ * A message only becomes visible once its slot is published, so a sender
+ * that is preempted between claiming and publishing a slot holds back the
+ * messages behind it until it resumes. N must be a power of two.
+ */
+template<typename T, uint32_t N>
+class MessageQueue
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "The queue length must be a power of two!");
+public:
+    MessageQueue();
+    ~MessageQueue();
+    bool send(const T& message);
+    bool send(const T& message, uint32_t milliseconds);
+    bool trySend(const T& message);
+    bool sendFromInterrupt(const T& message);
+    template<typename... Args>
+    bool emplace(Args&&... args);
+    template<typename... Args>
+    bool emplaceFromInterrupt(Args&&... args);
+    bool receive(T& message);
+    bool receive(T& message, uint32_t milliseconds);
+    bool tryReceive(T& message);
+    uint32_t getSize(void);
+    uint32_t getLength(void);
+    bool isEmpty(void);
+    bool isFull(void);
+private:
+    struct Slot
+    {
+        std::atomic<uint32_t> sequence;
+        alignas(T) uint8_t storage[sizeof(T)];
+    };
+private:
+    Slot* claim(void);
+    void publish(Slot* slot, bool interrupt);
+    bool wait(std::atomic<uint32_t>& waiting, Semaphore& semaphore, uint32_t milliseconds, T* message, const T* copy);
+private:
+    Slot slots_[N];
+    std::atomic<uint32_t> head_;
+    std::atomic<uint32_t> tail_;
+
+    SemaphoreBinary notEmpty_;
+    SemaphoreBinary notFull_;
+    std::atomic<uint32_t> receivers_;
+    std::atomic<uint32_t> senders_;
+};
+
+/*================================= public ==================================*/
+
+template<typename T, uint32_t N>
+MessageQueue<T, N>::MessageQueue():
+    head_(0), tail_(0), notEmpty_(false), notFull_(false), receivers_(0), senders_(0)
+{
+    // Slot i is free for the message sent in position i
+    for (uint32_t i = 0; i < N; i++)
+    {
+        slots_[i].sequence = i;
+    }
+}
+
+template<typename T, uint32_t N>
+MessageQueue<T, N>::~MessageQueue()
+{
+    uint32_t tail = tail_.load();
+    Slot* slot;
+
+    // Destroy the messages that were never received
+    for (uint32_t position = head_.load(); position != tail; position++)
+    {
+        slot = &slots_[position & (N - 1)];
+        if (slot->sequence.load() == position + 1)
+        {
+            reinterpret_cast<T*>(slot->storage)->~T();
+        }
+    }
+}
+
+/**
+ * Sends a copy of the message, blocking for as long as the queue is full.
+ */
+template<typename T, uint32_t N>
+bool MessageQueue<T, N>::send(const T& message)
+{
+    return send(message, portMAX_DELAY);
+}
+
+/**
+ * Sends a copy of the message, blocking while the queue is full for up to
+ * the given time. Returns false if the queue is still full by then.
+ */
+template<typename T, uint32_t N>
+bool MessageQueue<T, N>::send(const T& message, uint32_t milliseconds)
+{
+    // Try without blocking first, the common case
+    if (trySend(message)) return true;
+
+    return wait(senders_, notFull_, milliseconds, nullptr, &message);
+}
+
+template<typename T, uint32_t N>
+bool MessageQueue<T, N>::trySend(const T& message)
+{
+    return emplace(message);
+}
+
+template<typename T, uint32_t N>
+bool MessageQueue<T, N>::sendFromInterrupt(const T& message)
+{
+    return emplaceFromInterrupt(message);
+}
+
+/**
+ * Constructs a message in the next free slot from the arguments, without
+ * blocking. Returns false if the queue is full.
+ */
+template<typename T, uint32_t N>
+template<typename... Args>
+bool MessageQueue<T, N>::emplace(Args&&... args)
+{
+    Slot* slot;
+
+    slot = claim();
+    if (slot == nullptr) return false;
+
+    new (slot->storage) T(std::forward<Args>(args)...);
+
+    publish(slot, false);
+
+    return true;
+}
+
+template<typename T, uint32_t N>
+template<typename... Args>
+bool MessageQueue<T, N>::emplaceFromInterrupt(Args&&... args)
+{
+    Slot* slot;
+
+    slot = claim();
+    if (slot == nullptr) return false;
+
+    new (slot->storage) T(std::forward<Args>(args)...);
+
+    publish(slot, true);
+
+    return true;
+}
+
+/**
+ * Receives the oldest message, blocking for as long as the queue is empty.
+ */
+template<typename T, uint32_t N>
+bool MessageQueue<T, N>::receive(T& message)
+{
+    return receive(message, portMAX_DELAY);
+}
+
+/**
+ * Receives the oldest message, blocking while the queue is empty for up to
+ * the given time. Returns false if the queue is still empty by then.
+ */
+template<typename T, uint32_t N>
+bool MessageQueue<T, N>::receive(T& message, uint32_t milliseconds)
+{
+    // Try without blocking first, the common case
+    if (tryReceive(message)) return true;
+
+    return wait(receivers_, notEmpty_, milliseconds, &message, nullptr);
+}
+
+/**
+ * Moves the oldest message out of the queue, without blocking. Returns
+ * false if the queue is empty.
+ */
+template<typename T, uint32_t N>
+bool MessageQueue<T, N>::tryReceive(T& message)
+{
+    uint32_t position;
+    uint32_t sequence;
+    Slot* slot;
+    T* stored;
+
+    position = head_.load();
+
+    while (true)
+    {
+        slot = &slots_[position & (N - 1)];
+        sequence = slot->sequence.load();
+
+        if (sequence == position + 1)
+        {
+            // The slot holds the message, try to take it
+            if (head_.compare_exchange_weak(position, position + 1)) break;
+        }
+        else if ((int32_t) (sequence - (position + 1)) < 0)
+        {
+            // The message has not been published yet
+            return false;
+        }
+        else
+        {
+            // Another receiver took the message, try the next one
+            position = head_.load();
+        }
+    }
+
+    stored = reinterpret_cast<T*>(slot->storage);
+    message = std::move(*stored);
+    stored->~T();
+
+    // Free the slot for the message sent one lap later
+    slot->sequence = position + N;
+
+    // Wake up a sender blocked on the full queue, if any
+    if (senders_.load() > 0)
+    {
+        notFull_.give();
+    }
+
+    return true;
+}
+
+/**
+ * Returns the number of messages in the queue, including the ones that
+ * are still being sent or received.
+ */
+template<typename T, uint32_t N>
+uint32_t MessageQueue<T, N>::getSize(void)
+{
+    uint32_t head = head_.load();
+    uint32_t tail = tail_.load();
+
+    return (tail - head <= N) ? (tail - head) : 0;
+}
+
+template<typename T, uint32_t N>
+uint32_t MessageQueue<T, N>::getLength(void)
+{
+    return N;
+}
+
+template<typename T, uint32_t N>
+bool MessageQueue<T, N>::isEmpty(void)
+{
+    return (getSize() == 0);
+}
+
+template<typename T, uint32_t N>
+bool MessageQueue<T, N>::isFull(void)
+{
+    return (getSize() == N);
+}
+
+/*================================ private ==================================*/
+
+/**
+ * Claims the next free slot for a message, or returns nullptr if the queue
+ * is full. The slot belongs to the caller until it is published.
+ */
+template<typename T, uint32_t N>
+typename MessageQueue<T, N>::Slot* MessageQueue<T, N>::claim(void)
+{
+    uint32_t position;
+    uint32_t sequence;
+    Slot* slot;
+
+    position = tail_.load();
+
+    while (true)
+    {
+        slot = &slots_[position & (N - 1)];
+        sequence = slot->sequence.load();
+
+        if (sequence == position)
+        {
+            // The slot is free, try to claim it
+            if (tail_.compare_exchange_weak(position, position + 1)) return slot;
+        }
+        else if ((int32_t) (sequence - position) < 0)
+        {
+            // The slot still holds the message of the previous lap
+            return nullptr;
+        }
+        else
+        {
+            // Another sender claimed the slot, try the next one
+            position = tail_.load();
+        }
+    }
+}
+
+template<typename T, uint32_t N>
+void MessageQueue<T, N>::publish(Slot* slot, bool interrupt)
+{
+    // Make the message visible to the receivers
+    slot->sequence = slot->sequence.load() + 1;
+
+    // Wake up a receiver blocked on the empty queue, if any
+    if (receivers_.load() > 0)
+    {
+        if (interrupt)
+        {
+            notEmpty_.giveFromInterrupt();
+        }
+        else
+        {
+            notEmpty_.give();
+        }
+    }
+}
+
+/**
+ * Blocks on the semaphore until the message can be received (message) or
+ * sent (copy), or until the time runs out. The caller is counted as
+ * waiting before it tries again, so that the other side either sees it
+ * waiting and gives the semaphore, or has already made room for it.
+ */
+template<typename T, uint32_t N>
+bool MessageQueue<T, N>::wait(std::atomic<uint32_t>& waiting, Semaphore& semaphore, uint32_t milliseconds, T* message, const T* copy)
+{
+    TickType_t start = xTaskGetTickCount();
+    uint32_t elapsed;
+    bool status = false;
+
+    waiting++;
+
+    while (true)
+    {
+        // Try again now that the other side knows that we are waiting
+        status = (message != nullptr) ? tryReceive(*message) : trySend(*copy);
+        if (status) break;
+
+        // Check how much time is left
+        elapsed = (xTaskGetTickCount() - start) * portTICK_RATE_MS;
+        if (milliseconds != portMAX_DELAY && elapsed >= milliseconds) break;
+
+        // Block until the other side wakes us up
+        if (milliseconds == portMAX_DELAY)
+        {
+            semaphore.take();
+        }
+        else
+        {
+            semaphore.take(milliseconds - elapsed);
+        }
+    }
+
+    waiting--;
+
+    // Pass the wakeup on, it may have been meant for another waiter
+    if (waiting.load() > 0)
+    {
+        semaphore.give();
+    }
+
+    return status;
+}
+
+#endif /* MESSAGE_QUEUE_H_ */
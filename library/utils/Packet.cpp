@@ -0,0 +1,242 @@
+/**
+ * @file       Packet.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Reference-counted packet buffers and the pool they come from.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include "Packet.h"
+
+/*================================ define ===================================*/
+
+/*================================ typedef ==================================*/
+
+/*=============================== variables =================================*/
+
+static const uint16_t PACKET_NONE = 0xFFFF; // Index that ends the free stack
+static const uint32_t PACKET_TAG  = 0x10000; // Tag increment of the stack top
+
+/*=============================== prototypes ================================*/
+
+/*================================= public ==================================*/
+
+Packet::Packet():
+    pool_(nullptr), references_(0), next_(PACKET_NONE), \
+    head_(PACKET_HEADROOM), length_(0)
+{
+}
+
+/**
+ * Empties the packet and leaves headroom bytes in front of the data.
+ */
+void Packet::reset(uint32_t headroom)
+{
+    // Keep the headroom within the buffer
+    if (headroom > PACKET_LENGTH)
+    {
+        headroom = PACKET_LENGTH;
+    }
+
+    head_ = headroom;
+    length_ = 0;
+}
+
+uint8_t* Packet::getData(void)
+{
+    return &buffer_[head_];
+}
+
+/**
+ * Returns where the next appended byte goes, so that a driver can fill up
+ * to getTailroom bytes in place and then append what it wrote.
+ */
+uint8_t* Packet::getTail(void)
+{
+    return &buffer_[head_ + length_];
+}
+
+uint32_t Packet::getLength(void)
+{
+    return length_;
+}
+
+uint32_t Packet::getHeadroom(void)
+{
+    return head_;
+}
+
+uint32_t Packet::getTailroom(void)
+{
+    return (PACKET_LENGTH - head_ - length_);
+}
+
+/**
+ * Grows the data by length bytes at the front and returns where they
+ * start, or nullptr if the headroom is too small.
+ */
+uint8_t* Packet::prepend(uint32_t length)
+{
+    // Check the headroom
+    if (length > head_) return nullptr;
+
+    head_ -= length;
+    length_ += length;
+
+    return &buffer_[head_];
+}
+
+/**
+ * Grows the data by length bytes at the back and returns where they
+ * start, or nullptr if the tailroom is too small.
+ */
+uint8_t* Packet::append(uint32_t length)
+{
+    uint8_t* tail;
+
+    // Check the tailroom
+    if (length > getTailroom()) return nullptr;
+
+    tail = getTail();
+    length_ += length;
+
+    return tail;
+}
+
+/**
+ * Removes length bytes from the front of the data, e.g. a parsed header.
+ */
+bool Packet::trimHead(uint32_t length)
+{
+    // Check the length
+    if (length > length_) return false;
+
+    head_ += length;
+    length_ -= length;
+
+    return true;
+}
+
+/**
+ * Removes length bytes from the back of the data, e.g. a checked trailer.
+ */
+bool Packet::trimTail(uint32_t length)
+{
+    // Check the length
+    if (length > length_) return false;
+
+    length_ -= length;
+
+    return true;
+}
+
+/**
+ * Takes one more reference, for a layer that keeps the packet past the
+ * call that handed it over.
+ */
+void Packet::retain(void)
+{
+    references_.fetch_add(1);
+}
+
+/**
+ * Drops one reference. The packet goes back to its pool with the last one
+ * and may not be touched afterwards.
+ */
+void Packet::release(void)
+{
+    if (references_.fetch_sub(1) == 1 && pool_ != nullptr)
+    {
+        pool_->free(this);
+    }
+}
+
+PacketPool::PacketPool(Packet* packets, uint16_t count):
+    packets_(packets), count_(count), \
+    top_(count > 0 ? 0 : PACKET_NONE), free_(count), failed_(0)
+{
+    // Chain all the packets in the free stack
+    for (uint16_t i = 0; i < count; i++)
+    {
+        packets_[i].pool_ = this;
+        packets_[i].next_ = (i + 1 < count) ? (i + 1) : PACKET_NONE;
+    }
+}
+
+/**
+ * Takes a packet from the pool, emptied with the default headroom and
+ * holding one reference. Returns nullptr if the pool is exhausted. This
+ * may be called from interrupt handlers.
+ */
+Packet* PacketPool::allocate(void)
+{
+    Packet* packet;
+    uint32_t top, next;
+    uint16_t index;
+
+    top = top_.load();
+
+    do
+    {
+        // Check if there is any packet left
+        index = top & 0xFFFF;
+        if (index == PACKET_NONE)
+        {
+            failed_++;
+            return nullptr;
+        }
+
+        // Pop the top packet and change the tag
+        next = ((top + PACKET_TAG) & ~0xFFFF) | packets_[index].next_;
+    } while (!top_.compare_exchange_weak(top, next));
+
+    free_--;
+
+    // Hand the packet out empty and with one reference
+    packet = &packets_[index];
+    packet->references_ = 1;
+    packet->reset();
+
+    return packet;
+}
+
+uint32_t PacketPool::getFree(void)
+{
+    return free_;
+}
+
+/**
+ * Returns the number of allocations that found the pool exhausted.
+ */
+uint32_t PacketPool::getFailed(void)
+{
+    return failed_;
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+void PacketPool::free(Packet* packet)
+{
+    uint32_t top, next;
+    uint16_t index;
+
+    index = packet - packets_;
+
+    free_++;
+
+    top = top_.load();
+
+    do
+    {
+        // Push the packet on top and change the tag
+        packet->next_ = top & 0xFFFF;
+        next = ((top + PACKET_TAG) & ~0xFFFF) | index;
+    } while (!top_.compare_exchange_weak(top, next));
+}
@@ -0,0 +1,92 @@
+/**
+ * @file       Packet.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Reference-counted packet buffers and the pool they come from.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef PACKET_H_
+#define PACKET_H_
+
+#include <stdint.h>
+
+#include <atomic>
+
+/**
+ * Size of each packet buffer and the room kept in front of the data when
+ * a packet is allocated, so that the layers below can prepend their
+ * headers in place. The defaults fit an IEEE 802.15.4 frame wrapped in an
+ * Ethernet frame.
+ */
+#ifndef PACKET_LENGTH
+#define PACKET_LENGTH                       ( 192 )
+#endif
+
+#ifndef PACKET_HEADROOM
+#define PACKET_HEADROOM                     ( 32 )
+#endif
+
+class PacketPool;
+
+/**
+ * A packet buffer with the data somewhere in the middle: headers are
+ * prepended into the headroom and trailers appended into the tailroom
+ * without moving the data. Each layer that keeps the packet holds a
+ * reference, and the packet goes back to its pool with the last release.
+ */
+class Packet
+{
+    friend class PacketPool;
+public:
+    Packet();
+    void reset(uint32_t headroom = PACKET_HEADROOM);
+    uint8_t* getData(void);
+    uint8_t* getTail(void);
+    uint32_t getLength(void);
+    uint32_t getHeadroom(void);
+    uint32_t getTailroom(void);
+    uint8_t* prepend(uint32_t length);
+    uint8_t* append(uint32_t length);
+    bool trimHead(uint32_t length);
+    bool trimTail(uint32_t length);
+    void retain(void);
+    void release(void);
+private:
+    PacketPool* pool_;
+    std::atomic<uint32_t> references_;
+    std::atomic<uint16_t> next_;
+    uint16_t head_;
+    uint16_t length_;
+    uint8_t buffer_[PACKET_LENGTH];
+};
+
+/**
+ * Fixed set of packets, handed out and taken back without locks so that
+ * both tasks and interrupt handlers can allocate and release them. The
+ * free packets are kept in a stack whose top carries a tag that changes
+ * on every operation, so that a preempted allocation cannot pop a packet
+ * that has been taken and returned in the meantime.
+ */
+class PacketPool
+{
+    friend class Packet;
+public:
+    PacketPool(Packet* packets, uint16_t count);
+    Packet* allocate(void);
+    uint32_t getFree(void);
+    uint32_t getFailed(void);
+private:
+    void free(Packet* packet);
+private:
+    Packet* packets_;
+    uint16_t count_;
+    std::atomic<uint32_t> top_;
+    std::atomic<uint32_t> free_;
+    std::atomic<uint32_t> failed_;
+};
+
+#endif /* PACKET_H_ */
@@ -1,4 +1,4 @@
- /**
+/**
  * @file       Scheduler.cpp
  * @author     Pere Tuset-Peiro (peretuset@openmote.com)
  * @version    v0.1
@@ -11,16 +11,41 @@
 
 /*================================ include ==================================*/
 
+#include <string.h>
+
+#include "Heap.h"
 #include "Scheduler.h"
 
 /*================================ define ===================================*/
 
+#define SCHEDULER_STATS_ENABLED             ( (configGENERATE_RUN_TIME_STATS == 1) && (configUSE_TRACE_FACILITY == 1) )
+
 /*================================ typedef ==================================*/
 
+// Run-time counter of a task at the previous query
+struct SchedulerTaskCounter
+{
+    uint32_t number;
+    uint32_t runTime;
+};
+
 /*=============================== variables =================================*/
 
+#if SCHEDULER_STATS_ENABLED
+static TaskStatus_t scheduler_status[SCHEDULER_STATS_TASKS];
+static SchedulerTaskCounter scheduler_counters[SCHEDULER_STATS_TASKS];
+static uint32_t scheduler_counter_count;
+static uint32_t scheduler_run_time;
+#endif
+
+static SchedulerStats scheduler_stats;
+static SchedulerTaskStats scheduler_tasks[SCHEDULER_STATS_TASKS];
+
 /*=============================== prototypes ================================*/
 
+static uint8_t* put16(uint8_t* buffer, uint16_t value);
+static uint8_t* put32(uint8_t* buffer, uint32_t value);
+
 /*================================= public ==================================*/
 
 Scheduler::Scheduler()
@@ -32,6 +57,170 @@ void Scheduler::run(void)
     vTaskStartScheduler();
 }
 
+/**
+ * Takes the run-time statistics of the system and of up to size tasks,
+ * and returns the number of tasks. The run time and the CPU load of each
+ * task are counted since the previous call, which should come more often
+ * than the run-time counter wraps around (134 seconds for the cycle
+ * counter at 32 MHz). Only one task should query the statistics.
+ *
+ * The run-time statistics need configGENERATE_RUN_TIME_STATS and
+ * configUSE_TRACE_FACILITY in FreeRTOSConfig.h, without them only the
+ * tick count and the heap are reported.
+ */
+uint32_t Scheduler::getStats(SchedulerStats& stats, SchedulerTaskStats* tasks, uint32_t size)
+{
+    HeapStats heap;
+
+    Heap::getStats(heap);
+
+    stats.ticks = xTaskGetTickCount();
+    stats.runTime = 0;
+    stats.clock = SCHEDULER_STATS_CLOCK_HZ;
+    stats.heapSize = heap.size;
+    stats.heapFree = heap.free;
+    stats.heapMinimum = heap.minimumFree;
+    stats.heapLargest = heap.largestBlock;
+    stats.taskCount = uxTaskGetNumberOfTasks();
+    stats.tasks = 0;
+
+#if SCHEDULER_STATS_ENABLED
+    uint32_t count;
+    uint32_t total;
+
+    // Take the counters of all the tasks at once, with the scheduler suspended
+    count = uxTaskGetSystemState(scheduler_status, SCHEDULER_STATS_TASKS, &total);
+    if (count == 0) return 0;
+
+    stats.runTime = total - scheduler_run_time;
+    scheduler_run_time = total;
+
+    for (uint32_t i = 0; i < count && stats.tasks < size; i++)
+    {
+        const TaskStatus_t& status = scheduler_status[i];
+        SchedulerTaskStats& task = tasks[stats.tasks++];
+        uint32_t previous = 0;
+
+        // Find the counter of the task at the previous query, if it existed
+        for (uint32_t j = 0; j < scheduler_counter_count; j++)
+        {
+            if (scheduler_counters[j].number == status.xTaskNumber)
+            {
+                previous = scheduler_counters[j].runTime;
+                break;
+            }
+        }
+
+        task.number = (uint8_t) status.xTaskNumber;
+        task.priority = (uint8_t) status.uxCurrentPriority;
+        task.state = (uint8_t) status.eCurrentState;
+        task.runTime = status.ulRunTimeCounter - previous;
+        task.load = getLoad(task.runTime, stats.runTime);
+        task.stackFree = status.usStackHighWaterMark;
+        strncpy(task.name, status.pcTaskName, SCHEDULER_NAME_LENGTH);
+        task.name[SCHEDULER_NAME_LENGTH] = '\0';
+    }
+
+    // Keep the counters for the next query
+    for (uint32_t i = 0; i < count; i++)
+    {
+        scheduler_counters[i].number = scheduler_status[i].xTaskNumber;
+        scheduler_counters[i].runTime = scheduler_status[i].ulRunTimeCounter;
+    }
+    scheduler_counter_count = count;
+#endif
+
+    return stats.tasks;
+}
+
+/**
+ * Takes the run-time statistics and writes them to the buffer as a report
+ * that python/library/Stats.py decodes. Returns the report length, or 0
+ * if it does not fit.
+ */
+uint32_t Scheduler::getReport(uint8_t* buffer, uint32_t size)
+{
+    getStats(scheduler_stats, scheduler_tasks, SCHEDULER_STATS_TASKS);
+
+    return encodeReport(scheduler_stats, scheduler_tasks, buffer, size);
+}
+
+/**
+ * Encodes the statistics, little endian: a header with the report version,
+ * the number of tasks in the system and in the report, the tick count,
+ * the run time, the run-time clock, the heap size, free bytes, lowest free
+ * bytes since startup and largest free block,
+ * followed by the number, priority, state, load, free stack words, run
+ * time and name of each task. The name is fixed-width, and only padded with
+ * NULs if it is shorter than SCHEDULER_NAME_LENGTH.
+ */
+uint32_t Scheduler::encodeReport(const SchedulerStats& stats, const SchedulerTaskStats* tasks, uint8_t* buffer, uint32_t size)
+{
+    uint8_t* data = buffer;
+
+    if (size < (uint32_t) (SCHEDULER_REPORT_HEADER + stats.tasks * SCHEDULER_REPORT_TASK)) return 0;
+
+    *data++ = SCHEDULER_REPORT_VERSION;
+    *data++ = stats.taskCount;
+    *data++ = stats.tasks;
+    data = put32(data, stats.ticks);
+    data = put32(data, stats.runTime);
+    data = put32(data, stats.clock);
+    data = put32(data, stats.heapSize);
+    data = put32(data, stats.heapFree);
+    data = put32(data, stats.heapMinimum);
+    data = put32(data, stats.heapLargest);
+
+    for (uint32_t i = 0; i < stats.tasks; i++)
+    {
+        *data++ = tasks[i].number;
+        *data++ = tasks[i].priority;
+        *data++ = tasks[i].state;
+        data = put16(data, tasks[i].load);
+        data = put16(data, tasks[i].stackFree);
+        data = put32(data, tasks[i].runTime);
+        memcpy(data, tasks[i].name, SCHEDULER_NAME_LENGTH);
+        data += SCHEDULER_NAME_LENGTH;
+    }
+
+    return (data - buffer);
+}
+
+/**
+ * Returns the share of the total time that the run time takes, in tenths
+ * of a percent. The times are scaled down to 22 bits first, so that the
+ * math fits in 32 bits and needs no 64-bit division from libgcc.
+ */
+uint16_t Scheduler::getLoad(uint32_t runTime, uint32_t totalTime)
+{
+    if (totalTime == 0) return 0;
+    if (runTime >= totalTime) return 1000;
+
+    while (totalTime >= (1UL << 22))
+    {
+        runTime >>= 1;
+        totalTime >>= 1;
+    }
+
+    return (uint16_t) ((runTime * 1000 + totalTime / 2) / totalTime);
+}
+
 /*=============================== protected =================================*/
 
 /*================================ private ==================================*/
+
+static uint8_t* put16(uint8_t* buffer, uint16_t value)
+{
+    *buffer++ = (uint8_t) (value >> 0);
+    *buffer++ = (uint8_t) (value >> 8);
+
+    return buffer;
+}
+
+static uint8_t* put32(uint8_t* buffer, uint32_t value)
+{
+    buffer = put16(buffer, (uint16_t) (value >> 0));
+    buffer = put16(buffer, (uint16_t) (value >> 16));
+
+    return buffer;
+}
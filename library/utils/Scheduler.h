@@ -12,15 +12,69 @@
 #ifndef SCHEDULER_H_
 #define SCHEDULER_H_
 
+#include <stdint.h>
+
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
 
+/**
+ * Number of tasks that Scheduler::getStats can report, including the idle
+ * and the timer tasks. With more tasks than this no task is reported.
+ */
+#ifndef SCHEDULER_STATS_TASKS
+#define SCHEDULER_STATS_TASKS               ( 8 )
+#endif
+
+/**
+ * Frequency of the run-time stats counter, see FreeRTOSConfig.h.
+ */
+#ifndef SCHEDULER_STATS_CLOCK_HZ
+#define SCHEDULER_STATS_CLOCK_HZ            ( configCPU_CLOCK_HZ )
+#endif
+
+#define SCHEDULER_NAME_LENGTH               ( 12 )
+
+#define SCHEDULER_REPORT_VERSION            ( 2 )
+#define SCHEDULER_REPORT_HEADER             ( 31 )
+#define SCHEDULER_REPORT_TASK               ( 23 )
+#define SCHEDULER_REPORT_LENGTH             ( SCHEDULER_REPORT_HEADER + SCHEDULER_STATS_TASKS * SCHEDULER_REPORT_TASK )
+
+// Run-time statistics of a task since the previous query
+struct SchedulerTaskStats
+{
+    uint8_t number;
+    uint8_t priority;
+    uint8_t state;
+    uint16_t load;
+    uint16_t stackFree;
+    uint32_t runTime;
+    char name[SCHEDULER_NAME_LENGTH + 1];
+};
+
+// Run-time statistics of the system since the previous query
+struct SchedulerStats
+{
+    uint32_t ticks;
+    uint32_t runTime;
+    uint32_t clock;
+    uint32_t heapSize;
+    uint32_t heapFree;
+    uint32_t heapMinimum;
+    uint32_t heapLargest;
+    uint8_t taskCount;
+    uint8_t tasks;
+};
+
 class Scheduler
 {
 public:
     Scheduler();
     static void run();
+    static uint32_t getStats(SchedulerStats& stats, SchedulerTaskStats* tasks, uint32_t size);
+    static uint32_t getReport(uint8_t* buffer, uint32_t size);
+    static uint32_t encodeReport(const SchedulerStats& stats, const SchedulerTaskStats* tasks, uint8_t* buffer, uint32_t size);
+    static uint16_t getLoad(uint32_t runTime, uint32_t totalTime);
 private:
 };
 
@@ -13,13 +13,22 @@
 
 #include "Serial.h"
 
+#include <string.h>
+
+#include "CriticalSection.h"
+#include "FreeRTOS.h"
+
 /*================================ define ===================================*/
 
 /*================================ typedef ==================================*/
 
 /*=============================== variables =================================*/
 
-static const uint8_t CRC_LENGTH = 2;    // Length of the CRC
+static const uint8_t HEADER_LENGTH = 2; // Length of a queued frame header
+static const uint32_t RX_FIFO_LENGTH = 16; // Length of the UART receive FIFO
+// Period to look for partial uDMA halves, at least a tick so that the task
+// blocks, as 2 ms is a zero tick timeout at the usual 100 Hz tick rate
+static const uint32_t RX_DMA_POLL_MS = (portTICK_RATE_MS > 2) ? portTICK_RATE_MS : 2;
 
 /*=============================== prototypes ================================*/
 
@@ -28,118 +37,183 @@ static const uint8_t CRC_LENGTH = 2;    // Length of the CRC
 Serial::Serial(Uart& uart):
     uart_(uart), \
     rxBuffer_(receive_buffer_, sizeof(receive_buffer_)), \
+    rxFrames_(0, sizeof(receive_buffer_) / (HEADER_LENGTH + 1)), \
+    rxDmaReady_(false), rxDmaCount_(0), rxDma_(false), \
+    rxContext_(CallbackContext_Interrupt), \
     txBuffer_(transmit_buffer_, sizeof(transmit_buffer_)), \
-    hdlc_(rxBuffer_, txBuffer_), \
-    rxCallback_(this, &Serial::rxCallback), txCallback_(this, &Serial::txCallback)
+    txFrames_(transmit_frames_, sizeof(transmit_frames_)), \
+    txBusy_(false), txLength_(0), txQueued_(0), txSent_(0), txDropped_(0), \
+    hdlc_(rxBuffer_, txBuffer_)
 {
 }
 
-void Serial::init(void)
+/**
+ * Starts the UART. With CallbackContext_Deferred the receive FIFO is
+ * drained by the work queue daemon instead of the UART interrupt, which
+ * keeps the interrupt short at the cost of relying on the FIFO to hold the
+ * bytes until the daemon runs. Transmission is always driven from the UART
+ * interrupt.
+ */
+void Serial::init(CallbackContext rxContext)
 {
-    // Register UART callbacks
-    uart_.setRxCallback(&rxCallback_);
-    uart_.setTxCallback(&txCallback_);
+    // Open the HDLC receive buffer before any byte can arrive
+    hdlc_.rxOpen();
+
+    // Receive with the uDMA and decode in task context, if the UART can
+    rxDma_ = uart_.readDma(receive_dma_, sizeof(receive_dma_));
+    rxContext_ = rxContext;
+
+    // Register UART callbacks, the transmit one runs from the UART interrupt
+    uart_.setRxCallback(Delegate::create<Serial, &Serial::rxCallback>(this), rxContext);
+    uart_.setTxCallback(Delegate::create<Serial, &Serial::txCallback>(this));
 
     // Enable UART interrupts
     uart_.enableInterrupts();
+}
 
-    // Open the HDLC receive buffer
-    hdlc_.rxOpen();
+/**
+ * Queues a frame for transmission and returns without waiting for it to be
+ * sent. Writers only contend on the encoding, so frames from several tasks
+ * follow each other on the UART without gaps. If the frame does not fit in
+ * the transmit buffer it is dropped and false is returned, so the caller
+ * can use getTxFree and getTxFrames to apply back-pressure. The callback,
+ * if any, runs from the UART interrupt once the frame has been sent.
+ */
+bool Serial::write(uint8_t* data, uint32_t size, Delegate callback)
+{
+    return write(nullptr, 0, data, size, callback);
 }
 
-void Serial::write(uint8_t* data, uint32_t size)
+/**
+ * Same as write, but the frame is made of a header followed by the data,
+ * so that a protocol layer does not have to copy them together first.
+ */
+bool Serial::write(uint8_t* header, uint32_t headerSize, uint8_t* data, uint32_t size, Delegate callback)
 {
     HdlcResult result = HdlcResult_Ok;
-    uint8_t byte;
-    bool status;
+    SerialFrame frame;
 
-    // Take the UART lock
-    uart_.txLock();
+    // Take the transmit lock, only writers contend on it
+    txMutex_.take();
 
-    // Reset the UART transmit buffer
-    txBuffer_.reset();
+    // Check once that the frame fits even if every byte has to be escaped
+    if (Hdlc::getTxMaxLength(headerSize + size) > txBuffer_.getFree()) goto error;
+
+    // Check that the frame can be tracked until it is sent
+    if (txFrames_.getFree() < sizeof(frame)) goto error;
 
     // Open the HDLC transmit buffer
     result = hdlc_.txOpen();
     if (result != HdlcResult_Ok) goto error;
 
-    // For each byte in the buffer
+    // Encode the header and the data as one payload
+    result = hdlc_.txPut(header, headerSize);
+    if (result != HdlcResult_Ok) goto error;
+
     result = hdlc_.txPut(data, size);
     if (result != HdlcResult_Ok) goto error;
 
-    // Close the HDLC buffer
-    result = hdlc_.txClose();
+    // Finish the HDLC frame without publishing it yet
+    result = hdlc_.txFinish();
     if (result != HdlcResult_Ok) goto error;
 
-    // Read first byte from the UART transmit buffer
-    status = txBuffer_.read(&byte);
-    if (status != true) goto error;
+    // Track the frame before it can be sent, so that its end is not missed
+    txQueued_ += hdlc_.getTxLength();
+    frame.end = txQueued_;
+    frame.callback = callback;
+    txFrames_.write((uint8_t *) &frame, sizeof(frame));
+
+    {
+        // The TX interrupt also checks for bytes and updates txBusy_
+        CriticalSection section;
+
+        // Publish the frame to the transmit buffer
+        hdlc_.txCommit();
+
+        // Start the UART if it went idle, otherwise the interrupt carries on
+        if (!txBusy_)
+        {
+            txBusy_ = txStart();
+        }
+    }
 
-    // Write first byte to the UART
-    uart_.writeByte(byte);
+    // Release the transmit lock
+    txMutex_.give();
 
-    return;
+    return true;
 
 error:
-    // Reset the UART buffer
-    txBuffer_.reset();
+    txDropped_++;
 
-    // Release the UART lock
-    uart_.txUnlock();
+    // Release the transmit lock
+    txMutex_.give();
 
-    return;
+    return false;
 }
 
+/**
+ * Blocks until a complete frame has been received and copies it to the
+ * buffer. Frames are queued as they arrive, so several frames may be sent
+ * back-to-back without waiting for the reader. Returns the frame length,
+ * or 0 if the frame did not fit in the buffer and was dropped.
+ */
 uint32_t Serial::read(uint8_t* buffer, uint32_t size)
 {
-    uint8_t data;
     uint32_t length;
 
-    // Lock the UART receive
-    uart_.rxLock();
-
-    // Update the length value and account for the CRC bytes
-    length = rxBuffer_.getSize() - CRC_LENGTH;
-
-    // Check for buffer overflow
-    if (length <= size)
+    // Wait until there is at least one frame queued
+    if (rxDma_)
     {
-        // Copy all bytes to the buffer except the CRC bytes
-        while (size--) {
-            rxBuffer_.read(&data);
-            *buffer++ = data;
-        }
-
-        // Read the CRC bytes from the buffer
-        rxBuffer_.read(&data);
-        rxBuffer_.read(&data);
+        rxDecode();
     }
     else
     {
-        length = 0;
+        rxFrames_.take();
     }
 
-    // Reset the receive buffer
-    rxBuffer_.reset();
-
-    // Open the HDLC receive buffer
-    hdlc_.rxOpen();
+    // Dequeue the oldest frame
+    length = hdlc_.rxRead(buffer, size);
 
     return length;
 }
 
+/**
+ * Returns the number of free bytes in the transmit buffer. A frame of
+ * size bytes always fits if Hdlc::getTxMaxLength(size) bytes are free.
+ */
+uint32_t Serial::getTxFree(void)
+{
+    return txBuffer_.getFree();
+}
+
+/**
+ * Returns the number of frames that have been queued but not sent yet.
+ */
+uint32_t Serial::getTxFrames(void)
+{
+    return txFrames_.getSize() / sizeof(SerialFrame);
+}
+
+/**
+ * Returns the number of frames dropped because they did not fit.
+ */
+uint32_t Serial::getTxDropped(void)
+{
+    return txDropped_;
+}
+
 /*=============================== protected =================================*/
 
 /*================================ private ==================================*/
 
-void Serial::rxCallback(void)
+/**
+ * Pushes one received byte through the HDLC decoder and returns true if
+ * it completed a frame with a correct CRC, which is then queued.
+ */
+bool Serial::rxParse(uint8_t byte)
 {
     HdlcStatus status;
     HdlcResult result;
-    uint8_t byte;
-
-    // Read byte from the UART
-    byte = uart_.readByte();
 
     // Put the byte in the HDLC receive buffer
     result = hdlc_.rxPut(byte);
@@ -148,42 +222,161 @@ void Serial::rxCallback(void)
     // Get the HDLC status
     status = hdlc_.getRxStatus();
 
-     // If HDLC frame is completed
+    // If HDLC frame is completed
     if (status == HdlcStatus_Done)
     {
-        // Close the HDLC frame
+        // Close the HDLC frame, which queues it if the CRC is correct
         result = hdlc_.rxClose();
-        if (result == HdlcResult_Error) goto error;
-
-        // Once done, free the UART lock
-        uart_.rxUnlockFromInterrupt();
+        return (result == HdlcResult_Ok);
     }
 
-    return;
+    return false;
 
 error:
-    // Reset the receive buffer
-    rxBuffer_.reset();
-
-    // Open the HDLC receive buffer
+    // Drop the frame being received, the queued frames are kept
     hdlc_.rxOpen();
 
-    return;
+    return false;
 }
 
-void Serial::txCallback(void)
+/**
+ * Decodes the bytes that the uDMA has received until a frame is queued.
+ * The RX callback signals each full half, and the half being filled is
+ * looked at periodically so that a frame shorter than a half is not held
+ * back until more bytes arrive. If the decoder falls more than a buffer
+ * behind, the overwritten bytes are skipped and the frame is dropped.
+ */
+void Serial::rxDecode(void)
 {
-    uint8_t byte;
+    uint32_t count;
 
-    // Read byte from the UART transmit buffer
-    if (txBuffer_.read(&byte) == true)
+    while (rxBuffer_.isEmpty())
     {
-        // Write byte to the UART
-        uart_.writeByte(byte);
+        // Wait for a full half, or look at the half being filled
+        rxDmaReady_.take(RX_DMA_POLL_MS);
+
+        // Get the number of bytes received so far
+        count = uart_.getDmaRxCount();
+
+        // Check if the uDMA has overwritten bytes that were not decoded
+        if (count - rxDmaCount_ > sizeof(receive_dma_))
+        {
+            rxDmaCount_ = count;
+            hdlc_.rxOpen();
+        }
+
+        // Decode the received bytes in the order they arrived
+        while (rxDmaCount_ != count)
+        {
+            rxParse(receive_dma_[rxDmaCount_ % sizeof(receive_dma_)]);
+            rxDmaCount_++;
+        }
+    }
+}
+
+void Serial::rxCallback(void)
+{
+    uint8_t bytes[RX_FIFO_LENGTH];
+    uint32_t length;
+
+    // With the uDMA, wake up the reader to decode the full half
+    if (rxDma_)
+    {
+        rxSignal(rxDmaReady_);
+        return;
+    }
+
+    // Drain the UART receive FIFO
+    length = uart_.readFifo(bytes, sizeof(bytes));
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        // Signal the reader each time one more frame is queued
+        if (rxParse(bytes[i]))
+        {
+            rxSignal(rxFrames_);
+        }
+    }
+}
+
+/**
+ * Wakes up the reader from the context that the RX callback runs in.
+ */
+void Serial::rxSignal(Semaphore& semaphore)
+{
+    if (rxContext_ == CallbackContext_Deferred)
+    {
+        semaphore.give();
     }
     else
     {
-        // Once done, free the UART lock
-        uart_.txUnlockFromInterrupt();
+        semaphore.giveFromInterrupt();
+    }
+}
+
+/**
+ * Hands the pending bytes to the UART, as one uDMA transfer up to the end
+ * of the transmit buffer or one byte at a time otherwise. Returns false if
+ * there is nothing to send.
+ */
+bool Serial::txStart(void)
+{
+    uint8_t* data;
+    uint32_t length;
+
+    // Get the pending bytes that are contiguous in the transmit buffer
+    length = txBuffer_.peekRead(&data);
+    if (length == 0) return false;
+
+    // Record the bytes in flight before the UART can complete them
+    txLength_ = length;
+
+    // Hand them all to the uDMA, if the UART has a channel
+    if (uart_.writeDma(data, length)) return true;
+
+    // Otherwise write the first byte, the TX interrupt asks for the next
+    txLength_ = 1;
+    uart_.writeByte(data[0]);
+
+    return true;
+}
+
+/**
+ * Runs the callbacks of the frames whose last byte has been sent.
+ */
+void Serial::txComplete(void)
+{
+    SerialFrame frame;
+    uint8_t* data;
+
+    // Frames are tracked in order and never wrap in the frame buffer
+    while (txFrames_.peekRead(&data) >= sizeof(frame))
+    {
+        memcpy(&frame, data, sizeof(frame));
+
+        // Check if the frame is still being sent
+        if ((int32_t) (txSent_ - frame.end) < 0) break;
+
+        txFrames_.commitRead(sizeof(frame));
+
+        if (frame.callback.isValid())
+        {
+            frame.callback.execute();
+        }
     }
 }
+
+void Serial::txCallback(void)
+{
+    // The bytes handed to the UART have been sent
+    txBuffer_.commitRead(txLength_);
+    txSent_ += txLength_;
+    txLength_ = 0;
+
+    // Notify the frames that are complete
+    txComplete();
+
+    // Keep the UART busy with the next bytes, or go idle, as writers
+    // publish their frames with this interrupt masked
+    txBusy_ = txStart();
+}
@@ -18,34 +18,63 @@
 
 #include "CircularBuffer.h"
 #include "Hdlc.h"
+#include "Mutex.h"
+#include "Semaphore.h"
+#include "WorkQueue.h"
 
-class Serial;
-
-typedef GenericCallback<Serial> SerialCallback;
+// A frame waiting to be sent, tracked until its last byte is out
+struct SerialFrame
+{
+    uint32_t end;
+    Delegate callback;
+};
 
 class Serial
 {
 public:
     Serial(Uart& uart);
-    void init(void);
-    void write(uint8_t* data, uint32_t size);
+    void init(CallbackContext rxContext = CallbackContext_Interrupt);
+    bool write(uint8_t* data, uint32_t size, Delegate callback = Delegate());
+    bool write(uint8_t* header, uint32_t headerSize, uint8_t* data, uint32_t size, Delegate callback = Delegate());
     uint32_t read(uint8_t* buffer, uint32_t size);
+    uint32_t getTxFree(void);
+    uint32_t getTxFrames(void);
+    uint32_t getTxDropped(void);
 private:
+    bool rxParse(uint8_t byte);
+    void rxDecode(void);
     void rxCallback(void);
+    void rxSignal(Semaphore& semaphore);
+    bool txStart(void);
+    void txComplete(void);
     void txCallback(void);
 private:
     Uart& uart_;
 
     uint8_t receive_buffer_[256];
     CircularBuffer rxBuffer_;
+    SemaphoreCounting rxFrames_;
+
+    uint8_t receive_dma_[128];
+    SemaphoreBinary rxDmaReady_;
+    uint32_t rxDmaCount_;
+    bool rxDma_;
+    CallbackContext rxContext_;
 
-    uint8_t transmit_buffer_[256];
+    uint8_t transmit_buffer_[512];
     CircularBuffer txBuffer_;
 
-    Hdlc hdlc_;
+    uint8_t transmit_frames_[8 * sizeof(SerialFrame)];
+    CircularBuffer txFrames_;
+
+    Mutex txMutex_;
+    bool txBusy_;
+    uint32_t txLength_;
+    uint32_t txQueued_;
+    uint32_t txSent_;
+    uint32_t txDropped_;
 
-    SerialCallback rxCallback_;
-    SerialCallback txCallback_;
+    Hdlc hdlc_;
 };
 
 #endif /* SERIAL_H_ */
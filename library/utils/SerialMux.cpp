@@ -0,0 +1,153 @@
+/**
+ * @file       SerialMux.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Channel multiplexer on top of the Serial HDLC frames.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include "SerialMux.h"
+
+/*================================ define ===================================*/
+
+/*================================ typedef ==================================*/
+
+/*=============================== variables =================================*/
+
+/*=============================== prototypes ================================*/
+
+/*================================= public ==================================*/
+
+SerialMux::SerialMux(Serial& serial):
+    serial_(serial), \
+    rxSynced_(0), rxDropped_(0), rxLost_(0)
+{
+    for (uint32_t i = 0; i < SerialMuxChannel_Count; i++)
+    {
+        handlers_[i] = SerialMuxHandler();
+        txSequence_[i] = 0;
+        rxSequence_[i] = 0;
+    }
+}
+
+/**
+ * Registers the handler that receives the frames of a channel, or removes
+ * it if the handler is empty. Frames for a channel without a handler
+ * are dropped. Handlers should be set before dispatch is running.
+ */
+bool SerialMux::setHandler(uint8_t channel, SerialMuxHandler handler)
+{
+    // Check the channel
+    if (channel >= SerialMuxChannel_Count) return false;
+
+    handlers_[channel] = handler;
+
+    return true;
+}
+
+/**
+ * Queues a frame on a channel, see Serial::write. The sequence number is
+ * taken even if the frame does not fit, so that the receiver sees the
+ * dropped frame as a gap in the channel. Writers of the same channel may
+ * be concurrent, the frames are queued in the order of their numbers.
+ */
+bool SerialMux::write(uint8_t channel, uint8_t flags, uint8_t* data, uint32_t size, Delegate callback)
+{
+    uint8_t header[HEADER_LENGTH];
+    bool result;
+
+    // Check the channel
+    if (channel >= SerialMuxChannel_Count) return false;
+
+    // Take the transmit lock, so that no writer queues a later number first
+    txMutex_.take();
+
+    // Build the header
+    header[0] = channel;
+    header[1] = txSequence_[channel]++;
+    header[2] = flags;
+
+    // Queue the header and the data as one frame
+    result = serial_.write(header, sizeof(header), data, size, callback);
+
+    // Release the transmit lock
+    txMutex_.give();
+
+    return result;
+}
+
+/**
+ * Blocks until a frame has been received and hands it to the handler of
+ * its channel, from the calling task. Returns false if the frame was
+ * dropped because it was malformed or its channel has no handler.
+ */
+bool SerialMux::dispatch(void)
+{
+    SerialMuxFrame frame;
+    SerialMuxHandler handler;
+    uint32_t length;
+    uint8_t expected;
+
+    // Wait for the next frame
+    length = serial_.read(receive_buffer_, sizeof(receive_buffer_));
+    if (length < HEADER_LENGTH) goto error;
+
+    // Parse the header
+    frame.channel  = receive_buffer_[0];
+    frame.sequence = receive_buffer_[1];
+    frame.flags    = receive_buffer_[2];
+    frame.data     = &receive_buffer_[HEADER_LENGTH];
+    frame.length   = length - HEADER_LENGTH;
+
+    // Check the channel and get its handler
+    if (frame.channel >= SerialMuxChannel_Count) goto error;
+
+    handler = handlers_[frame.channel];
+    if (!handler.isValid()) goto error;
+
+    // Count the frames missed since the last one, once the channel is synced
+    expected = rxSequence_[frame.channel];
+    if ((rxSynced_ & (1 << frame.channel)) && frame.sequence != expected)
+    {
+        rxLost_ += (uint8_t) (frame.sequence - expected);
+    }
+
+    rxSequence_[frame.channel] = frame.sequence + 1;
+    rxSynced_ |= (1 << frame.channel);
+
+    // Hand the frame to the channel handler
+    handler.execute(frame);
+
+    return true;
+
+error:
+    rxDropped_++;
+
+    return false;
+}
+
+/**
+ * Returns the number of received frames that were dropped.
+ */
+uint32_t SerialMux::getRxDropped(void)
+{
+    return rxDropped_;
+}
+
+/**
+ * Returns the number of frames missed on any channel, as seen from the
+ * gaps in their sequence numbers.
+ */
+uint32_t SerialMux::getRxLost(void)
+{
+    return rxLost_;
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
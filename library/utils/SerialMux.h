@@ -0,0 +1,86 @@
+/**
+ * @file       SerialMux.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Channel multiplexer on top of the Serial HDLC frames.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef SERIAL_MUX_H_
+#define SERIAL_MUX_H_
+
+#include <stdint.h>
+
+#include "Mutex.h"
+#include "Serial.h"
+
+class SerialMux;
+
+enum SerialMuxChannel : uint8_t
+{
+    SerialMuxChannel_Data    = 0,
+    SerialMuxChannel_Command = 1,
+    SerialMuxChannel_Log     = 2,
+    SerialMuxChannel_Stats   = 3,
+    SerialMuxChannel_Count   = 8,
+};
+
+// The multiplexer carries the flags, their meaning is up to each channel
+enum SerialMuxFlag : uint8_t
+{
+    SerialMuxFlag_None     = 0x00,
+    SerialMuxFlag_Request  = 0x01,
+    SerialMuxFlag_Response = 0x02,
+    SerialMuxFlag_Error    = 0x04,
+};
+
+// A received frame, the data points into the multiplexer buffer
+struct SerialMuxFrame
+{
+    uint8_t channel;
+    uint8_t sequence;
+    uint8_t flags;
+    uint8_t* data;
+    uint32_t length;
+};
+
+// Receives the frames of a channel, e.g.
+// SerialMuxHandler::create<StatsService, &StatsService::receive>(this)
+typedef BasicDelegate<SerialMuxFrame&> SerialMuxHandler;
+
+/**
+ * Shares one Serial port between independent channels. Each frame starts
+ * with a three-byte header (channel, sequence number, flags) followed by
+ * the payload, and the sequence numbers run per channel in each direction
+ * so that the receiver can count the frames it has missed.
+ */
+class SerialMux
+{
+public:
+    static const uint32_t HEADER_LENGTH = 3;
+public:
+    SerialMux(Serial& serial);
+    bool setHandler(uint8_t channel, SerialMuxHandler handler);
+    bool write(uint8_t channel, uint8_t flags, uint8_t* data, uint32_t size, Delegate callback = Delegate());
+    bool dispatch(void);
+    uint32_t getRxDropped(void);
+    uint32_t getRxLost(void);
+private:
+    Serial& serial_;
+
+    SerialMuxHandler handlers_[SerialMuxChannel_Count];
+
+    Mutex txMutex_;
+    uint8_t txSequence_[SerialMuxChannel_Count];
+
+    uint8_t receive_buffer_[256];
+    uint8_t rxSequence_[SerialMuxChannel_Count];
+    uint8_t rxSynced_;
+    uint32_t rxDropped_;
+    uint32_t rxLost_;
+};
+
+#endif /* SERIAL_MUX_H_ */
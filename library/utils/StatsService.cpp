@@ -0,0 +1,74 @@
+/**
+ * @file       StatsService.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Answers the run-time statistics queries on the serial port.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include "StatsService.h"
+
+/*================================ define ===================================*/
+
+/*================================ typedef ==================================*/
+
+/*=============================== variables =================================*/
+
+/*=============================== prototypes ================================*/
+
+/*================================= public ==================================*/
+
+StatsService::StatsService(SerialMux& mux):
+    mux_(mux), requests_(0)
+{
+}
+
+/**
+ * Registers the service on the stats channel.
+ */
+bool StatsService::init(void)
+{
+    return mux_.setHandler(SerialMuxChannel_Stats, SerialMuxHandler::create<StatsService, &StatsService::receive>(this));
+}
+
+/**
+ * Returns the number of requests answered.
+ */
+uint32_t StatsService::getRequests(void)
+{
+    return requests_;
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+/**
+ * Answers a request, from the task that runs SerialMux::dispatch.
+ */
+void StatsService::receive(SerialMuxFrame& frame)
+{
+    uint32_t length;
+
+    // Only requests are answered
+    if ((frame.flags & SerialMuxFlag_Request) == 0) return;
+
+    requests_++;
+
+    // Take the statistics since the previous request
+    length = Scheduler::getReport(report_, sizeof(report_));
+
+    if (length > 0)
+    {
+        mux_.write(SerialMuxChannel_Stats, SerialMuxFlag_Response, report_, length);
+    }
+    else
+    {
+        mux_.write(SerialMuxChannel_Stats, SerialMuxFlag_Response | SerialMuxFlag_Error, nullptr, 0);
+    }
+}
@@ -0,0 +1,41 @@
+/**
+ * @file       StatsService.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Answers the run-time statistics queries on the serial port.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef STATS_SERVICE_H_
+#define STATS_SERVICE_H_
+
+#include <stdint.h>
+
+#include "Scheduler.h"
+#include "SerialMux.h"
+
+/**
+ * Handles the stats channel of a SerialMux: each request frame is answered
+ * with a response frame that carries the Scheduler report, i.e. the CPU
+ * load and stack headroom of every task and the heap headroom, or with an
+ * error frame if the report does not fit.
+ */
+class StatsService
+{
+public:
+    StatsService(SerialMux& mux);
+    bool init(void);
+    uint32_t getRequests(void);
+private:
+    void receive(SerialMuxFrame& frame);
+private:
+    SerialMux& mux_;
+
+    uint8_t report_[SCHEDULER_REPORT_LENGTH];
+    uint32_t requests_;
+};
+
+#endif /* STATS_SERVICE_H_ */
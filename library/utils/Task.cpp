@@ -32,6 +32,22 @@ void Task::delay(uint32_t milliseconds)
     vTaskDelay(milliseconds / portTICK_RATE_MS);
 }
 
+/**
+ * Blocks until the given time after the previous wake time, which is then
+ * advanced by that time. Unlike delay, the period of a loop that calls it
+ * does not drift with the time the loop body takes. The wake time starts
+ * at getTicks().
+ */
+void Task::delayUntil(TickType_t& wakeTime, uint32_t milliseconds)
+{
+    vTaskDelayUntil(&wakeTime, milliseconds / portTICK_RATE_MS);
+}
+
+TickType_t Task::getTicks(void)
+{
+    return xTaskGetTickCount();
+}
+
 void Task::remove()
 {
     vTaskDelete(NULL);
@@ -40,4 +56,31 @@ void Task::remove()
 
 /*=============================== protected =================================*/
 
+/**
+ * Creates a task on a stack provided by the caller. The kernel still takes
+ * the task control block from the heap.
+ */
+bool Task::create(TaskFunction_t function, const char* name, void* parameter, \
+                  uint32_t priority, StackType_t* stack, uint32_t stackWords, \
+                  TaskHandle_t* handle)
+{
+    BaseType_t status;
+
+    status = xTaskGenericCreate(function, (const char *) name, (uint16_t) stackWords, \
+                                parameter, priority, handle, stack, NULL);
+
+    return (status == pdPASS);
+}
+
+/**
+ * Blocks the calling task forever.
+ */
+void Task::park(void)
+{
+    while (true)
+    {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
+
 /*================================ private ==================================*/
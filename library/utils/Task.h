@@ -16,13 +16,109 @@
 #include "task.h"
 #include "semphr.h"
 
+#include "Callback.h"
+
 class Task
 {
 public:
     Task();
     static void delay(uint32_t milliseconds);
+    static void delayUntil(TickType_t& wakeTime, uint32_t milliseconds);
+    static TickType_t getTicks(void);
     static void remove(void);
+protected:
+    static bool create(TaskFunction_t function, const char* name, void* parameter, \
+                       uint32_t priority, StackType_t* stack, uint32_t stackWords, \
+                       TaskHandle_t* handle);
+    static void park(void);
+private:
+};
+
+/**
+ * Task whose stack is a member of the object, so that a StaticTask declared
+ * at file scope places its stack in .bss and its size shows up in the map
+ * file instead of being carved out of the kernel heap at startup. The stack
+ * size and the priority are template arguments and are checked when the
+ * task is declared.
+ *
+ * The task runs a Delegate, usually a member function of the object that
+ * owns the task:
+ *
+ *   static StaticTask<128, tskIDLE_PRIORITY + 1> task("Sensor");
+ *   task.start(Delegate::create<Sensor, &Sensor::run>(&sensor));
+ *
+ * The kernel frees the stack of a task that is deleted, so a StaticTask is
+ * never deleted: if the delegate returns, the task is parked instead.
+ */
+template<uint32_t StackWords, uint32_t Priority>
+class StaticTask : public Task
+{
+    static_assert(StackWords >= configMINIMAL_STACK_SIZE, "The task stack is below the minimal stack size!");
+    static_assert(StackWords <= 0xFFFF, "The task stack does not fit the kernel stack depth!");
+    static_assert(Priority < configMAX_PRIORITIES, "The task priority is above the maximum priority!");
+public:
+    StaticTask(const char* name);
+    bool start(const Delegate& delegate);
+    TaskHandle_t getHandle(void);
+    bool isStarted(void);
+private:
+    static void run(void* parameter);
 private:
+    const char* name_;
+    Delegate delegate_;
+    TaskHandle_t handle_;
+    bool started_;
+
+    StackType_t stack_[StackWords];
 };
 
+/*================================= public ==================================*/
+
+template<uint32_t StackWords, uint32_t Priority>
+StaticTask<StackWords, Priority>::StaticTask(const char* name):
+    name_(name), handle_(nullptr), started_(false)
+{
+}
+
+/**
+ * Creates the task on its own stack. A task can only be started once.
+ */
+template<uint32_t StackWords, uint32_t Priority>
+bool StaticTask<StackWords, Priority>::start(const Delegate& delegate)
+{
+    if (started_ || !delegate.isValid()) return false;
+
+    delegate_ = delegate;
+
+    started_ = create(run, name_, this, Priority, stack_, StackWords, &handle_);
+
+    return started_;
+}
+
+template<uint32_t StackWords, uint32_t Priority>
+TaskHandle_t StaticTask<StackWords, Priority>::getHandle(void)
+{
+    return handle_;
+}
+
+template<uint32_t StackWords, uint32_t Priority>
+bool StaticTask<StackWords, Priority>::isStarted(void)
+{
+    return started_;
+}
+
+/*================================ private ==================================*/
+
+template<uint32_t StackWords, uint32_t Priority>
+void StaticTask<StackWords, Priority>::run(void* parameter)
+{
+    StaticTask* task = static_cast<StaticTask*>(parameter);
+
+    // Run the task body, which usually does not return
+    task->delegate_.execute();
+
+    // Deleting the task would hand its stack to the heap
+    park();
+}
+
 #endif /* TASK_H_ */
@@ -0,0 +1,307 @@
+/**
+ * @file       Trace.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Binary event tracer for interrupts, task switches and drivers.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <string.h>
+
+#include <atomic>
+
+#include "FreeRTOS.h"
+
+#include "Serial.h"
+#include "Task.h"
+#include "Trace.h"
+
+/*================================ define ===================================*/
+
+static_assert((TRACE_LENGTH & (TRACE_LENGTH - 1)) == 0, "The trace length must be a power of two!");
+
+/**
+ * Timestamp of the records. The DWT cycle counter runs at the CPU clock,
+ * i.e. 32 MHz, and wraps every 134 seconds, which the decoder unwraps.
+ */
+#ifndef TRACE_TIMESTAMP
+#define DEMCR                               ( *(volatile uint32_t *) 0xE000EDFC )
+#define DEMCR_TRCENA                        ( 1 << 24 )
+#define DWT_CTRL                            ( *(volatile uint32_t *) 0xE0001000 )
+#define DWT_CTRL_CYCCNTENA                  ( 1 << 0 )
+#define DWT_CYCCNT                          ( *(volatile uint32_t *) 0xE0001004 )
+
+#define TRACE_TIMESTAMP()                   ( DWT_CYCCNT )
+#define TRACE_TIMESTAMP_START()             do { DEMCR |= DEMCR_TRCENA; DWT_CTRL |= DWT_CTRL_CYCCNTENA; } while (0)
+#endif
+
+#ifndef TRACE_CLOCK_HZ
+#define TRACE_CLOCK_HZ                      ( configCPU_CLOCK_HZ )
+#endif
+
+#define TRACE_VERSION                       ( 1 )
+#define TRACE_RECORD_LENGTH                 ( 8 )
+#define TRACE_FRAME_RECORDS                 ( 16 )
+#define TRACE_DUMP_DELAY_MS                 ( 5 )
+
+enum TraceFrame
+{
+    TraceFrame_Header  = 0xE0,
+    TraceFrame_Tasks   = 0xE1,
+    TraceFrame_Records = 0xE2,
+    TraceFrame_End     = 0xE3
+};
+
+/*================================ typedef ==================================*/
+
+struct TraceTask
+{
+    uint16_t id;
+    uint8_t priority;
+    char name[TRACE_NAME_LENGTH];
+};
+
+/*=============================== prototypes ================================*/
+
+static uint8_t* put16(uint8_t* buffer, uint16_t value);
+static uint8_t* put32(uint8_t* buffer, uint32_t value);
+
+/*=============================== variables =================================*/
+
+static TraceRecord trace_records[TRACE_LENGTH];
+static std::atomic<uint32_t> trace_count;
+static std::atomic<bool> trace_enabled;
+static uint32_t trace_overhead;
+
+static TraceTask trace_tasks[TRACE_TASKS];
+static std::atomic<uint32_t> trace_task_count;
+
+/*================================= public ==================================*/
+
+/**
+ * Records an event. It may be called from any task or interrupt: the slot
+ * is claimed with a single atomic increment and nothing is masked, so a
+ * record that is preempted may end up before one with an older timestamp.
+ */
+void traceRecord(uint8_t event, uint8_t id, uint16_t arg)
+{
+    TraceRecord* record;
+    uint32_t index;
+
+    if (!trace_enabled.load(std::memory_order_relaxed)) return;
+
+    // Claim the next slot, overwriting the oldest record
+    index = trace_count.fetch_add(1, std::memory_order_relaxed);
+    record = &trace_records[index & (TRACE_LENGTH - 1)];
+
+    record->timestamp = TRACE_TIMESTAMP();
+    record->event = event;
+    record->id = id;
+    record->arg = arg;
+}
+
+/**
+ * Keeps the name of a task that has just been created, so that the decoder
+ * can name the task switches. Tasks created before the tracer starts are
+ * also kept.
+ */
+void traceTaskCreate(void* task, const char* name, uint32_t priority)
+{
+    TraceTask* entry;
+    uint32_t index;
+
+    index = trace_task_count.fetch_add(1);
+
+    if (index < TRACE_TASKS)
+    {
+        entry = &trace_tasks[index];
+        entry->id = TRACE_ID(task);
+        entry->priority = (uint8_t) priority;
+        strncpy(entry->name, name, TRACE_NAME_LENGTH);
+    }
+
+    traceRecord(TraceEvent_TaskCreate, (uint8_t) priority, TRACE_ID(task));
+}
+
+/**
+ * Discards the previous records and starts recording. The first two
+ * records are written back to back, so that the decoder can tell the cost
+ * of recording an event from their timestamps.
+ */
+void Trace::start(void)
+{
+    TRACE_TIMESTAMP_START();
+
+    trace_enabled = false;
+    trace_count = 0;
+    trace_enabled = true;
+
+    traceRecord(TraceEvent_Start, 0, 0);
+    traceRecord(TraceEvent_Start, 1, 0);
+
+    trace_overhead = trace_records[1].timestamp - trace_records[0].timestamp;
+}
+
+void Trace::stop(void)
+{
+    traceRecord(TraceEvent_Stop, 0, 0);
+
+    trace_enabled = false;
+}
+
+bool Trace::isEnabled(void)
+{
+    return trace_enabled;
+}
+
+/**
+ * Returns the number of events recorded since the tracer started, of
+ * which the last TRACE_LENGTH are kept.
+ */
+uint32_t Trace::getCount(void)
+{
+    return trace_count;
+}
+
+/**
+ * Returns the cost of recording an event, in CPU cycles.
+ */
+uint32_t Trace::getOverhead(void)
+{
+    return trace_overhead;
+}
+
+/**
+ * Writes the next dump frame to the buffer and returns its length, or 0
+ * once all the frames have been written. The cursor starts at 0 and keeps
+ * track of the next frame. The tracer should be stopped while dumping.
+ */
+uint32_t Trace::getFrame(uint8_t* buffer, uint32_t size, uint32_t& cursor)
+{
+    uint32_t count = trace_count;
+    uint32_t tasks = trace_task_count;
+    uint32_t first = (count > TRACE_LENGTH) ? (count - TRACE_LENGTH) : 0;
+    uint32_t chunks = (count - first + TRACE_FRAME_RECORDS - 1) / TRACE_FRAME_RECORDS;
+    uint8_t* data = buffer;
+
+    if (tasks > TRACE_TASKS) tasks = TRACE_TASKS;
+
+    if (cursor == 0)
+    {
+        // Header with the clock, the number of records and the overhead
+        if (size < 22) return 0;
+
+        *data++ = TraceFrame_Header;
+        *data++ = 'T';
+        *data++ = 'R';
+        *data++ = TRACE_VERSION;
+        *data++ = TRACE_RECORD_LENGTH;
+        *data++ = (uint8_t) tasks;
+        data = put16(data, TRACE_LENGTH);
+        data = put32(data, TRACE_CLOCK_HZ);
+        data = put32(data, count);
+        data = put32(data, first);
+        data = put16(data, (uint16_t) trace_overhead);
+    }
+    else if (cursor == 1)
+    {
+        // Names of the tasks
+        if (size < 2 + tasks * (3 + TRACE_NAME_LENGTH)) return 0;
+
+        *data++ = TraceFrame_Tasks;
+        *data++ = (uint8_t) tasks;
+
+        for (uint32_t i = 0; i < tasks; i++)
+        {
+            data = put16(data, trace_tasks[i].id);
+            *data++ = trace_tasks[i].priority;
+            memcpy(data, trace_tasks[i].name, TRACE_NAME_LENGTH);
+            data += TRACE_NAME_LENGTH;
+        }
+    }
+    else if (cursor < 2 + chunks)
+    {
+        // A chunk of records, oldest first
+        uint32_t start = first + (cursor - 2) * TRACE_FRAME_RECORDS;
+        uint32_t end = start + TRACE_FRAME_RECORDS;
+
+        if (end > count) end = count;
+        if (size < 5 + (end - start) * TRACE_RECORD_LENGTH) return 0;
+
+        *data++ = TraceFrame_Records;
+        data = put32(data, start);
+
+        for (uint32_t i = start; i < end; i++)
+        {
+            const TraceRecord& record = trace_records[i & (TRACE_LENGTH - 1)];
+
+            data = put32(data, record.timestamp);
+            *data++ = record.event;
+            *data++ = record.id;
+            data = put16(data, record.arg);
+        }
+    }
+    else if (cursor == 2 + chunks)
+    {
+        *data++ = TraceFrame_End;
+    }
+    else
+    {
+        return 0;
+    }
+
+    cursor++;
+
+    return (data - buffer);
+}
+
+/**
+ * Stops the tracer and sends the dump frames over the serial port, waiting
+ * for room in the transmit buffer as needed. Returns false if a frame does
+ * not fit in the transmit buffer at all.
+ */
+bool Trace::dump(Serial& serial)
+{
+    uint8_t buffer[5 + TRACE_FRAME_RECORDS * TRACE_RECORD_LENGTH];
+    uint32_t cursor = 0;
+    uint32_t length;
+
+    stop();
+
+    while ((length = getFrame(buffer, sizeof(buffer), cursor)) > 0)
+    {
+        // Wait for the frames before this one to drain
+        while (!serial.write(buffer, length))
+        {
+            if (serial.getTxFrames() == 0) return false;
+            Task::delay(TRACE_DUMP_DELAY_MS);
+        }
+    }
+
+    return true;
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+static uint8_t* put16(uint8_t* buffer, uint16_t value)
+{
+    *buffer++ = (uint8_t) (value >> 0);
+    *buffer++ = (uint8_t) (value >> 8);
+
+    return buffer;
+}
+
+static uint8_t* put32(uint8_t* buffer, uint32_t value)
+{
+    buffer = put16(buffer, (uint16_t) (value >> 0));
+    buffer = put16(buffer, (uint16_t) (value >> 16));
+
+    return buffer;
+}
@@ -0,0 +1,167 @@
+/**
+ * @file       Trace.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Binary event tracer for interrupts, task switches and drivers.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+/*
+ * This header is also included from FreeRTOSConfig.h, so that the kernel
+ * trace hooks record events, and must therefore remain valid C.
+ */
+
+#include <stdint.h>
+
+/**
+ * Whether the trace points record events. When not set they compile to
+ * nothing, and so do the kernel trace hooks.
+ */
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED                       ( 0 )
+#endif
+
+/**
+ * Number of records kept in RAM, a power of two. Once full the oldest
+ * records are overwritten, so the buffer holds the events that led to the
+ * moment the trace is stopped.
+ */
+#ifndef TRACE_LENGTH
+#define TRACE_LENGTH                        ( 256 )
+#endif
+
+/**
+ * Number of tasks whose names are kept for the decoder.
+ */
+#ifndef TRACE_TASKS
+#define TRACE_TASKS                         ( 8 )
+#endif
+
+#define TRACE_NAME_LENGTH                   ( 12 )
+
+enum TraceEvent
+{
+    TraceEvent_Start               = 0x00,
+    TraceEvent_Stop                = 0x01,
+
+    /* Kernel hooks, the argument identifies the task or the queue */
+    TraceEvent_TaskCreate          = 0x10,
+    TraceEvent_TaskSwitchedIn      = 0x11,
+    TraceEvent_TaskSwitchedOut     = 0x12,
+    TraceEvent_QueueSend           = 0x18,
+    TraceEvent_QueueSendFailed     = 0x19,
+    TraceEvent_QueueSendFromIsr    = 0x1A,
+    TraceEvent_QueueSendFromIsrFailed = 0x1B,
+    TraceEvent_QueueReceive        = 0x1C,
+    TraceEvent_QueueReceiveFailed  = 0x1D,
+    TraceEvent_QueueReceiveFromIsr = 0x1E,
+    TraceEvent_QueueBlockingSend   = 0x1F,
+    TraceEvent_QueueBlockingReceive = 0x20,
+
+    /* Interrupts, the identifier is the interrupt number */
+    TraceEvent_IsrEnter            = 0x30,
+    TraceEvent_IsrExit             = 0x31,
+
+    /*
+     * Drivers: the radio events carry the radio state, the I2C events the
+     * slave address and the number of bytes, bit 15 set for reads
+     */
+    TraceEvent_RadioSfd            = 0x40,
+    TraceEvent_RadioRxDone         = 0x41,
+    TraceEvent_RadioTxDone         = 0x42,
+    TraceEvent_RadioFifop          = 0x43,
+    TraceEvent_RadioError          = 0x44,
+    TraceEvent_RadioDma            = 0x45,
+    TraceEvent_RadioBusy           = 0x46,
+    TraceEvent_UartRx              = 0x48,
+    TraceEvent_UartRxDma           = 0x49,
+    TraceEvent_UartTx              = 0x4A,
+    TraceEvent_I2cStart            = 0x50,
+    TraceEvent_I2cDone             = 0x51,
+    TraceEvent_I2cTimeout          = 0x52,
+
+    /* Free for the application */
+    TraceEvent_User                = 0x80
+};
+
+/**
+ * A trace record, two words: the timestamp in CPU cycles and the event,
+ * with an 8-bit identifier and a 16-bit argument whose meaning depends on
+ * the event.
+ */
+struct TraceRecord
+{
+    uint32_t timestamp;
+    uint8_t event;
+    uint8_t id;
+    uint16_t arg;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void traceRecord(uint8_t event, uint8_t id, uint16_t arg);
+void traceTaskCreate(void* task, const char* name, uint32_t priority);
+
+#ifdef __cplusplus
+}
+#endif
+
+// Identifies a kernel object by the low half of its address
+#define TRACE_ID(object)                    ( ( uint16_t ) ( uintptr_t ) ( object ) )
+
+#if (TRACE_ENABLED == 1)
+
+#define TRACE_EVENT(event, id, arg)         traceRecord( ( event ), ( uint8_t ) ( id ), ( uint16_t ) ( arg ) )
+
+/* Kernel trace hooks, see FreeRTOS.h */
+#define traceTASK_CREATE( pxNewTCB )        traceTaskCreate( ( pxNewTCB ), ( pxNewTCB )->pcTaskName, ( pxNewTCB )->uxPriority )
+#define traceTASK_SWITCHED_IN()             TRACE_EVENT( TraceEvent_TaskSwitchedIn, pxCurrentTCB->uxPriority, TRACE_ID( pxCurrentTCB ) )
+#define traceTASK_SWITCHED_OUT()            TRACE_EVENT( TraceEvent_TaskSwitchedOut, pxCurrentTCB->uxPriority, TRACE_ID( pxCurrentTCB ) )
+#define traceQUEUE_SEND( pxQueue )          TRACE_EVENT( TraceEvent_QueueSend, 0, TRACE_ID( pxQueue ) )
+#define traceQUEUE_SEND_FAILED( pxQueue )   TRACE_EVENT( TraceEvent_QueueSendFailed, 0, TRACE_ID( pxQueue ) )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue ) TRACE_EVENT( TraceEvent_QueueSendFromIsr, 0, TRACE_ID( pxQueue ) )
+#define traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue ) TRACE_EVENT( TraceEvent_QueueSendFromIsrFailed, 0, TRACE_ID( pxQueue ) )
+#define traceQUEUE_RECEIVE( pxQueue )       TRACE_EVENT( TraceEvent_QueueReceive, 0, TRACE_ID( pxQueue ) )
+#define traceQUEUE_RECEIVE_FAILED( pxQueue ) TRACE_EVENT( TraceEvent_QueueReceiveFailed, 0, TRACE_ID( pxQueue ) )
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue ) TRACE_EVENT( TraceEvent_QueueReceiveFromIsr, 0, TRACE_ID( pxQueue ) )
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue ) TRACE_EVENT( TraceEvent_QueueBlockingSend, 0, TRACE_ID( pxQueue ) )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue ) TRACE_EVENT( TraceEvent_QueueBlockingReceive, 0, TRACE_ID( pxQueue ) )
+
+#else
+
+#define TRACE_EVENT(event, id, arg)
+
+#endif
+
+#ifdef __cplusplus
+
+class Serial;
+
+/**
+ * Controls the tracer and reads the records back. The records are dumped
+ * as a sequence of frames: a header, the task names, the records in chunks
+ * and an end marker, which python/library/Trace.py turns into a timeline.
+ */
+class Trace
+{
+public:
+    static void start(void);
+    static void stop(void);
+    static bool isEnabled(void);
+    static uint32_t getCount(void);
+    static uint32_t getOverhead(void);
+    static uint32_t getFrame(uint8_t* buffer, uint32_t size, uint32_t& cursor);
+    static bool dump(Serial& serial);
+};
+
+#endif
+
+#endif /* TRACE_H_ */
@@ -0,0 +1,236 @@
+/**
+ * @file       WorkQueue.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Deferred execution of interrupt callbacks in a daemon task.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include "WorkQueue.h"
+
+/*================================ define ===================================*/
+
+/*================================ typedef ==================================*/
+
+/*=============================== variables =================================*/
+
+// Storage of the work queue, see WorkQueue::getInstance
+alignas(WorkQueue) static uint8_t work_queue[sizeof(WorkQueue)];
+
+WorkQueue* WorkQueue::instance_ = nullptr;
+
+/*=============================== prototypes ================================*/
+
+/*================================= public ==================================*/
+
+WorkItem::WorkItem():
+    callback_(), pending_(false), next_(nullptr)
+{
+}
+
+/**
+ * Sets the callback that the daemon runs and makes sure that the daemon
+ * is running.
+ */
+void WorkItem::setCallback(Delegate callback)
+{
+    callback_ = callback;
+
+    WorkQueue::getInstance().start();
+}
+
+/**
+ * Returns the delegate that a peripheral has to run from its interrupt
+ * handler for the callback to run in the given context: the callback
+ * itself, or the trigger of the item.
+ */
+Delegate WorkItem::bind(Delegate callback, CallbackContext context)
+{
+    // Run the callback straight from the interrupt handler
+    if (context == CallbackContext_Interrupt || !callback.isValid())
+    {
+        return callback;
+    }
+
+    // Otherwise hand it over to the daemon
+    setCallback(callback);
+
+    return getTrigger();
+}
+
+/**
+ * Returns a delegate that schedules the item, to be registered as the
+ * interrupt callback of a peripheral.
+ */
+Delegate WorkItem::getTrigger(void)
+{
+    return Delegate::create<WorkItem, &WorkItem::trigger>(this);
+}
+
+/**
+ * Hands the item over to the daemon. Returns false if it was already
+ * pending, in which case it still runs once. This is meant to be called
+ * from tasks, see scheduleFromInterrupt for interrupt handlers.
+ */
+bool WorkItem::schedule(void)
+{
+    return WorkQueue::getInstance().schedule(this);
+}
+
+bool WorkItem::scheduleFromInterrupt(void)
+{
+    return WorkQueue::getInstance().scheduleFromInterrupt(this);
+}
+
+bool WorkItem::isPending(void)
+{
+    return pending_;
+}
+
+/**
+ * Schedules the item from the interrupt handler that runs the trigger.
+ */
+void WorkItem::trigger(void)
+{
+    scheduleFromInterrupt();
+}
+
+/**
+ * Returns the work queue, which is built on first use so that it does not
+ * depend on the order of the static constructors. The first use is setting
+ * a deferred callback, before the interrupts are enabled. The work queue is
+ * never destroyed, as the daemon runs for as long as the program does.
+ */
+WorkQueue& WorkQueue::getInstance(void)
+{
+    if (instance_ == nullptr)
+    {
+        instance_ = new (work_queue) WorkQueue();
+    }
+
+    return *instance_;
+}
+
+/**
+ * Creates the daemon task, once. It may be called before the scheduler
+ * runs, and work scheduled before the daemon runs is kept.
+ */
+void WorkQueue::start(void)
+{
+    bool stopped = false;
+
+    // Only the first caller creates the daemon
+    if (!started_.compare_exchange_strong(stopped, true)) return;
+
+    xTaskCreate(daemon, (const char *) "WorkQueue", WORK_QUEUE_STACK, this, WORK_QUEUE_PRIORITY, NULL);
+}
+
+bool WorkQueue::schedule(WorkItem* item)
+{
+    if (!push(item)) return false;
+
+    // Wake up the daemon, which preempts the calling task
+    ready_.give();
+
+    return true;
+}
+
+bool WorkQueue::scheduleFromInterrupt(WorkItem* item)
+{
+    if (!push(item)) return false;
+
+    // Wake up the daemon once the interrupt returns
+    ready_.giveFromInterrupt();
+
+    return true;
+}
+
+/**
+ * Returns the number of work items that the daemon has run.
+ */
+uint32_t WorkQueue::getExecuted(void)
+{
+    return executed_;
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+WorkQueue::WorkQueue():
+    pending_(nullptr), started_(false), ready_(false), executed_(0)
+{
+}
+
+/**
+ * Adds the item to the pending list. Returns false if it already is.
+ */
+bool WorkQueue::push(WorkItem* item)
+{
+    WorkItem* head;
+    bool idle = false;
+
+    // Mark the item as pending, unless it already is
+    if (!item->pending_.compare_exchange_strong(idle, true)) return false;
+
+    // Push the item onto the pending list
+    head = pending_.load();
+    do
+    {
+        item->next_ = head;
+    } while (!pending_.compare_exchange_weak(head, item));
+
+    return true;
+}
+
+void WorkQueue::daemon(void* parameters)
+{
+    WorkQueue* workQueue = static_cast<WorkQueue*>(parameters);
+
+    // Forever
+    while (true)
+    {
+        // Wait until there is work to do
+        workQueue->ready_.take();
+
+        // Run all the pending work
+        workQueue->run();
+    }
+}
+
+void WorkQueue::run(void)
+{
+    WorkItem* item;
+    WorkItem* next;
+    WorkItem* ordered = nullptr;
+
+    // Take all the pending items at once, newest first
+    item = pending_.exchange(nullptr);
+
+    // Reverse the list to run the items in the order they were scheduled
+    while (item != nullptr)
+    {
+        next = item->next_;
+        item->next_ = ordered;
+        ordered = item;
+        item = next;
+    }
+
+    while (ordered != nullptr)
+    {
+        item = ordered;
+        ordered = item->next_;
+
+        // Clear the item first, so that an interrupt may schedule it again
+        item->pending_ = false;
+        item->callback_.execute();
+
+        executed_++;
+    }
+}
+
@@ -0,0 +1,103 @@
+/**
+ * @file       WorkQueue.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Deferred execution of interrupt callbacks in a daemon task.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef WORK_QUEUE_H_
+#define WORK_QUEUE_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <new>
+
+#include "Callback.h"
+#include "Semaphore.h"
+
+/**
+ * Priority and stack depth (in words) of the daemon task that runs the
+ * deferred work. It should preempt every other task, so that deferred
+ * work only waits for interrupts.
+ */
+#ifndef WORK_QUEUE_PRIORITY
+#define WORK_QUEUE_PRIORITY                 ( configMAX_PRIORITIES - 1 )
+#endif
+
+#ifndef WORK_QUEUE_STACK
+#define WORK_QUEUE_STACK                    ( 128 )
+#endif
+
+class WorkQueue;
+
+/**
+ * Context in which a peripheral runs a callback: straight from its
+ * interrupt handler, or later from the work queue daemon task, where it
+ * may block and take as long as it needs without delaying other
+ * interrupts.
+ */
+enum CallbackContext : uint8_t
+{
+    CallbackContext_Interrupt = 0,
+    CallbackContext_Deferred  = 1
+};
+
+/**
+ * A callback that an interrupt handler hands over to the daemon task
+ * instead of running it. Scheduling an item that is already pending does
+ * nothing, so the callback runs once for any number of interrupts that
+ * happen before the daemon gets to it.
+ */
+class WorkItem
+{
+    friend class WorkQueue;
+public:
+    WorkItem();
+    void setCallback(Delegate callback);
+    Delegate bind(Delegate callback, CallbackContext context);
+    Delegate getTrigger(void);
+    bool schedule(void);
+    bool scheduleFromInterrupt(void);
+    bool isPending(void);
+private:
+    void trigger(void);
+private:
+    Delegate callback_;
+    std::atomic<bool> pending_;
+    WorkItem* next_;
+};
+
+/**
+ * Runs the pending work items, in the order they were scheduled, from a
+ * daemon task that is created when the first deferred callback is set.
+ * Interrupt handlers push items onto a lock-free list, which the daemon
+ * takes as a whole, so that scheduling never blocks nor masks interrupts.
+ */
+class WorkQueue
+{
+public:
+    static WorkQueue& getInstance(void);
+    void start(void);
+    bool schedule(WorkItem* item);
+    bool scheduleFromInterrupt(WorkItem* item);
+    uint32_t getExecuted(void);
+private:
+    WorkQueue();
+    bool push(WorkItem* item);
+    static void daemon(void* parameters);
+    void run(void);
+private:
+    static WorkQueue* instance_;
+
+    std::atomic<WorkItem*> pending_;
+    std::atomic<bool> started_;
+    SemaphoreBinary ready_;
+    std::atomic<uint32_t> executed_;
+};
+
+#endif /* WORK_QUEUE_H_ */
@@ -0,0 +1,240 @@
+/**
+ * @file       Dma.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include "Dma.h"
+
+#include <string.h>
+
+#include "cc2538_include.h"
+
+/*================================ define ===================================*/
+
+#define DMA_CHANNELS            ( 32 )
+#define DMA_MAX_LENGTH          ( 1024 )
+
+// The alternate structures start after the primary ones of all the channels
+#define DMA_TABLE_LENGTH        ( DMA_CHANNELS + DMA_CHANNEL_MAX + 1 )
+
+/*================================ typedef ==================================*/
+
+/*=============================== variables =================================*/
+
+Dma Dma::instance_;
+
+// Primary and alternate control structures, the table must be 1024-byte aligned,
+// which its own section at the start of SRAM does without padding
+static tDMAControlTable controlTable[DMA_TABLE_LENGTH] __attribute__ ((section(".udma"), aligned(1024)));
+
+/*=============================== prototypes ================================*/
+
+/*================================= public ==================================*/
+
+Dma& Dma::getInstance(void)
+{
+    // Returns the only instance of the Dma
+    return instance_;
+}
+
+void Dma::enable(void)
+{
+    // The controller is shared, only enable it once
+    if (enabled_) return;
+
+    // The table is not cleared at startup, as it is left out of the bss
+    memset(controlTable, 0, sizeof(controlTable));
+
+    // Enable the uDMA controller
+    uDMAEnable();
+
+    // Set the base address of the channel control table
+    uDMAControlBaseSet(controlTable);
+
+    enabled_ = true;
+}
+
+/**
+ * Assigns the channel to its peripheral and sets the control word of its
+ * primary and alternate structures (data size, address increments and
+ * arbitration size), e.g. UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE
+ * | UDMA_ARB_1.
+ */
+void Dma::configure(uint32_t mapping, uint32_t control)
+{
+    uint32_t channel = mapping & 0xFF;
+
+    // Check that the channel has control structures
+    if (channel > DMA_CHANNEL_MAX) return;
+
+    // Route the peripheral requests to the channel
+    uDMAChannelAssign(mapping);
+
+    // Use single and burst requests, primary structure and default priority
+    uDMAChannelAttributeDisable(channel, UDMA_ATTR_ALL);
+
+    // Set the control word of the primary and alternate structures
+    uDMAChannelControlSet(channel | UDMA_PRI_SELECT, control);
+    uDMAChannelControlSet(channel | UDMA_ALT_SELECT, control);
+}
+
+/**
+ * Starts a basic transfer of length items from source to destination. The
+ * addresses are advanced as set by configure(). Returns false if the
+ * channel is still busy or the length does not fit in one transfer.
+ */
+bool Dma::transfer(uint32_t mapping, void* source, void* destination, uint32_t length)
+{
+    uint32_t channel = mapping & 0xFF;
+
+    // Check that the channel has control structures and the transfer length
+    if (channel > DMA_CHANNEL_MAX) return false;
+    if (length == 0 || length > DMA_MAX_LENGTH) return false;
+
+    // Check that the previous transfer has finished
+    if (isBusy(mapping)) return false;
+
+    // Set the source and destination end addresses and the transfer size
+    uDMAChannelTransferSet(channel | UDMA_PRI_SELECT, UDMA_MODE_BASIC, source, destination, length);
+
+    // Enable the channel, the peripheral requests drive the transfer
+    uDMAChannelEnable(channel);
+
+    return true;
+}
+
+/**
+ * Starts a ping-pong transfer of length items to ping, then to pong, and
+ * so on as long as the stopped structure is reloaded in time. Returns
+ * false if the channel is still busy or the length does not fit in one
+ * transfer.
+ */
+bool Dma::transferPingPong(uint32_t mapping, void* source, void* ping, void* pong, uint32_t length)
+{
+    uint32_t channel = mapping & 0xFF;
+
+    // Check that the channel has control structures and the transfer length
+    if (channel > DMA_CHANNEL_MAX) return false;
+    if (length == 0 || length > DMA_MAX_LENGTH) return false;
+
+    // Check that the previous transfer has finished
+    if (isBusy(mapping)) return false;
+
+    // Start with the primary structure
+    uDMAChannelAttributeDisable(channel, UDMA_ATTR_ALTSELECT);
+
+    // Set up both halves of the transfer
+    uDMAChannelTransferSet(channel | UDMA_PRI_SELECT, UDMA_MODE_PINGPONG, source, ping, length);
+    uDMAChannelTransferSet(channel | UDMA_ALT_SELECT, UDMA_MODE_PINGPONG, source, pong, length);
+
+    // Enable the channel, the peripheral requests drive the transfer
+    uDMAChannelEnable(channel);
+
+    return true;
+}
+
+/**
+ * Sets a stopped structure of a ping-pong transfer up again. The channel
+ * is enabled again in case the controller ran out of structures, in which
+ * case it carries on with the structure it would have used next.
+ */
+void Dma::reload(uint32_t mapping, bool alternate, void* source, void* destination, uint32_t length)
+{
+    uint32_t channel = mapping & 0xFF;
+    uint32_t select = alternate ? UDMA_ALT_SELECT : UDMA_PRI_SELECT;
+
+    // Set up the structure again
+    uDMAChannelTransferSet(channel | select, UDMA_MODE_PINGPONG, source, destination, length);
+
+    // Make sure that the channel is enabled
+    uDMAChannelEnable(channel);
+}
+
+/**
+ * Starts a transfer of length items from source to destination that is
+ * driven by a software request instead of by the peripheral, with the
+ * given control word, e.g. to move a buffer to or from a data register
+ * that does not request transfers by itself. The transfer runs in auto
+ * mode, so the single request moves all the items. Returns false if the
+ * channel is still busy or the length does not fit in one transfer.
+ */
+bool Dma::request(uint32_t mapping, uint32_t control, void* source, void* destination, uint32_t length)
+{
+    uint32_t channel = mapping & 0xFF;
+
+    // Check that the channel has control structures and the transfer length
+    if (channel > DMA_CHANNEL_MAX) return false;
+    if (length == 0 || length > DMA_MAX_LENGTH) return false;
+
+    // Check that the previous transfer has finished
+    if (isBusy(mapping)) return false;
+
+    // Set the control word of the primary structure, as it may change
+    uDMAChannelControlSet(channel | UDMA_PRI_SELECT, control);
+
+    // Set the source and destination end addresses and the transfer size
+    uDMAChannelTransferSet(channel | UDMA_PRI_SELECT, UDMA_MODE_AUTO, source, destination, length);
+
+    // Enable the channel and request the transfer
+    uDMAChannelEnable(channel);
+    uDMAChannelRequest(channel);
+
+    return true;
+}
+
+bool Dma::isStopped(uint32_t mapping, bool alternate)
+{
+    uint32_t select = alternate ? UDMA_ALT_SELECT : UDMA_PRI_SELECT;
+
+    // The controller stops a structure once it has moved all its items
+    return (uDMAChannelModeGet((mapping & 0xFF) | select) == UDMA_MODE_STOP);
+}
+
+uint32_t Dma::getRemaining(uint32_t mapping, bool alternate)
+{
+    uint32_t select = alternate ? UDMA_ALT_SELECT : UDMA_PRI_SELECT;
+
+    // Items that the structure has still to move
+    return uDMAChannelSizeGet((mapping & 0xFF) | select);
+}
+
+bool Dma::isBusy(uint32_t mapping)
+{
+    // The channel is disabled by the controller once the transfer is done
+    return uDMAChannelIsEnabled(mapping & 0xFF);
+}
+
+/**
+ * Returns true, and acknowledges it, if the channel has completed a
+ * transfer. Only the bit of this channel is cleared, as the others belong
+ * to other peripherals.
+ */
+bool Dma::isDone(uint32_t mapping)
+{
+    uint32_t mask = 1 << (mapping & 0xFF);
+
+    // Check the channel completion status
+    if ((uDMAIntStatus() & mask) == 0) return false;
+
+    // Clear the channel completion status
+    uDMAIntClear(mask);
+
+    return true;
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+Dma::Dma():
+    enabled_(false)
+{
+}
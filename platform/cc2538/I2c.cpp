@@ -14,6 +14,7 @@
 #include "Board.h"
 #include "Gpio.h"
 #include "I2c.h"
+#include "Trace.h"
 
 #include "cc2538_include.h"
 #include "platform_types.h"
@@ -29,6 +30,9 @@ extern Board board;
 const uint32_t I2C_MAX_DELAY_US    = 100000;
 const uint32_t I2C_MAX_DELAY_TICKS = I2C_MAX_DELAY_US / Board::BOARD_TICKS_PER_US;
 
+// Marks the trace argument of the read operations
+const uint16_t I2C_TRACE_READ      = 0x8000;
+
 /*=============================== prototypes ================================*/
 
 /*================================= public ==================================*/
@@ -118,6 +122,8 @@ bool I2c::readByte(uint8_t address, uint8_t* buffer)
 {
     uint32_t delayTicks = I2C_MAX_DELAY_TICKS;
 
+    TRACE_EVENT(TraceEvent_I2cStart, address, I2C_TRACE_READ | 1);
+
     // Read operation
     I2CMasterSlaveAddrSet(address, true);
 
@@ -131,12 +137,18 @@ bool I2c::readByte(uint8_t address, uint8_t* buffer)
     while (I2CMasterBusy())
     {
         // Check timeout status and return if expired
-        if (board.isExpiredTicks(delayTicks)) return false;
+        if (board.isExpiredTicks(delayTicks))
+        {
+            TRACE_EVENT(TraceEvent_I2cTimeout, address, 0);
+            return false;
+        }
     }
 
     // Read data from I2C
     *buffer = I2CMasterDataGet();
 
+    TRACE_EVENT(TraceEvent_I2cDone, address, 0);
+
     return true;
 }
 
@@ -144,6 +156,8 @@ bool I2c::readByte(uint8_t address, uint8_t* buffer, uint8_t size)
 {
     uint32_t delayTicks = I2C_MAX_DELAY_TICKS;
 
+    TRACE_EVENT(TraceEvent_I2cStart, address, I2C_TRACE_READ | size);
+
     // Read operation
     I2CMasterSlaveAddrSet(address, true);
 
@@ -160,7 +174,11 @@ bool I2c::readByte(uint8_t address, uint8_t* buffer, uint8_t size)
         while (I2CMasterBusy())
         {
             // Check timeout status and return if expired
-            if (board.isExpiredTicks(delayTicks)) return false;
+            if (board.isExpiredTicks(delayTicks))
+            {
+                TRACE_EVENT(TraceEvent_I2cTimeout, address, 0);
+                return false;
+            }
         }
 
         // Read data from I2C
@@ -172,6 +190,8 @@ bool I2c::readByte(uint8_t address, uint8_t* buffer, uint8_t size)
         else           I2CMasterControl(I2C_MASTER_CMD_BURST_RECEIVE_CONT);
     }
 
+    TRACE_EVENT(TraceEvent_I2cDone, address, 0);
+
     return true;
 }
 
@@ -179,6 +199,8 @@ bool I2c::writeByte(uint8_t address, uint8_t byte)
 {
     uint32_t delayTicks = I2C_MAX_DELAY_TICKS;
 
+    TRACE_EVENT(TraceEvent_I2cStart, address, 1);
+
     // Write operation
     I2CMasterSlaveAddrSet(address, false);
 
@@ -195,9 +217,15 @@ bool I2c::writeByte(uint8_t address, uint8_t byte)
     while (I2CMasterBusy())
     {
         // Check timeout status and return if expired
-        if (board.isExpiredTicks(delayTicks)) return false;
+        if (board.isExpiredTicks(delayTicks))
+        {
+            TRACE_EVENT(TraceEvent_I2cTimeout, address, 0);
+            return false;
+        }
     }
 
+    TRACE_EVENT(TraceEvent_I2cDone, address, 0);
+
     return true;
 }
 
@@ -205,6 +233,8 @@ bool I2c::writeByte(uint8_t address, uint8_t* buffer, uint8_t size)
 {
     uint32_t delayTicks = I2C_MAX_DELAY_TICKS;
 
+    TRACE_EVENT(TraceEvent_I2cStart, address, size);
+
     // Write operation
     I2CMasterSlaveAddrSet(address, false);
 
@@ -222,7 +252,11 @@ bool I2c::writeByte(uint8_t address, uint8_t* buffer, uint8_t size)
     while (I2CMasterBusy())
     {
         // Check timeout status and return if expired
-        if (board.isExpiredTicks(delayTicks)) return false;
+        if (board.isExpiredTicks(delayTicks))
+        {
+            TRACE_EVENT(TraceEvent_I2cTimeout, address, 0);
+            return false;
+        }
     }
 
     while (size)
@@ -239,10 +273,16 @@ bool I2c::writeByte(uint8_t address, uint8_t* buffer, uint8_t size)
         while (I2CMasterBusy())
         {
             // Check timeout status and return if expired
-            if (board.isExpiredTicks(delayTicks)) return false;
+            if (board.isExpiredTicks(delayTicks))
+            {
+                TRACE_EVENT(TraceEvent_I2cTimeout, address, 0);
+                return false;
+            }
         }
     }
 
+    TRACE_EVENT(TraceEvent_I2cDone, address, 0);
+
     return true;
 }
 
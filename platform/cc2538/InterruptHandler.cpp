@@ -24,6 +24,8 @@
 #include "RadioTimer.h"
 #include "SysTick.h"
 
+#include "Trace.h"
+
 #include "cc2538_include.h"
 #include "platform_types.h"
 
@@ -468,6 +470,12 @@ InterruptHandler::InterruptHandler()
     IntRegister(INT_RFCORERTX, RFCore_InterruptHandler);
     IntRegister(INT_RFCOREERR, RFError_InterruptHandler);
 
+    // Register the interrupt that the RF CORE handlers pend to call the kernel
+    IntRegister(RADIO_DEFERRED_INTERRUPT, RFDeferred_InterruptHandler);
+
+    // Register the uDMA interrupt handler, software transfers complete there
+    IntRegister(INT_UDMA, UDMA_InterruptHandler);
+
     // Register the SleepTimer interrupt handler
     // SleepModeIntRegister(SleepTimer_InterruptHandler);
 
@@ -811,20 +819,32 @@ inline void InterruptHandler::TIMER3_InterruptHandler(void)
 
 inline void InterruptHandler::UART0_InterruptHandler(void)
 {
+    TRACE_EVENT(TraceEvent_IsrEnter, INT_UART0, 0);
+
     // Call the UART interrupt handler
     UART0_interruptVector_->interruptHandler();
+
+    TRACE_EVENT(TraceEvent_IsrExit, INT_UART0, 0);
 }
 
 inline void InterruptHandler::UART1_InterruptHandler(void)
 {
+    TRACE_EVENT(TraceEvent_IsrEnter, INT_UART1, 0);
+
     // Call the UART interrupt handler
     UART1_interruptVector_->interruptHandler();
+
+    TRACE_EVENT(TraceEvent_IsrExit, INT_UART1, 0);
 }
 
 inline void InterruptHandler::I2C_InterruptHandler(void)
 {
+    TRACE_EVENT(TraceEvent_IsrEnter, INT_I2C0, 0);
+
     // Call the I2C interrupt handler
     I2C_interruptVector_->interruptHandler();
+
+    TRACE_EVENT(TraceEvent_IsrExit, INT_I2C0, 0);
 }
 
 inline void InterruptHandler::SPI0_InterruptHandler(void)
@@ -847,14 +867,42 @@ inline void InterruptHandler::SysTick_InterruptHandler(void)
 
 inline void InterruptHandler::RFCore_InterruptHandler(void)
 {
+    TRACE_EVENT(TraceEvent_IsrEnter, INT_RFCORERTX, 0);
+
     // Call the RF CORE interrupt handler
     Radio_interruptVector_->interruptHandler();
+
+    TRACE_EVENT(TraceEvent_IsrExit, INT_RFCORERTX, 0);
 }
 
 inline void InterruptHandler::RFError_InterruptHandler(void)
 {
+    TRACE_EVENT(TraceEvent_IsrEnter, INT_RFCOREERR, 0);
+
     // Call the RF ERROR interrupt handler
     Radio_interruptVector_->errorHandler();
+
+    TRACE_EVENT(TraceEvent_IsrExit, INT_RFCOREERR, 0);
+}
+
+inline void InterruptHandler::RFDeferred_InterruptHandler(void)
+{
+    TRACE_EVENT(TraceEvent_IsrEnter, RADIO_DEFERRED_INTERRUPT, 0);
+
+    // Call the RF CORE deferred handler
+    Radio_interruptVector_->deferredHandler();
+
+    TRACE_EVENT(TraceEvent_IsrExit, RADIO_DEFERRED_INTERRUPT, 0);
+}
+
+inline void InterruptHandler::UDMA_InterruptHandler(void)
+{
+    TRACE_EVENT(TraceEvent_IsrEnter, INT_UDMA, 0);
+
+    // Call the radio uDMA interrupt handler, the only software transfers
+    Radio_interruptVector_->dmaHandler();
+
+    TRACE_EVENT(TraceEvent_IsrExit, INT_UDMA, 0);
 }
 
 inline void InterruptHandler::SleepTimer_InterruptHandler(void)
@@ -11,26 +11,91 @@
 
 /*================================ include ==================================*/
 
+#include <string.h>
+
 #include "Radio.h"
+#include "CriticalSection.h"
+#include "Dma.h"
 #include "InterruptHandler.h"
+#include "Trace.h"
 
 #include "cc2538_include.h"
 #include "cc2538_defines.h"
 
 /*================================ define ===================================*/
 
+/**
+ * Channel that moves the frames between the RF FIFOs and memory, see
+ * enableDma. The software channel completes on the uDMA vector, which
+ * the radio owns.
+ */
+#ifndef RADIO_DMA_CHANNEL
+#define RADIO_DMA_CHANNEL                   ( UDMA_CH30_SW )
+#endif
+
+#define RADIO_DMA_RX_CONTROL                ( UDMA_SIZE_8 | UDMA_SRC_INC_NONE | UDMA_DST_INC_8 | UDMA_ARB_1 )
+#define RADIO_DMA_TX_CONTROL                ( UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_1 )
+
+/* Unit backoff period of 20 symbols, i.e. 320 us, in 32 MHz MAC timer ticks */
+#define RADIO_CSMA_BACKOFF_TICKS            ( 10240 )
+
+/* MAC timer multiplex selection of the period register */
+#define RADIO_MTMSEL_TIMER                  ( 0x00 )
+#define RADIO_MTMSEL_PERIOD                 ( 0x02 )
+
+/* Events that the interrupt handlers leave to the deferred handler */
+#define RADIO_EVENT_RX_INIT                 ( 1 << 0 )
+#define RADIO_EVENT_RX_DONE                 ( 1 << 1 )
+#define RADIO_EVENT_TX_INIT                 ( 1 << 2 )
+#define RADIO_EVENT_TX_DONE                 ( 1 << 3 )
+#define RADIO_EVENT_CSMA_DONE               ( 1 << 4 )
+
+/* Units of the source match table, the even ones start a pair */
+#define RADIO_SOURCE_MASK(units)            ( (1UL << (units)) - 1 )
+#define RADIO_SOURCE_EVEN                   ( 0x555555UL )
+#define RADIO_SOURCE_ODD                    ( 0xAAAAAAUL )
+
 /*================================ typedef ==================================*/
 
 /*=============================== variables =================================*/
 
+/**
+ * Unslotted CSMA-CA as a CSP program. Y holds the backoff exponent and Z
+ * the attempts left. Each attempt waits X random backoff periods, i.e. MAC
+ * timer overflows, and samples the CCA. A busy channel uses up an attempt
+ * and raises the exponent, a clear one starts transmitting with STXONCCA.
+ */
+static const uint8_t csmaProgram[] =
+{
+    CC2538_RF_CSP_OP_LABEL,
+    CC2538_RF_CSP_OP_RANDXY,
+    CC2538_RF_CSP_OP_WAITX,
+    CC2538_RF_CSP_OP_SKIP(3, CC2538_RF_CSP_CC_CCA),
+    CC2538_RF_CSP_OP_DECZ,
+    CC2538_RF_CSP_OP_INCMAXY(RADIO_CSMA_MAX_BE),
+    CC2538_RF_CSP_OP_RPT(CC2538_RF_CSP_CC_NOT | CC2538_RF_CSP_CC_Z_ZERO),
+    CC2538_RF_CSP_OP_SKIP(1, CC2538_RF_CSP_CC_Z_ZERO),
+    CC2538_RF_CSP_OP_STXONCCA,
+    CC2538_RF_CSP_OP_STOP
+};
+
 /*=============================== prototypes ================================*/
 
 /*================================= public ==================================*/
 
 Radio::Radio():
     radioState_(RadioState_Off), \
-    rxInit_(nullptr), rxDone_(nullptr), \
-    txInit_(nullptr), txDone_(nullptr)
+    rxInit_(), rxDone_(), \
+    txInit_(), txDone_(), \
+    events_(0), rxReady_(rxReadyBuffer_, sizeof(rxReadyBuffer_)), \
+    rxMode_(RadioRxMode_Single), \
+    rxPool_(nullptr), rxQueue_(nullptr), \
+    rxStats_(), \
+    filter_(0), panId_(0xFFFF), shortAddress_(0xFFFE), extendedAddress_(), \
+    sourceUsed_(0), sourceExtended_(0), sourcePending_(0), \
+    sourceTable_(nullptr), sourceUnits_(0), \
+    csma_(false), csmaDone_(false), txStats_(), \
+    dmaChannel_(0), rxDmaBuffer_(nullptr), rxDmaLength_(0)
 {
 }
 
@@ -80,11 +145,11 @@ void Radio::enable(void)
     /* Enable automatic CRC calculation and RSSI append */
     HWREG(RFCORE_XREG_FRMCTRL0)    = RFCORE_XREG_FRMCTRL0_AUTOCRC;
 
-    /* Disable frame filtering */
-    HWREG(RFCORE_XREG_FRMFILT0)   &= ~RFCORE_XREG_FRMFILT0_FRAME_FILTER_EN;
+    /* Restore the addresses and the frame filtering, off by default */
+    applyFilter();
 
-    /* Disable source address matching and autopend */
-    HWREG(RFCORE_XREG_SRCMATCH)    = 0;
+    /* Restore the source match table */
+    applySourceTable();
 
     /* Set maximum FIFOP threshold */
     HWREG(RFCORE_XREG_FIFOPCTRL)   = CC2538_RF_MAX_PACKET_LEN;
@@ -132,6 +197,24 @@ void Radio::off(void)
         /* Turn off the radio */
         CC2538_RF_CSP_ISRFOFF();
 
+        if (rxMode_ == RadioRxMode_Continuous)
+        {
+            /* Keep the interrupt handler, which TXDONE also enters, from
+               draining the FIFO as well, as the queue takes one producer */
+            CriticalSection section(RADIO_INTERRUPT_PRIORITY);
+
+            /* Queue the complete frames, only a partial one is flushed */
+            if (drainRxFifo() > 0)
+            {
+                /* Have the deferred handler send them to the queue */
+                defer(0);
+            }
+            if (HWREG(RFCORE_XREG_RXFIFOCNT) > 0)
+            {
+                CC2538_RF_CSP_ISFLUSHRX();
+            }
+        }
+
         /* Clear FIFO interrupt flags */
         HWREG(RFCORE_SFR_RFIRQF0) = ~(RFCORE_SFR_RFIRQF0_FIFOP|RFCORE_SFR_RFIRQF0_RXPKTDONE);
     }
@@ -157,18 +240,18 @@ void Radio::reset(void)
     }
 }
 
-void Radio::setRxCallbacks(Callback* rxInit, Callback* rxDone)
+void Radio::setRxCallbacks(Delegate rxInit, Delegate rxDone, CallbackContext context)
 {
-    /* Store the receive init and done callbacks */
-    rxInit_ = rxInit;
-    rxDone_ = rxDone;
+    /* Store the receive init and done callbacks, deferred if requested */
+    rxInit_ = rxInitWork_.bind(rxInit, context);
+    rxDone_ = rxDoneWork_.bind(rxDone, context);
 }
 
-void Radio::setTxCallbacks(Callback* txInit, Callback* txDone)
+void Radio::setTxCallbacks(Delegate txInit, Delegate txDone, CallbackContext context)
 {
-    /* Store the transmit init and done callbacks */
-    txInit_ = txInit;
-    txDone_ = txDone;
+    /* Store the transmit init and done callbacks, deferred if requested */
+    txInit_ = txInitWork_.bind(txInit, context);
+    txDone_ = txDoneWork_.bind(txDone, context);
 }
 
 void Radio::enableInterrupts(void)
@@ -179,19 +262,24 @@ void Radio::enableInterrupts(void)
     /* Enable RF interrupts 0, RXPKTDONE, SFD and FIFOP only -- see page 751  */
     HWREG(RFCORE_XREG_RFIRQM0) |= ((0x06 | 0x02 | 0x01) << RFCORE_XREG_RFIRQM0_RFIRQM_S) & RFCORE_XREG_RFIRQM0_RFIRQM_M;
 
-    /* Enable RF interrupts 1, TXDONE only */
-    HWREG(RFCORE_XREG_RFIRQM1) |= ((0x02) << RFCORE_XREG_RFIRQM1_RFIRQM_S) & RFCORE_XREG_RFIRQM1_RFIRQM_M;
+    /* With frame filtering, receiving starts at FRAME_ACCEPTED instead */
+    applyFilter();
+
+    /* Enable RF interrupts 1, TXDONE and CSP_STOP, the end of the CSMA-CA program */
+    HWREG(RFCORE_XREG_RFIRQM1) |= (RFCORE_SFR_RFIRQF1_TXDONE | RFCORE_SFR_RFIRQF1_CSP_STOP) & RFCORE_XREG_RFIRQM1_RFIRQM_M;
 
     /* Enable RF error interrupts */
     HWREG(RFCORE_XREG_RFERRM) = RFCORE_XREG_RFERRM_RFERRM_M;
 
-    // Set the UART interrupt priority
-    IntPrioritySet(INT_RFCORERTX, (7 << 5));
-    // IntPrioritySet(INT_RFCOREERR, (7 << 5));
+    /* Set the radio interrupt priorities, the handlers run above the kernel */
+    IntPrioritySet(INT_RFCORERTX, RADIO_INTERRUPT_PRIORITY);
+    IntPrioritySet(INT_RFCOREERR, RADIO_INTERRUPT_PRIORITY);
+    IntPrioritySet(RADIO_DEFERRED_INTERRUPT, RADIO_DEFERRED_PRIORITY);
 
     /* Enable radio interrupts */
     IntEnable(INT_RFCORERTX);
-    // IntEnable(INT_RFCOREERR);
+    IntEnable(INT_RFCOREERR);
+    IntEnable(RADIO_DEFERRED_INTERRUPT);
 }
 
 void Radio::disableInterrupts(void)
@@ -199,12 +287,13 @@ void Radio::disableInterrupts(void)
     /* Disable RF interrupts 0, RXPKTDONE, SFD and FIFOP only -- see page 751  */
     HWREG(RFCORE_XREG_RFIRQM0) = 0;
 
-    /* Disable RF interrupts 1, TXDONE only */
+    /* Disable RF interrupts 1, TXDONE and CSP_STOP */
     HWREG(RFCORE_XREG_RFIRQM1) = 0;
 
     /* Disable the radio interrupts */
     IntDisable(INT_RFCORERTX);
-    // IntDisable(INT_RFCOREERR);
+    IntDisable(INT_RFCOREERR);
+    IntDisable(RADIO_DEFERRED_INTERRUPT);
 }
 
 void Radio::setChannel(uint8_t channel)
@@ -224,27 +313,77 @@ void Radio::setPower(uint8_t power)
     HWREG(RFCORE_XREG_TXPOWER) = power;
 }
 
-void Radio::transmit(void)
+/**
+ * Starts transmitting the loaded frame. With CSMA-CA, see enableCsma, it
+ * blocks the calling task while backing off, and returns RadioResult_Busy
+ * if the channel stayed busy, or RadioResult_Error if the receiver is off,
+ * and the frame is left in the TX FIFO to transmit again.
+ */
+RadioResult Radio::transmit(void)
 {
+    RadioResult result;
+
     /* Make sure we are not transmitting already */
     while(HWREG(RFCORE_XREG_FSMSTAT1) & RFCORE_XREG_FSMSTAT1_TX_ACTIVE)
         ;
 
-    /* Set the radio state to transmit */
-    radioState_ = RadioState_TransmitInit;
+    /* Make sure the uDMA has loaded the payload */
+    while (dmaChannel_ != 0 && Dma::getInstance().isBusy(dmaChannel_))
+        ;
+
+    {
+        /* The interrupt handler also updates the state and the mask */
+        CriticalSection section(RADIO_INTERRUPT_PRIORITY);
+
+        /* Set the radio state to transmit */
+        radioState_ = RadioState_TransmitInit;
+
+        /* With frame filtering SFD is only unmasked while transmitting */
+        if (filter_ != 0 && HWREG(RFCORE_XREG_RFIRQM0) != 0)
+        {
+            HWREG(RFCORE_XREG_RFIRQM0) |= RFCORE_SFR_RFIRQF0_SFD;
+        }
+    }
+
+    if (!csma_)
+    {
+        /* Enable transmit mode */
+        CC2538_RF_CSP_ISTXON();
+    }
+    else if ((result = transmitCsma()) != RadioResult_Success)
+    {
+        CriticalSection section(RADIO_INTERRUPT_PRIORITY);
+
+        /* Give up, nothing is transmitted */
+        radioState_ = RadioState_Idle;
+        txStats_.failures++;
+
+        /* With frame filtering SFD is masked again */
+        if (filter_ != 0)
+        {
+            HWREG(RFCORE_XREG_RFIRQM0) &= ~RFCORE_SFR_RFIRQF0_SFD;
+        }
 
-    /* Enable transmit mode */
-    CC2538_RF_CSP_ISTXON();
+        return result;
+    }
 
     /* Busy-wait until radio really transmitting */
     while(!((HWREG(RFCORE_XREG_FSMSTAT1) & RFCORE_XREG_FSMSTAT1_TX_ACTIVE)))
         ;
+
+    txStats_.frames++;
+
+    return RadioResult_Success;
 }
 
 void Radio::receive(void)
 {
-    /* Flush the RX buffer */
-    CC2538_RF_CSP_ISFLUSHRX();
+    /* In continuous mode the FIFO only holds frames that are still unread */
+    if (rxMode_ == RadioRxMode_Single)
+    {
+        /* Flush the RX buffer */
+        CC2538_RF_CSP_ISFLUSHRX();
+    }
 
     /* Set the radio state to receive */
     radioState_ = RadioState_ReceiveInit;
@@ -257,6 +396,313 @@ void Radio::receive(void)
         ;
 }
 
+void Radio::setPanId(uint16_t panId)
+{
+    panId_ = panId;
+    applyFilter();
+}
+
+void Radio::setShortAddress(uint16_t address)
+{
+    shortAddress_ = address;
+    applyFilter();
+}
+
+/**
+ * Sets the IEEE EUI-64 of the radio, given as it goes over the air, i.e.
+ * least significant byte first.
+ */
+void Radio::setExtendedAddress(const uint8_t* address)
+{
+    memcpy(extendedAddress_, address, sizeof(extendedAddress_));
+    applyFilter();
+}
+
+/**
+ * Enables the hardware frame filter with a combination of RadioFilter
+ * options, e.g. RadioFilter_Data | RadioFilter_Ack | RadioFilter_AutoAck.
+ * The radio then drops the frames of the selected types that are not for
+ * its PAN ID and addresses, and all the frames of the other types, before
+ * they take room in the RX FIFO or raise an interrupt. With AutoAck the
+ * radio acknowledges the accepted frames that request it by itself, and
+ * with AutoPend it sets their frame pending bit from the source match
+ * table, see addSource. Like setChannel, it takes the radio enabled.
+ */
+void Radio::enableFilter(uint32_t filter)
+{
+    filter_ = filter & (RadioFilter_AllFrames | RadioFilter_AutoAck |
+                        RadioFilter_PanCoordinator | RadioFilter_AutoPend);
+
+    /* Without any frame type the radio would not receive at all */
+    if ((filter_ & RadioFilter_AllFrames) == 0)
+    {
+        filter_ |= RadioFilter_AllFrames;
+    }
+
+    applyFilter();
+}
+
+/**
+ * Disables the frame filter and the automatic ACKs, so that the radio
+ * receives every frame on the channel, e.g. to sniff it. This is the mode
+ * after enable.
+ */
+void Radio::setPromiscuous(void)
+{
+    filter_ = 0;
+    applyFilter();
+}
+
+bool Radio::isPromiscuous(void)
+{
+    return (filter_ == 0);
+}
+
+/**
+ * Gives the radio the memory for its copy of the source match table, which
+ * restores the table after a sleep, with 4 bytes per unit up to
+ * RADIO_SOURCE_UNITS. Only the units that fit are used, and without a table
+ * addSource always fails. It should be set before the first entry is added.
+ */
+void Radio::setSourceTable(uint8_t* table, uint32_t length)
+{
+    sourceTable_ = table;
+    sourceUnits_ = (length / 4 < RADIO_SOURCE_UNITS) ? length / 4 : RADIO_SOURCE_UNITS;
+}
+
+/**
+ * Adds a short address to the source match table and returns its entry, or
+ * -1 if the table is full. With RadioFilter_AutoPend the radio sets the
+ * frame pending bit of the ACKs to the data requests of the entries that
+ * are pending, with no help from the CPU. The entry takes a unit next to
+ * another short entry if it can, to keep pairs free for extended entries.
+ */
+int32_t Radio::addSource(uint16_t panId, uint16_t address, bool pending)
+{
+    uint32_t free = ~sourceUsed_ & RADIO_SOURCE_MASK(sourceUnits_);
+    uint32_t paired;
+    int32_t entry;
+
+    /* Check if there is a free unit */
+    if (free == 0)
+    {
+        return -1;
+    }
+
+    /* Prefer the free units whose pair is already taken */
+    paired = free & (((sourceUsed_ >> 1) & RADIO_SOURCE_EVEN) | ((sourceUsed_ << 1) & RADIO_SOURCE_ODD));
+    entry = __builtin_ctz((paired != 0) ? paired : free);
+
+    /* The PAN ID and the address, least significant byte first */
+    sourceTable_[4 * entry + 0] = (panId >> 0) & 0xFF;
+    sourceTable_[4 * entry + 1] = (panId >> 8) & 0xFF;
+    sourceTable_[4 * entry + 2] = (address >> 0) & 0xFF;
+    sourceTable_[4 * entry + 3] = (address >> 8) & 0xFF;
+
+    /* Write the entry before it is enabled */
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        HWREG(FRMF_SRCM_RAM_BASE + 4 * (4 * entry + i)) = sourceTable_[4 * entry + i];
+    }
+
+    sourceUsed_ |= (1UL << entry);
+    if (pending) sourcePending_ |= (1UL << entry);
+    applySourceMasks();
+
+    return entry;
+}
+
+/**
+ * Adds an extended address, least significant byte first, to the source
+ * match table and returns its entry, or -1 if there is no free pair of
+ * units.
+ */
+int32_t Radio::addSource(const uint8_t* address, bool pending)
+{
+    uint32_t free = ~sourceUsed_ & RADIO_SOURCE_MASK(sourceUnits_);
+    uint32_t pairs;
+    int32_t entry;
+
+    /* Check if there is a free pair, starting at an even unit */
+    pairs = free & (free >> 1) & RADIO_SOURCE_EVEN;
+    if (pairs == 0)
+    {
+        return -1;
+    }
+
+    entry = __builtin_ctz(pairs);
+
+    /* Write the entry before it is enabled */
+    memcpy(&sourceTable_[4 * entry], address, 8);
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        HWREG(FRMF_SRCM_RAM_BASE + 4 * (4 * entry + i)) = sourceTable_[4 * entry + i];
+    }
+
+    sourceUsed_ |= (3UL << entry);
+    sourceExtended_ |= (1UL << entry);
+    if (pending) sourcePending_ |= (1UL << entry);
+    applySourceMasks();
+
+    return entry;
+}
+
+bool Radio::removeSource(int32_t entry)
+{
+    /* Check that the entry is in use */
+    if (!isSourceEntry(entry))
+    {
+        return false;
+    }
+
+    /* Free one unit, or both for an extended entry, and disable it */
+    sourceUsed_ &= ~(((sourceExtended_ & (1UL << entry)) ? 3UL : 1UL) << entry);
+    sourceExtended_ &= ~(1UL << entry);
+    sourcePending_ &= ~(1UL << entry);
+    applySourceMasks();
+
+    return true;
+}
+
+/**
+ * Sets whether the radio has frames pending for an entry, e.g. once a
+ * frame for a polling child is queued and once it has been sent.
+ */
+bool Radio::setSourcePending(int32_t entry, bool pending)
+{
+    /* Check that the entry is in use */
+    if (!isSourceEntry(entry))
+    {
+        return false;
+    }
+
+    if (pending)
+    {
+        sourcePending_ |= (1UL << entry);
+    }
+    else
+    {
+        sourcePending_ &= ~(1UL << entry);
+    }
+
+    applySourceMasks();
+
+    return true;
+}
+
+/**
+ * Makes the radio stay in receive and take every frame. By default the
+ * radio takes one frame at a time: getPacket reads it from the RX FIFO and
+ * flushes it, and the radio has to be turned off and on again before the
+ * next one. In continuous mode the interrupt handler moves each complete
+ * frame from the RX FIFO into a packet of the pool, the deferred handler
+ * sends the packet to the queue, and the task that receives it releases it. The packet holds
+ * the payload followed by the RSSI and CRC/LQI bytes, which getPacket takes
+ * off. It should be enabled with the radio off.
+ */
+void Radio::enableContinuous(PacketPool& pool, RadioRxQueue& queue)
+{
+    rxPool_ = &pool;
+    rxQueue_ = &queue;
+    rxMode_ = RadioRxMode_Continuous;
+}
+
+/**
+ * Goes back to taking one frame at a time. It should be called with the
+ * radio off.
+ */
+void Radio::disableContinuous(void)
+{
+    rxMode_ = RadioRxMode_Single;
+    rxPool_ = nullptr;
+    rxQueue_ = nullptr;
+}
+
+/**
+ * Returns the number of frames queued in continuous mode, dropped because
+ * no packet was free or the queue was full, lost to RX FIFO overflows and
+ * flushed because their length byte was not valid.
+ */
+void Radio::getRxStats(RadioRxStats& stats)
+{
+    /* Take a consistent copy, the interrupt handlers update it */
+    CriticalSection section(RADIO_INTERRUPT_PRIORITY);
+
+    stats = rxStats_;
+}
+
+/**
+ * Makes transmit follow the unslotted CSMA-CA of IEEE 802.15.4: before
+ * each attempt the CSP waits a random number of backoff periods, taken
+ * from the random generator of the radio, and transmits with STXONCCA, so
+ * that the radio only starts if the channel is clear. The backoff exponent
+ * grows with every busy CCA, and transmit gives up after
+ * RADIO_CSMA_MAX_BACKOFFS retries. The radio has to be on, as the CCA
+ * needs the receiver, otherwise transmit returns RadioResult_Error.
+ *
+ * The backoff periods are MAC timer overflows, so the radio has to be
+ * enabled first, and the MAC timer is not available to RadioTimer.
+ */
+void Radio::enableCsma(void)
+{
+    /* Overflow the MAC timer once every backoff period */
+    HWREG(RFCORE_SFR_MTMSEL) = RADIO_MTMSEL_PERIOD;
+    HWREG(RFCORE_SFR_MTM0)   = ((RADIO_CSMA_BACKOFF_TICKS >> 0) << RFCORE_SFR_MTM0_MTM0_S) & RFCORE_SFR_MTM0_MTM0_M;
+    HWREG(RFCORE_SFR_MTM1)   = ((RADIO_CSMA_BACKOFF_TICKS >> 8) << RFCORE_SFR_MTM1_MTM1_S) & RFCORE_SFR_MTM1_MTM1_M;
+    HWREG(RFCORE_SFR_MTMSEL) = RADIO_MTMSEL_TIMER;
+
+    /* Start the MAC timer and wait until it is running */
+    HWREG(RFCORE_SFR_MTCTRL) = (RFCORE_SFR_MTCTRL_RUN | RFCORE_SFR_MTCTRL_SYNC);
+    while (!(HWREG(RFCORE_SFR_MTCTRL) & RFCORE_SFR_MTCTRL_STATE))
+        ;
+
+    csma_ = true;
+}
+
+void Radio::disableCsma(void)
+{
+    csma_ = false;
+}
+
+void Radio::getTxStats(RadioTxStats& stats)
+{
+    stats = txStats_;
+}
+
+/**
+ * Moves the frames between the RF FIFOs and memory with the uDMA instead
+ * of a CPU loop over the RFDATA register. With a buffer, a received frame
+ * is moved to it once it is complete, and rxDone is called when the
+ * transfer finishes instead of at the end of the frame. Frames that do not
+ * fit in the buffer, which takes any with RADIO_DMA_BUFFER_LENGTH bytes,
+ * are dropped, and without a buffer only transmit uses the uDMA. The
+ * payload of a frame to transmit is moved to the TX FIFO while loadPacket
+ * returns, so the data has to stay untouched until transmit, which waits
+ * for it. This applies to the single receive mode, in continuous mode the
+ * interrupt handler keeps draining the RX FIFO itself.
+ */
+void Radio::enableDma(uint8_t* buffer, uint32_t length)
+{
+    Dma& dma = Dma::getInstance();
+
+    /* Keep the CPU loop if the project leaves the channel out of the table */
+    if ((RADIO_DMA_CHANNEL & 0xFF) > DMA_CHANNEL_MAX) return;
+
+    /* Transmit and receive share the channel, they never overlap */
+    dma.enable();
+    dma.configure(RADIO_DMA_CHANNEL, RADIO_DMA_RX_CONTROL);
+    dmaChannel_ = RADIO_DMA_CHANNEL;
+    rxDmaBuffer_ = buffer;
+    rxDmaLength_ = (buffer != nullptr) ? length : 0;
+
+    /* Register the uDMA interrupt handler */
+    InterruptHandler::getInstance().setInterruptHandler(this);
+
+    /* Enable the uDMA interrupt */
+    IntPrioritySet(INT_UDMA, (7 << 5));
+    IntEnable(INT_UDMA);
+}
+
 /**
  * When loading a packet to the RX buffer, the following is expected:
  * - *[1B]      Length (not required)
@@ -295,6 +741,19 @@ RadioResult Radio::loadPacket(uint8_t* data, uint8_t length)
     /* Append the PHY length to the TX buffer */
     HWREG(RFCORE_SFR_RFDATA) = packetLength;
 
+    /* Let the uDMA append the packet payload, transmit waits for it */
+    if (dmaChannel_ != 0)
+    {
+        if (!Dma::getInstance().request(dmaChannel_, RADIO_DMA_TX_CONTROL, data, (void *) RFCORE_SFR_RFDATA, length))
+        {
+            /* Return error */
+            return RadioResult_Error;
+        }
+
+        /* Return success */
+        return RadioResult_Success;
+    }
+
     /* Append the packet payload to the TX buffer */
     for (uint8_t i = 0; i < length; i++)
     {
@@ -319,6 +778,19 @@ RadioResult Radio::getPacket(uint8_t* buffer, uint8_t* length, int8_t* rssi, uin
     uint8_t packetLength;
     uint8_t scratch;
 
+    /* In continuous mode the frames come in packets instead */
+    if (rxMode_ == RadioRxMode_Continuous)
+    {
+        /* Return error */
+        return RadioResult_Error;
+    }
+
+    /* With the uDMA the frame has already been moved to memory */
+    if (rxDmaBuffer_ != nullptr)
+    {
+        return getDmaPacket(buffer, length, rssi, lqi, crc);
+    }
+
     /* Check if the radio state is correct */
     if (radioState_ != RadioState_ReceiveDone)
     {
@@ -395,17 +867,20 @@ void Radio::interruptHandler(void)
     /* STATUS0 Register: Start of frame event */
     if ((irq_status0 & RFCORE_SFR_RFIRQF0_SFD) == RFCORE_SFR_RFIRQF0_SFD)
     {
+        TRACE_EVENT(TraceEvent_RadioSfd, radioState_, 0);
+
         if (radioState_ == RadioState_ReceiveInit &&
-            rxInit_ != nullptr)
+            filter_ == 0 &&
+            rxInit_.isValid())
         {
             radioState_ = RadioState_Receiving;
-            rxInit_->execute();
+            defer(RADIO_EVENT_RX_INIT);
         }
         else if (radioState_ == RadioState_TransmitInit &&
-                 txInit_ != nullptr)
+                 txInit_.isValid())
         {
             radioState_ = RadioState_Transmitting;
-            txInit_->execute();
+            defer(RADIO_EVENT_TX_INIT);
         }
         else
         {
@@ -413,14 +888,36 @@ void Radio::interruptHandler(void)
         }
     }
 
+    /* STATUS0 Register: Frame accepted event, the start of frame with filtering */
+    if (((irq_status0 & RFCORE_SFR_RFIRQF0_FRAME_ACCEPTED) == RFCORE_SFR_RFIRQF0_FRAME_ACCEPTED))
+    {
+        if (radioState_ == RadioState_ReceiveInit &&
+            filter_ != 0 &&
+            rxInit_.isValid())
+        {
+            radioState_ = RadioState_Receiving;
+            defer(RADIO_EVENT_RX_INIT);
+        }
+    }
+
     /* STATUS0 Register: End of frame event */
     if (((irq_status0 & RFCORE_SFR_RFIRQF0_RXPKTDONE) ==  RFCORE_SFR_RFIRQF0_RXPKTDONE))
     {
-        if (radioState_ == RadioState_Receiving &&
-            rxDone_ != nullptr)
+        TRACE_EVENT(TraceEvent_RadioRxDone, radioState_, 0);
+
+        if (rxMode_ == RadioRxMode_Continuous)
+        {
+            // Handled below, together with FIFOP
+        }
+        else if (radioState_ == RadioState_Receiving &&
+                 rxDone_.isValid())
         {
-            radioState_ = RadioState_ReceiveDone;
-            rxDone_->execute();
+            /* With the uDMA, rxDone is called once the frame is moved */
+            if (rxDmaBuffer_ == nullptr || !receiveDma())
+            {
+                radioState_ = RadioState_ReceiveDone;
+                defer(RADIO_EVENT_RX_DONE);
+            }
         }
         else
         {
@@ -431,23 +928,61 @@ void Radio::interruptHandler(void)
     /* STATUS0 Register: FIFO is full event */
     if (((irq_status0 & RFCORE_SFR_RFIRQF0_FIFOP) ==  RFCORE_SFR_RFIRQF0_FIFOP))
     {
+        TRACE_EVENT(TraceEvent_RadioFifop, radioState_, 0);
+
         // ToDo: Handle otherwise
     }
 
+    /* Continuous mode: take every complete frame out of the FIFO */
+    if (rxMode_ == RadioRxMode_Continuous &&
+        (irq_status0 & (RFCORE_SFR_RFIRQF0_RXPKTDONE | RFCORE_SFR_RFIRQF0_FIFOP)))
+    {
+        uint32_t queued;
+
+        queued = drainRxFifo();
+
+        /* Wait for the next frame, unless transmitting meanwhile */
+        if (radioState_ == RadioState_Receiving ||
+            radioState_ == RadioState_ReceiveDone)
+        {
+            radioState_ = RadioState_ReceiveInit;
+        }
+
+        /* Have the deferred handler send the frames to the queue */
+        if (queued > 0)
+        {
+            defer(rxDone_.isValid() ? RADIO_EVENT_RX_DONE : 0);
+        }
+    }
+
     /* STATUS1 Register: End of frame event */
     if (((irq_status1 & RFCORE_SFR_RFIRQF1_TXDONE) == RFCORE_SFR_RFIRQF1_TXDONE))
     {
+        TRACE_EVENT(TraceEvent_RadioTxDone, radioState_, 0);
+
+        /* With frame filtering SFD is masked again once transmitted */
+        if (filter_ != 0)
+        {
+            HWREG(RFCORE_XREG_RFIRQM0) &= ~RFCORE_SFR_RFIRQF0_SFD;
+        }
+
         if (radioState_ == RadioState_Transmitting &&
-            txDone_ != nullptr)
+            txDone_.isValid())
         {
             radioState_ = RadioState_TransmitDone;
-            txDone_->execute();
+            defer(RADIO_EVENT_TX_DONE);
         }
         else
         {
             // ToDo: Handle otherwise
         }
     }
+
+    /* STATUS1 Register: The CSMA-CA program has stopped */
+    if (((irq_status1 & RFCORE_SFR_RFIRQF1_CSP_STOP) == RFCORE_SFR_RFIRQF1_CSP_STOP))
+    {
+        defer(RADIO_EVENT_CSMA_DONE);
+    }
 }
 
 void Radio::errorHandler(void)
@@ -455,18 +990,20 @@ void Radio::errorHandler(void)
     uint32_t irq_error;
 
     /* Read RFERR_STATUS */
-    irq_error = HWREG(RFCORE_XREG_RFERRM);
+    irq_error = HWREG(RFCORE_SFR_RFERRF);
 
     /* Clear pending interrupt */
     IntPendClear(INT_RFCOREERR);
 
-    /* Check the error interrupt */
-    if ((HWREG(RFCORE_XREG_RFERRM) & (((0x02) << RFCORE_XREG_RFERRM_RFERRM_S) & RFCORE_XREG_RFERRM_RFERRM_M)) & irq_error)
-    {
-        /* Clear error interrupt */
-        HWREG(RFCORE_XREG_RFERRM) = ~(((0x02)<<RFCORE_XREG_RFERRM_RFERRM_S)&RFCORE_XREG_RFERRM_RFERRM_M);
+    /* Clear RFERR_STATUS, otherwise the interrupt fires again at once */
+    HWREG(RFCORE_SFR_RFERRF) = 0;
+
+    TRACE_EVENT(TraceEvent_RadioError, radioState_, irq_error);
 
-        // ToDo: Handle error
+    /* RX FIFO overflows are recovered from where the frames are read */
+    if (irq_error & RFCORE_SFR_RFERRF_RXOVERF)
+    {
+        // Handled by drainRxFifo and getPacket
     }
     else
     {
@@ -474,4 +1011,524 @@ void Radio::errorHandler(void)
     }
 }
 
+/**
+ * Handles the completion of a uDMA transfer. A received frame is in the
+ * buffer and the radio can hand it over, while a payload that has been
+ * loaded only needs to be acknowledged, as transmit waits for it.
+ */
+void Radio::dmaHandler(void)
+{
+    /* Check and clear the channel completion status */
+    if (dmaChannel_ == 0 || !Dma::getInstance().isDone(dmaChannel_))
+    {
+        return;
+    }
+
+    TRACE_EVENT(TraceEvent_RadioDma, radioState_, 0);
+
+    {
+        /* The interrupt handler also updates the state */
+        CriticalSection section(RADIO_INTERRUPT_PRIORITY);
+
+        if (radioState_ != RadioState_Receiving ||
+            !rxDone_.isValid())
+        {
+            return;
+        }
+
+        radioState_ = RadioState_ReceiveDone;
+    }
+
+    rxDone_.execute();
+}
+
+/**
+ * Runs what the interrupt handlers leave to it, below
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY: it sends the frames received in
+ * continuous mode to the queue and runs the callbacks. Events that happen
+ * before it runs are merged, and their callbacks run once, in the order
+ * receive init, receive done, transmit init and transmit done.
+ */
+void Radio::deferredHandler(void)
+{
+    uint32_t events;
+    Packet* packet;
+    bool sent;
+
+    /* Clear pending interrupt */
+    IntPendClear(RADIO_DEFERRED_INTERRUPT);
+
+    /* Take the events left so far, later ones pend the interrupt again */
+    events = events_.exchange(0);
+
+    /* Send the received frames to the queue, oldest first */
+    while (rxReady_.read((uint8_t *) &packet, sizeof(packet)))
+    {
+        sent = (rxQueue_ != nullptr && rxQueue_->sendFromInterrupt(packet));
+        if (!sent)
+        {
+            packet->release();
+        }
+
+        /* The interrupt handler also updates the statistics */
+        CriticalSection section(RADIO_INTERRUPT_PRIORITY);
+        if (sent)
+        {
+            rxStats_.frames++;
+        }
+        else
+        {
+            rxStats_.dropped++;
+        }
+    }
+
+    if (events & RADIO_EVENT_RX_INIT)
+    {
+        rxInit_.execute();
+    }
+
+    if (events & RADIO_EVENT_RX_DONE)
+    {
+        rxDone_.execute();
+    }
+
+    /* Wake up the task that waits in transmit */
+    if (events & RADIO_EVENT_CSMA_DONE)
+    {
+        csmaDone_.giveFromInterrupt();
+    }
+
+    if (events & RADIO_EVENT_TX_INIT)
+    {
+        txInit_.execute();
+    }
+
+    if (events & RADIO_EVENT_TX_DONE)
+    {
+        txDone_.execute();
+    }
+}
+
 /*================================ private ==================================*/
+
+/**
+ * Leaves events to the deferred handler and pends its interrupt. This is
+ * how the interrupt handlers, which run above the kernel, hand work over.
+ */
+void Radio::defer(uint32_t events)
+{
+    events_.fetch_or(events);
+    IntPendSet(RADIO_DEFERRED_INTERRUPT);
+}
+
+/**
+ * Writes the addresses and the frame filter options to the radio. The
+ * frames of other nodes also raise SFD, so with filtering the interrupt
+ * that starts receiving a frame is FRAME_ACCEPTED instead.
+ */
+void Radio::applyFilter(void)
+{
+    uint32_t types = 0;
+    uint32_t mask;
+
+    /* Set the PAN ID and the short address, least significant byte first */
+    HWREG(RFCORE_FFSM_PAN_ID0)     = (panId_ >> 0) & 0xFF;
+    HWREG(RFCORE_FFSM_PAN_ID1)     = (panId_ >> 8) & 0xFF;
+    HWREG(RFCORE_FFSM_SHORT_ADDR0) = (shortAddress_ >> 0) & 0xFF;
+    HWREG(RFCORE_FFSM_SHORT_ADDR1) = (shortAddress_ >> 8) & 0xFF;
+
+    /* Set the extended address, one byte per register */
+    for (uint8_t i = 0; i < sizeof(extendedAddress_); i++)
+    {
+        HWREG(RFCORE_FFSM_EXT_ADDR0 + 4 * i) = extendedAddress_[i];
+    }
+
+    if (filter_ == 0)
+    {
+        /* Disable frame filtering and automatic ACKs */
+        HWREG(RFCORE_XREG_FRMFILT0) &= ~RFCORE_XREG_FRMFILT0_FRAME_FILTER_EN;
+        HWREG(RFCORE_XREG_FRMCTRL0) &= ~RFCORE_XREG_FRMCTRL0_AUTOACK;
+    }
+    else
+    {
+        /* Accept the selected frame types only */
+        if (filter_ & RadioFilter_Beacon)  types |= RFCORE_XREG_FRMFILT1_ACCEPT_FT_0_BEACON;
+        if (filter_ & RadioFilter_Data)    types |= RFCORE_XREG_FRMFILT1_ACCEPT_FT_1_DATA;
+        if (filter_ & RadioFilter_Ack)     types |= RFCORE_XREG_FRMFILT1_ACCEPT_FT_2_ACK;
+        if (filter_ & RadioFilter_Command) types |= RFCORE_XREG_FRMFILT1_ACCEPT_FT_3_MAC_CMD;
+        HWREG(RFCORE_XREG_FRMFILT1) = types;
+
+        /* Enable frame filtering, for every frame version */
+        HWREG(RFCORE_XREG_FRMFILT0) = RFCORE_XREG_FRMFILT0_MAX_FRAME_VERSION_M |
+                                      ((filter_ & RadioFilter_PanCoordinator) ? RFCORE_XREG_FRMFILT0_PAN_COORDINATOR : 0) |
+                                      RFCORE_XREG_FRMFILT0_FRAME_FILTER_EN;
+
+        /* Enable or disable automatic ACKs */
+        if (filter_ & RadioFilter_AutoAck)
+        {
+            HWREG(RFCORE_XREG_FRMCTRL0) |= RFCORE_XREG_FRMCTRL0_AUTOACK;
+        }
+        else
+        {
+            HWREG(RFCORE_XREG_FRMCTRL0) &= ~RFCORE_XREG_FRMCTRL0_AUTOACK;
+        }
+    }
+
+    /* Set the pending bit of the ACKs to the data requests of the table */
+    if (filter_ & RadioFilter_AutoPend)
+    {
+        HWREG(RFCORE_XREG_SRCMATCH) = RFCORE_XREG_SRCMATCH_SRC_MATCH_EN |
+                                      RFCORE_XREG_SRCMATCH_AUTOPEND |
+                                      RFCORE_XREG_SRCMATCH_PEND_DATAREQ_ONLY;
+    }
+    else
+    {
+        HWREG(RFCORE_XREG_SRCMATCH) = 0;
+    }
+
+    /* Swap the interrupt that starts a frame, once the interrupts are enabled */
+    mask = HWREG(RFCORE_XREG_RFIRQM0);
+    if (mask != 0)
+    {
+        mask &= ~(RFCORE_SFR_RFIRQF0_SFD | RFCORE_SFR_RFIRQF0_FRAME_ACCEPTED);
+        mask |= (filter_ == 0) ? RFCORE_SFR_RFIRQF0_SFD : RFCORE_SFR_RFIRQF0_FRAME_ACCEPTED;
+        HWREG(RFCORE_XREG_RFIRQM0) = mask;
+    }
+}
+
+/**
+ * Writes the whole source match table, e.g. after a sleep.
+ */
+void Radio::applySourceTable(void)
+{
+    for (uint32_t i = 0; i < 4 * sourceUnits_; i++)
+    {
+        HWREG(FRMF_SRCM_RAM_BASE + 4 * i) = sourceTable_[i];
+    }
+
+    applySourceMasks();
+}
+
+/**
+ * Writes the enable and pending masks of the source match table. Bit n of
+ * the short masks stands for unit n, and bit 2n of the extended masks for
+ * the extended entry in units 2n and 2n + 1, so the masks follow from the
+ * units in use in O(1).
+ */
+void Radio::applySourceMasks(void)
+{
+    uint32_t extended = sourceExtended_ | (sourceExtended_ << 1);
+    uint32_t masks[4];
+
+    masks[0] = sourceUsed_ & ~extended;
+    masks[1] = sourceExtended_;
+    masks[2] = sourcePending_ & masks[0];
+    masks[3] = sourcePending_ & masks[1];
+
+    /* Each 24-bit mask is split in three registers */
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        HWREG(RFCORE_XREG_SRCSHORTEN0 + 4 * i)     = (masks[0] >> (8 * i)) & 0xFF;
+        HWREG(RFCORE_XREG_SRCEXTEN0 + 4 * i)       = (masks[1] >> (8 * i)) & 0xFF;
+        HWREG(RFCORE_FFSM_SRCSHORTPENDEN0 + 4 * i) = (masks[2] >> (8 * i)) & 0xFF;
+        HWREG(RFCORE_FFSM_SRCEXTPENDEN0 + 4 * i)   = (masks[3] >> (8 * i)) & 0xFF;
+    }
+}
+
+/**
+ * Returns whether an entry of the source match table is in use, i.e. a
+ * short entry or the first unit of an extended one.
+ */
+bool Radio::isSourceEntry(int32_t entry)
+{
+    uint32_t extended = sourceExtended_ | (sourceExtended_ << 1);
+
+    if (entry < 0 || entry >= (int32_t) sourceUnits_)
+    {
+        return false;
+    }
+
+    return ((sourceExtended_ | (sourceUsed_ & ~extended)) & (1UL << entry)) != 0;
+}
+
+/**
+ * Runs the CSMA-CA program and sleeps until the CSP stops, as the backoffs
+ * take tens of milliseconds. Returns RadioResult_Busy once the channel has
+ * been busy too many times, and RadioResult_Error if the receiver is off or
+ * the program does not stop in time.
+ */
+RadioResult Radio::transmitCsma(void)
+{
+    uint32_t attempts;
+    uint32_t backoffs;
+    uint32_t i;
+
+    /* The CCA needs the receiver, it would never be clear */
+    if (HWREG(RFCORE_XREG_RXENABLE) == 0)
+    {
+        return RadioResult_Error;
+    }
+
+    /* Load the program, which the CSP runs from the start */
+    HWREG(RFCORE_SFR_RFST) = CC2538_RF_CSP_OP_ISCLEAR;
+    for (i = 0; i < sizeof(csmaProgram); i++)
+    {
+        HWREG(RFCORE_SFR_RFST) = csmaProgram[i];
+    }
+
+    /* Start with the minimum exponent and all the attempts left */
+    attempts = RADIO_CSMA_MAX_BACKOFFS + 1;
+    HWREG(RFCORE_XREG_CSPY) = RADIO_CSMA_MIN_BE;
+    HWREG(RFCORE_XREG_CSPZ) = attempts;
+
+    /* Drop the stop of a program that timed out before */
+    csmaDone_.take(0);
+
+    /* Run the program, the CSP_STOP interrupt wakes us up */
+    HWREG(RFCORE_SFR_RFST) = CC2538_RF_CSP_OP_ISSTART;
+    if (!csmaDone_.take(RADIO_CSMA_TIMEOUT_MS))
+    {
+        HWREG(RFCORE_SFR_RFST) = CC2538_RF_CSP_OP_ISSTOP;
+        return RadioResult_Error;
+    }
+
+    /* Every busy CCA has used up an attempt */
+    backoffs = attempts - HWREG(RFCORE_XREG_CSPZ);
+    txStats_.busy += backoffs;
+    txStats_.backoffs = backoffs;
+
+    if (backoffs > 0)
+    {
+        TRACE_EVENT(TraceEvent_RadioBusy, radioState_, backoffs);
+    }
+
+    /* The program only transmits with attempts left, the sampled CCA tells */
+    if (backoffs < attempts &&
+        (HWREG(RFCORE_XREG_FSMSTAT1) & RFCORE_XREG_FSMSTAT1_SAMPLED_CCA))
+    {
+        return RadioResult_Success;
+    }
+
+    return RadioResult_Busy;
+}
+
+/**
+ * Starts moving the frame at the head of the RX FIFO to the buffer, the
+ * length byte, the payload and the RSSI and CRC/LQI bytes. Returns false
+ * if the frame cannot be moved or does not fit, in which case the length
+ * byte is cleared so that getPacket flushes the RX FIFO and fails.
+ */
+bool Radio::receiveDma(void)
+{
+    uint8_t length;
+
+    /* Peek at the length byte, leaving it in the FIFO */
+    length = HWREG(RFCORE_XREG_RXFIRST);
+
+    /* Check if the length is valid and the channel is free */
+    if ((length > CC2538_RF_MAX_PACKET_LEN) ||
+        (length <= CC2538_RF_MIN_PACKET_LEN) ||
+        ((uint32_t) length + 1 > rxDmaLength_) ||
+        !Dma::getInstance().request(dmaChannel_, RADIO_DMA_RX_CONTROL, (void *) RFCORE_SFR_RFDATA, rxDmaBuffer_, length + 1))
+    {
+        rxDmaBuffer_[0] = 0;
+
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Takes the RSSI and CRC/LQI bytes off the end of a frame received in
+ * continuous mode, which leaves the payload in the packet.
+ */
+RadioResult Radio::getPacket(Packet* packet, int8_t* rssi, uint8_t* lqi, uint8_t* crc)
+{
+    uint8_t* status;
+
+    /* Check if the packet holds the RSSI and CRC/LQI bytes */
+    if (packet->getLength() < 2)
+    {
+        /* Return error */
+        return RadioResult_Error;
+    }
+
+    /* Update the RSSI and CRC */
+    status     = packet->getTail() - 2;
+    *rssi      = ((int8_t) status[0] - CC2538_RF_RSSI_OFFSET);
+    *crc       = status[1] & CC2538_RF_CRC_BITMASK;
+    *lqi       = status[1] & CC2538_RF_LQI_BITMASK;
+
+    /* Leave the payload only */
+    packet->trimTail(2);
+
+    return RadioResult_Success;
+}
+
+/**
+ * Moves the complete frames in the RX FIFO to packets, oldest first, and
+ * returns how many were queued. A frame that is still being received is
+ * left in the FIFO. The FIFO is only flushed when it has overflowed, once
+ * the frames before the one that overflowed are out, or when a length byte
+ * is not valid, since nothing behind it can be framed.
+ */
+uint32_t Radio::drainRxFifo(void)
+{
+    uint32_t status, count;
+    uint32_t queued = 0;
+    uint8_t length;
+
+    /* The FIFO has overflowed if FIFOP is set and FIFO is not */
+    status = HWREG(RFCORE_XREG_FSMSTAT1);
+
+    while ((count = HWREG(RFCORE_XREG_RXFIFOCNT)) > 0)
+    {
+        /* Peek at the length byte, leaving it in the FIFO */
+        length = HWREG(RFCORE_XREG_RXFIRST);
+
+        /* Check if the length is not valid */
+        if ((length > CC2538_RF_MAX_PACKET_LEN) ||
+            (length <= CC2538_RF_MIN_PACKET_LEN))
+        {
+            /* Flush the RX buffer */
+            CC2538_RF_CSP_ISFLUSHRX();
+
+            rxStats_.errors++;
+
+            return queued;
+        }
+
+        /* Check if the frame is still being received */
+        if (count < (uint32_t) length + 1)
+        {
+            break;
+        }
+
+        if (queueRxFrame(length))
+        {
+            queued++;
+        }
+        else
+        {
+            rxStats_.dropped++;
+        }
+    }
+
+    if ((status & RFCORE_XREG_FSMSTAT1_FIFOP) &&
+        !(status & RFCORE_XREG_FSMSTAT1_FIFO))
+    {
+        /* Flush the frame that overflowed, which resumes receiving */
+        CC2538_RF_CSP_ISFLUSHRX();
+
+        rxStats_.overflows++;
+    }
+
+    return queued;
+}
+
+/**
+ * Moves a frame from the RX FIFO straight into a packet of the pool: the
+ * payload and the RSSI and CRC/LQI bytes, without the length byte. The
+ * packet is left to the deferred handler once it holds the whole frame, so
+ * the task never sees part of it. Returns false if no packet is free, the
+ * frame does not fit or too many frames wait for the deferred handler, in
+ * which case the frame is taken out of the FIFO and discarded.
+ */
+bool Radio::queueRxFrame(uint8_t length)
+{
+    Packet* packet;
+    uint8_t* data = nullptr;
+    uint8_t byte;
+
+    /* Take a packet with room for the frame */
+    packet = rxPool_->allocate();
+    if (packet != nullptr)
+    {
+        data = packet->append(length);
+    }
+
+    /* Take the length byte out, it has been checked already */
+    length = HWREG(RFCORE_SFR_RFDATA);
+
+    /* Copy the frame to the packet, or discard it */
+    for (uint32_t i = 0; i < length; i++)
+    {
+        byte = HWREG(RFCORE_SFR_RFDATA);
+
+        if (data != nullptr)
+        {
+            data[i] = byte;
+        }
+    }
+
+    /* Leave the packet to the deferred handler, which sends it to the queue */
+    if (data == nullptr || !rxReady_.write((uint8_t *) &packet, sizeof(packet)))
+    {
+        if (packet != nullptr)
+        {
+            packet->release();
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Reads the frame that the uDMA has moved to the buffer, as getPacket does
+ * from the RX FIFO.
+ */
+RadioResult Radio::getDmaPacket(uint8_t* buffer, uint8_t* length, int8_t* rssi, uint8_t* lqi, uint8_t* crc)
+{
+    uint8_t packetLength;
+    uint8_t scratch;
+
+    /* Check if the radio state is correct */
+    if (radioState_ != RadioState_ReceiveDone)
+    {
+        /* Return error */
+        return RadioResult_Error;
+    }
+
+    /* Flush what the RX buffer holds after the frame */
+    CC2538_RF_CSP_ISFLUSHRX();
+
+    /* Set the radio state to idle */
+    radioState_ = RadioState_Idle;
+
+    /* Check the packet length (first byte) */
+    packetLength = rxDmaBuffer_[0];
+
+    /* Check if packet is too long or too short */
+    if ((packetLength > CC2538_RF_MAX_PACKET_LEN) ||
+        (packetLength <= CC2538_RF_MIN_PACKET_LEN))
+    {
+        /* Return error */
+        return RadioResult_Error;
+    }
+
+    /* Account for the CRC bytes */
+    packetLength -= 2;
+
+    /* Check if the packet fits in the buffer */
+    if (packetLength > *length)
+    {
+        /* Return error */
+        return RadioResult_Error;
+    }
+
+    /* Copy the frame to the buffer (except for the CRC) */
+    memcpy(buffer, &rxDmaBuffer_[1], packetLength);
+
+    /* Update the packet length, RSSI and CRC */
+    *length    = packetLength;
+    *rssi      = ((int8_t) rxDmaBuffer_[1 + packetLength] - CC2538_RF_RSSI_OFFSET);
+    scratch    = rxDmaBuffer_[2 + packetLength];
+    *crc       = scratch & CC2538_RF_CRC_BITMASK;
+    *lqi       = scratch & CC2538_RF_LQI_BITMASK;
+
+    return RadioResult_Success;
+}
@@ -11,9 +11,11 @@
 
 /*================================ include ==================================*/
 
+#include "Dma.h"
 #include "Gpio.h"
 #include "Uart.h"
 #include "InterruptHandler.h"
+#include "Trace.h"
 
 #include "cc2538_include.h"
 #include "platform_types.h"
@@ -30,7 +32,8 @@
 
 Uart::Uart(Gpio& rx, Gpio& tx, UartConfig& config):
     rx_(rx), tx_(tx), config_(config), \
-    rxSemaphore_(false), txSemaphore_(true)
+    rxSemaphore_(false), txSemaphore_(true), \
+    rxDmaBuffer_(nullptr), rxDmaLength_(0), rxDmaCount_(0), rxDmaAlternate_(false)
 {
 }
 
@@ -67,12 +70,47 @@ void Uart::enable(uint32_t baudrate)
     // Configure the UART
     UARTConfigSetExpClk(config_.base, SysCtrlIOClockGet(), config_.baudrate, config_.mode);
 
-    // Disable FIFO as we only use a one-byte buffer
-    UARTFIFODisable(config_.base);
+    // Use the FIFO with the configured receive trigger level, if enabled
+    if (config_.fifo)
+    {
+        UARTFIFOLevelSet(config_.base, UART_FIFO_TX1_8, config_.fifo_rx);
+        UARTFIFOEnable(config_.base);
+    }
+    else
+    {
+        // Disable FIFO as we only use a one-byte buffer
+        UARTFIFODisable(config_.base);
+    }
 
     // Raise an interrupt at the end of transmission
     UARTTxIntModeSet(config_.base, UART_TXINT_MODE_EOT);
 
+    // Let the uDMA feed the transmitter if the UART has a channel
+    if (config_.dma_tx != 0)
+    {
+        Dma& dma = Dma::getInstance();
+
+        // Move one byte per request from memory to the data register
+        dma.enable();
+        dma.configure(config_.dma_tx, UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_1);
+
+        // Enable the UART transmit requests
+        UARTDMAEnable(config_.base, UART_DMA_TX);
+    }
+
+    // Let the uDMA drain the receiver if the UART has a channel
+    if (config_.dma_rx != 0)
+    {
+        Dma& dma = Dma::getInstance();
+
+        // Move one byte per request from the data register to memory
+        dma.enable();
+        dma.configure(config_.dma_rx, UDMA_SIZE_8 | UDMA_SRC_INC_NONE | UDMA_DST_INC_8 | UDMA_ARB_1);
+
+        // Enable the UART receive requests
+        UARTDMAEnable(config_.base, UART_DMA_RX);
+    }
+
     // Enable UART hardware
     UARTEnable(config_.base);
 }
@@ -105,23 +143,41 @@ void Uart::wakeup(void)
     enable();
 }
 
-void Uart::setRxCallback(Callback* callback)
+/**
+ * Sets the callback that runs when bytes are received, either from the
+ * UART interrupt or deferred to the work queue daemon.
+ */
+void Uart::setRxCallback(Delegate callback, CallbackContext context)
 {
-    rx_callback_ = callback;
+    rx_callback_ = rxWork_.bind(callback, context);
 }
 
-void Uart::setTxCallback(Callback* callback)
+void Uart::setTxCallback(Delegate callback, CallbackContext context)
 {
-    tx_callback_ = callback;
+    tx_callback_ = txWork_.bind(callback, context);
 }
 
 void Uart::enableInterrupts(void)
 {
+    uint32_t interrupts = 0;
+
     // Register the interrupt handler
     InterruptHandler::getInstance().setInterruptHandler(this);
 
+    // With a uDMA channel the end of a buffer replaces the RX interrupts
+    if (config_.dma_rx == 0)
+    {
+        interrupts |= UART_INT_RX | UART_INT_RT;
+    }
+
+    // With a uDMA channel the end of a transfer replaces the TX interrupt
+    if (config_.dma_tx == 0)
+    {
+        interrupts |= UART_INT_TX;
+    }
+
     // Enable the UART RX, TX and RX timeout interrupts
-    UARTIntEnable(config_.base, UART_INT_RX | UART_INT_TX | UART_INT_RT);
+    UARTIntEnable(config_.base, interrupts);
 
     // Set the UART interrupt priority
     IntPrioritySet(config_.interrupt, (7 << 5));
@@ -194,8 +250,92 @@ uint32_t Uart::readByte(uint8_t * buffer, uint32_t length)
     return 0;
 }
 
+/**
+ * Reads the bytes waiting in the receiver without blocking, so that the RX
+ * callback drains the whole FIFO at once. Returns the number of bytes read.
+ */
+uint32_t Uart::readFifo(uint8_t* buffer, uint32_t length)
+{
+    uint32_t count = 0;
+
+    // Read bytes while the receiver has any
+    while (count < length && UARTCharsAvail(config_.base))
+    {
+        buffer[count++] = (uint8_t) UARTCharGetNonBlocking(config_.base);
+    }
+
+    return count;
+}
+
+/**
+ * Starts receiving with the uDMA into the buffer, which is split in two
+ * halves that are filled in turns. The RX callback runs each time a half
+ * is full and the received bytes are found with getDmaRxCount. Returns
+ * false if the UART has no uDMA channel or a half does not fit in one
+ * transfer.
+ */
+bool Uart::readDma(uint8_t* buffer, uint32_t length)
+{
+    Dma& dma = Dma::getInstance();
+    void* data = (void *) (config_.base + UART_O_DR);
+    bool status;
+
+    // Check that the UART has a uDMA channel
+    if (config_.dma_rx == 0) return false;
+
+    rxDmaBuffer_ = buffer;
+    rxDmaLength_ = length / 2;
+    rxDmaCount_ = 0;
+    rxDmaAlternate_ = false;
+
+    // Fill the first half, then the second one
+    status = dma.transferPingPong(config_.dma_rx, data, &rxDmaBuffer_[0], &rxDmaBuffer_[rxDmaLength_], rxDmaLength_);
+
+    return status;
+}
+
+/**
+ * Returns the number of bytes that the uDMA has received since readDma.
+ * The count wraps around, byte i is at buffer[i % length] and is only
+ * valid until the uDMA comes back to it one buffer later.
+ */
+uint32_t Uart::getDmaRxCount(void)
+{
+    Dma& dma = Dma::getInstance();
+    uint32_t count;
+
+    // Keep the interrupt handler from moving on to the other half
+    IntDisable(config_.interrupt);
+
+    // Add the progress within the half that is being filled
+    count = rxDmaCount_;
+    if (dma.isStopped(config_.dma_rx, rxDmaAlternate_))
+    {
+        count += rxDmaLength_;
+    }
+    else
+    {
+        count += rxDmaLength_ - dma.getRemaining(config_.dma_rx, rxDmaAlternate_);
+    }
+
+    IntEnable(config_.interrupt);
+
+    return count;
+}
+
+/**
+ * Writes one byte without blocking, the TX callback runs once it has been
+ * sent. With a uDMA channel the TX interrupt is only enabled for this byte,
+ * so that a byte written when the uDMA cannot take the buffer completes.
+ */
 void Uart::writeByte(uint8_t byte)
 {
+    // The end of a uDMA transfer replaces the TX interrupt, enable it
+    if (config_.dma_tx != 0)
+    {
+        UARTIntEnable(config_.base, UART_INT_TX);
+    }
+
     UARTCharPutNonBlocking(config_.base, byte);
 }
 
@@ -214,6 +354,22 @@ uint32_t Uart::writeByte(uint8_t * buffer, uint32_t length)
     return 0;
 }
 
+/**
+ * Hands the whole buffer to the uDMA, which writes it to the UART while the
+ * CPU does something else. The TX callback runs once, when the last byte
+ * has been written. Returns false if the UART has no uDMA channel or the
+ * buffer does not fit in one transfer, in which case nothing is sent. The
+ * buffer must stay untouched until the TX callback runs.
+ */
+bool Uart::writeDma(uint8_t* buffer, uint32_t length)
+{
+    // Check that the UART has a uDMA channel
+    if (config_.dma_tx == 0) return false;
+
+    // Start the transfer to the UART data register
+    return Dma::getInstance().transfer(config_.dma_tx, buffer, (void *) (config_.base + UART_O_DR), length);
+}
+
 /*=============================== protected =================================*/
 
 UartConfig& Uart::getConfig(void)
@@ -235,6 +391,19 @@ void Uart::interruptHandler(void)
     if (status & UART_INT_TX)
     {
         UARTIntClear(config_.base, UART_INT_TX);
+
+        // With a uDMA channel the TX interrupt only covers one byte
+        if (config_.dma_tx != 0)
+        {
+            UARTIntDisable(config_.base, UART_INT_TX);
+        }
+
+        interruptHandlerTx();
+    }
+
+    // Process the end of a uDMA transfer, signalled on the UART interrupt
+    if (config_.dma_tx != 0 && Dma::getInstance().isDone(config_.dma_tx))
+    {
         interruptHandlerTx();
     }
 
@@ -244,22 +413,54 @@ void Uart::interruptHandler(void)
         UARTIntClear(config_.base, UART_INT_RX | UART_INT_RT);
         interruptHandlerRx();
     }
+
+    // Process the end of a uDMA receive half
+    if (config_.dma_rx != 0 && Dma::getInstance().isDone(config_.dma_rx))
+    {
+        interruptHandlerRxDma();
+    }
 }
 
 /*================================ private ==================================*/
 
 void Uart::interruptHandlerRx(void)
 {
-    if (rx_callback_ != nullptr)
+    TRACE_EVENT(TraceEvent_UartRx, 0, 0);
+
+    if (rx_callback_.isValid())
     {
-        rx_callback_->execute();
+        rx_callback_.execute();
     }
 }
 
+void Uart::interruptHandlerRxDma(void)
+{
+    Dma& dma = Dma::getInstance();
+    void* data = (void *) (config_.base + UART_O_DR);
+    uint8_t* half;
+
+    TRACE_EVENT(TraceEvent_UartRxDma, rxDmaAlternate_, rxDmaCount_);
+
+    // Reload every half that is full, in the order they were filled
+    while (dma.isStopped(config_.dma_rx, rxDmaAlternate_))
+    {
+        half = &rxDmaBuffer_[rxDmaAlternate_ ? rxDmaLength_ : 0];
+        dma.reload(config_.dma_rx, rxDmaAlternate_, data, half, rxDmaLength_);
+
+        rxDmaCount_ += rxDmaLength_;
+        rxDmaAlternate_ = !rxDmaAlternate_;
+    }
+
+    // Notify that the received bytes are ready
+    interruptHandlerRx();
+}
+
 void Uart::interruptHandlerTx(void)
 {
-    if (tx_callback_ != nullptr)
+    TRACE_EVENT(TraceEvent_UartTx, 0, 0);
+
+    if (tx_callback_.isValid())
     {
-        tx_callback_->execute();
+        tx_callback_.execute();
     }
 }
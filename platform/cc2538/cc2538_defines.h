@@ -48,6 +48,28 @@
 #define CC2538_RF_CSP_OP_ISRFOFF                ( 0xEF )
 #define CC2538_RF_CSP_OP_ISFLUSHRX              ( 0xED )
 #define CC2538_RF_CSP_OP_ISFLUSHTX              ( 0xEE )
+#define CC2538_RF_CSP_OP_ISSTART                ( 0xE1 )
+#define CC2538_RF_CSP_OP_ISSTOP                 ( 0xE2 )
+#define CC2538_RF_CSP_OP_ISCLEAR                ( 0xFF )
+
+// Defines for the CSP program instructions, loaded by writing them to RFST
+#define CC2538_RF_CSP_OP_SKIP(s, c)             ( (((s) & 0x07) << 4) | (c) )
+#define CC2538_RF_CSP_OP_RPT(c)                 ( 0xA0 | (c) )
+#define CC2538_RF_CSP_OP_LABEL                  ( 0xBB )
+#define CC2538_RF_CSP_OP_WAITX                  ( 0xBC )
+#define CC2538_RF_CSP_OP_RANDXY                 ( 0xBD )
+#define CC2538_RF_CSP_OP_DECZ                   ( 0xC5 )
+#define CC2538_RF_CSP_OP_INCMAXY(m)             ( 0xC8 | ((m) & 0x07) )
+#define CC2538_RF_CSP_OP_STOP                   ( 0xD2 )
+#define CC2538_RF_CSP_OP_STXONCCA               ( 0xDA )
+
+// Defines for the CSP program conditions, negated with CC2538_RF_CSP_CC_NOT
+#define CC2538_RF_CSP_CC_CCA                    ( 0x00 )
+#define CC2538_RF_CSP_CC_X_ZERO                 ( 0x04 )
+#define CC2538_RF_CSP_CC_Y_ZERO                 ( 0x05 )
+#define CC2538_RF_CSP_CC_Z_ZERO                 ( 0x06 )
+#define CC2538_RF_CSP_CC_RSSI_VALID             ( 0x07 )
+#define CC2538_RF_CSP_CC_NOT                    ( 0x08 )
 
 // Send an RX ON command strobe to the CSP
 #define CC2538_RF_CSP_ISRXON()    \
@@ -57,6 +79,10 @@
 #define CC2538_RF_CSP_ISTXON()    \
   do { HWREG(RFCORE_SFR_RFST) = CC2538_RF_CSP_OP_ISTXON; } while(0)
 
+// Send a TX ON command strobe to the CSP, if CCA indicates a clear channel
+#define CC2538_RF_CSP_ISTXONCCA() \
+  do { HWREG(RFCORE_SFR_RFST) = CC2538_RF_CSP_OP_ISTXONCCA; } while(0)
+
 // Send a RF OFF command strobe to the CSP
 #define CC2538_RF_CSP_ISRFOFF()   \
   do { HWREG(RFCORE_SFR_RFST) = CC2538_RF_CSP_OP_ISRFOFF; } while(0)
@@ -73,6 +73,10 @@ struct UartConfig {
 	uint32_t interrupt;
 	uint32_t baudrate;
 	uint32_t mode;
+	bool fifo;
+	uint32_t fifo_rx;
+	uint32_t dma_tx;
+	uint32_t dma_rx;
 };
 
 /*=============================== variables =================================*/
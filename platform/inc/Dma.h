@@ -0,0 +1,64 @@
+/**
+ * @file       Dma.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef DMA_H_
+#define DMA_H_
+
+#include <stdint.h>
+
+/**
+ * Highest channel that the project uses, e.g. 9 for UDMA_CH9_UART0TX. The
+ * control table only holds the structures up to the alternate one of this
+ * channel, and the channels above it are rejected.
+ */
+#ifndef DMA_CHANNEL_MAX
+#define DMA_CHANNEL_MAX                     ( 31 )
+#endif
+
+/**
+ * Owns the uDMA controller and its channel control table, which all the
+ * peripherals share. Channels are named by their libcc2538 mapping (e.g.
+ * UDMA_CH9_UART0TX), which selects both the channel and the peripheral
+ * that drives it. A peripheral-triggered channel signals completion on the
+ * interrupt vector of its peripheral, so the peripheral driver polls
+ * isDone() from its own interrupt handler.
+ *
+ * A ping-pong transfer alternates between the primary and the alternate
+ * control structures of the channel. Once one of them is done (stopped)
+ * the controller moves on to the other one, and the driver reloads the
+ * stopped one so that the stream never stalls.
+ *
+ * A software-requested transfer runs from memory, or a peripheral data
+ * register, as soon as it is requested and completes on the dedicated uDMA
+ * interrupt vector (INT_UDMA) instead.
+ */
+class Dma
+{
+public:
+    static Dma& getInstance(void);
+    void enable(void);
+    void configure(uint32_t mapping, uint32_t control);
+    bool transfer(uint32_t mapping, void* source, void* destination, uint32_t length);
+    bool transferPingPong(uint32_t mapping, void* source, void* ping, void* pong, uint32_t length);
+    void reload(uint32_t mapping, bool alternate, void* source, void* destination, uint32_t length);
+    bool request(uint32_t mapping, uint32_t control, void* source, void* destination, uint32_t length);
+    bool isStopped(uint32_t mapping, bool alternate);
+    uint32_t getRemaining(uint32_t mapping, bool alternate);
+    bool isBusy(uint32_t mapping);
+    bool isDone(uint32_t mapping);
+private:
+    Dma();
+private:
+    static Dma instance_;
+    bool enabled_;
+};
+
+#endif /* DMA_H_ */
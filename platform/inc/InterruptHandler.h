@@ -66,6 +66,8 @@ private:
     static inline void SysTick_InterruptHandler(void);
     static inline void RFCore_InterruptHandler(void);
     static inline void RFError_InterruptHandler(void);
+    static inline void RFDeferred_InterruptHandler(void);
+    static inline void UDMA_InterruptHandler(void);
     static inline void SleepTimer_InterruptHandler(void);
     static inline void RadioTimer_InterruptHandler(void);
     static inline void Aes_InterruptHandler(void);
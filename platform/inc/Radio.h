@@ -14,7 +14,86 @@
 
 #include <stdint.h>
 
+#include <atomic>
+
 #include "Callback.h"
+#include "CircularBuffer.h"
+#include "MessageQueue.h"
+#include "Packet.h"
+#include "Semaphore.h"
+#include "WorkQueue.h"
+
+/**
+ * Priority of the RF core interrupts. It is above
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY, so neither the kernel nor the
+ * default critical sections delay draining the RX FIFO. The handlers make
+ * no kernel calls. They pend RADIO_DEFERRED_INTERRUPT, whose handler runs
+ * at RADIO_DEFERRED_PRIORITY, where it may call the kernel, and hands the
+ * frames and the callbacks over. Code that shares state with the handlers
+ * masks them with a CriticalSection of this priority.
+ */
+#ifndef RADIO_INTERRUPT_PRIORITY
+#define RADIO_INTERRUPT_PRIORITY            ( 4 << 5 )
+#endif
+
+/**
+ * Interrupt that the radio pends to leave its handlers, and its priority.
+ * The project must not use this interrupt for anything else.
+ */
+#ifndef RADIO_DEFERRED_INTERRUPT
+#define RADIO_DEFERRED_INTERRUPT            ( INT_PKA )
+#endif
+
+#ifndef RADIO_DEFERRED_PRIORITY
+#define RADIO_DEFERRED_PRIORITY             ( 7 << 5 )
+#endif
+
+/**
+ * Number of received frames that the queue of continuous mode holds, see
+ * Radio::enableContinuous. It has to be a power of two.
+ */
+#ifndef RADIO_RX_PACKETS
+#define RADIO_RX_PACKETS                    ( 4 )
+#endif
+
+/**
+ * Size of a buffer for Radio::enableDma that takes any received frame,
+ * i.e. the length byte and the longest frame.
+ */
+#define RADIO_DMA_BUFFER_LENGTH             ( 128 )
+
+/**
+ * Size of the hardware source match table, in 4-byte units. A short
+ * address entry takes one unit and an extended address entry an aligned
+ * pair of them. The copy of Radio::setSourceTable takes 4 bytes per unit.
+ */
+#define RADIO_SOURCE_UNITS                  ( 24 )
+
+/**
+ * Unslotted CSMA-CA parameters, see Radio::enableCsma: the minimum and
+ * maximum backoff exponents and the number of busy CCAs before giving up,
+ * with the defaults of IEEE 802.15.4.
+ */
+#ifndef RADIO_CSMA_MIN_BE
+#define RADIO_CSMA_MIN_BE                   ( 3 )
+#endif
+
+#ifndef RADIO_CSMA_MAX_BE
+#define RADIO_CSMA_MAX_BE                   ( 5 )
+#endif
+
+#ifndef RADIO_CSMA_MAX_BACKOFFS
+#define RADIO_CSMA_MAX_BACKOFFS             ( 4 )
+#endif
+
+/**
+ * Time that transmit waits for the CSMA-CA program to finish, in
+ * milliseconds. The longest run with the defaults backs off for 115
+ * periods, i.e. about 37 ms.
+ */
+#ifndef RADIO_CSMA_TIMEOUT_MS
+#define RADIO_CSMA_TIMEOUT_MS               ( 100 )
+#endif
 
 typedef enum
 {
@@ -30,10 +109,59 @@ typedef enum
 
 typedef enum
 {
+    RadioResult_Busy        = -2,
     RadioResult_Error       = -1,
     RadioResult_Success     =  0
 } RadioResult;
 
+typedef enum
+{
+    RadioRxMode_Single      = 0x00,
+    RadioRxMode_Continuous  = 0x01
+} RadioRxMode;
+
+/**
+ * Options of the hardware frame filter, see Radio::enableFilter. The frame
+ * types are accepted as long as they are addressed to the radio, and the
+ * PAN coordinator also accepts frames without a destination address.
+ */
+typedef enum
+{
+    RadioFilter_Beacon         = 0x01,
+    RadioFilter_Data           = 0x02,
+    RadioFilter_Ack            = 0x04,
+    RadioFilter_Command        = 0x08,
+    RadioFilter_AllFrames      = 0x0F,
+    RadioFilter_AutoAck        = 0x10,
+    RadioFilter_PanCoordinator = 0x20,
+    RadioFilter_AutoPend       = 0x40
+} RadioFilter;
+
+/**
+ * Queue that hands the frames received in continuous mode to a task.
+ */
+typedef MessageQueue<Packet*, RADIO_RX_PACKETS> RadioRxQueue;
+
+struct RadioRxStats
+{
+    uint32_t frames;
+    uint32_t dropped;
+    uint32_t overflows;
+    uint32_t errors;
+};
+
+/**
+ * Transmit statistics. Busy counts the CCAs that found the channel busy,
+ * i.e. the retries, and backoffs the ones of the last frame.
+ */
+struct RadioTxStats
+{
+    uint32_t frames;
+    uint32_t failures;
+    uint32_t busy;
+    uint32_t backoffs;
+};
+
 class Radio
 {
 
@@ -47,26 +175,91 @@ public:
     void on(void);
     void off(void);
     void reset(void);
-    void setRxCallbacks(Callback* rxInit, Callback* rxDone);
-    void setTxCallbacks(Callback* txInit, Callback* txDone);
+    void setRxCallbacks(Delegate rxInit, Delegate rxDone, CallbackContext context = CallbackContext_Interrupt);
+    void setTxCallbacks(Delegate txInit, Delegate txDone, CallbackContext context = CallbackContext_Interrupt);
     void enableInterrupts(void);
     void disableInterrupts(void);
     void setChannel(uint8_t channel);
     void setPower(uint8_t power);
-    void transmit(void);
+    void setPanId(uint16_t panId);
+    void setShortAddress(uint16_t address);
+    void setExtendedAddress(const uint8_t* address);
+    void enableFilter(uint32_t filter);
+    void setPromiscuous(void);
+    bool isPromiscuous(void);
+    void setSourceTable(uint8_t* table, uint32_t length);
+    int32_t addSource(uint16_t panId, uint16_t address, bool pending);
+    int32_t addSource(const uint8_t* address, bool pending);
+    bool removeSource(int32_t entry);
+    bool setSourcePending(int32_t entry, bool pending);
+    RadioResult transmit(void);
     void receive(void);
+    void enableContinuous(PacketPool& pool, RadioRxQueue& queue);
+    void disableContinuous(void);
+    void getRxStats(RadioRxStats& stats);
+    void enableCsma(void);
+    void disableCsma(void);
+    void getTxStats(RadioTxStats& stats);
+    void enableDma(uint8_t* buffer = nullptr, uint32_t length = 0);
     RadioResult loadPacket(uint8_t* data, uint8_t length);
     RadioResult getPacket(uint8_t* buffer, uint8_t* length, int8_t* rssi, uint8_t* lqi, uint8_t* crc);
+    RadioResult getPacket(Packet* packet, int8_t* rssi, uint8_t* lqi, uint8_t* crc);
 protected:
     void interruptHandler(void);
     void errorHandler(void);
+    void dmaHandler(void);
+    void deferredHandler(void);
+private:
+    void defer(uint32_t events);
+    void applyFilter(void);
+    void applySourceTable(void);
+    void applySourceMasks(void);
+    bool isSourceEntry(int32_t entry);
+    RadioResult transmitCsma(void);
+    bool receiveDma(void);
+    RadioResult getDmaPacket(uint8_t* buffer, uint8_t* length, int8_t* rssi, uint8_t* lqi, uint8_t* crc);
+    uint32_t drainRxFifo(void);
+    bool queueRxFrame(uint8_t length);
 protected:
     volatile RadioState radioState_;
 
-    Callback* rxInit_;
-    Callback* rxDone_;
-    Callback* txInit_;
-    Callback* txDone_;
+    Delegate rxInit_;
+    Delegate rxDone_;
+    Delegate txInit_;
+    Delegate txDone_;
+
+    WorkItem rxInitWork_;
+    WorkItem rxDoneWork_;
+    WorkItem txInitWork_;
+    WorkItem txDoneWork_;
+
+    std::atomic<uint32_t> events_;
+    uint8_t rxReadyBuffer_[RADIO_RX_PACKETS * sizeof(Packet*)];
+    CircularBuffer rxReady_;
+
+    RadioRxMode rxMode_;
+    PacketPool* rxPool_;
+    RadioRxQueue* rxQueue_;
+    RadioRxStats rxStats_;
+
+    uint32_t filter_;
+    uint16_t panId_;
+    uint16_t shortAddress_;
+    uint8_t extendedAddress_[8];
+
+    uint32_t sourceUsed_;
+    uint32_t sourceExtended_;
+    uint32_t sourcePending_;
+    uint8_t* sourceTable_;
+    uint32_t sourceUnits_;
+
+    bool csma_;
+    SemaphoreBinary csmaDone_;
+    RadioTxStats txStats_;
+
+    uint32_t dmaChannel_;
+    uint8_t* rxDmaBuffer_;
+    uint32_t rxDmaLength_;
 };
 
 #endif /* RADIO_H_ */
@@ -16,6 +16,7 @@
 
 #include "Callback.h"
 #include "Semaphore.h"
+#include "WorkQueue.h"
 
 class Gpio;
 struct UartConfig;
@@ -30,8 +31,8 @@ public:
     void enable(uint32_t baudrate = 0);
     void sleep(void);
     void wakeup(void);
-    void setRxCallback(Callback* callback);
-    void setTxCallback(Callback* callback);
+    void setRxCallback(Delegate callback, CallbackContext context = CallbackContext_Interrupt);
+    void setTxCallback(Delegate callback, CallbackContext context = CallbackContext_Interrupt);
     void enableInterrupts(void);
     void disableInterrupts(void);
     void rxLock(void);
@@ -42,13 +43,18 @@ public:
     void txUnlockFromInterrupt(void);
     uint8_t readByte(void);
     uint32_t readByte(uint8_t* buffer, uint32_t length);
+    uint32_t readFifo(uint8_t* buffer, uint32_t length);
+    bool readDma(uint8_t* buffer, uint32_t length);
+    uint32_t getDmaRxCount(void);
     void writeByte(uint8_t byte);
     uint32_t writeByte(uint8_t* buffer, uint32_t length);
+    bool writeDma(uint8_t* buffer, uint32_t length);
 protected:
     UartConfig& getConfig(void);
     void interruptHandler(void);
 private:
     void interruptHandlerRx(void);
+    void interruptHandlerRxDma(void);
     void interruptHandlerTx(void);
 private:
     Gpio& rx_;
@@ -58,8 +64,16 @@ private:
     SemaphoreBinary rxSemaphore_;
     SemaphoreBinary txSemaphore_;
 
-    Callback* rx_callback_;
-    Callback* tx_callback_;
+    Delegate rx_callback_;
+    Delegate tx_callback_;
+
+    WorkItem rxWork_;
+    WorkItem txWork_;
+
+    uint8_t* rxDmaBuffer_;
+    uint32_t rxDmaLength_;
+    uint32_t rxDmaCount_;
+    bool rxDmaAlternate_;
 };
 
 #endif /* UART_H_ */
@@ -26,7 +26,7 @@
 #define configMINIMAL_STACK_SIZE                ( ( unsigned short ) 64 )
 #define configTOTAL_HEAP_SIZE                   ( ( size_t ) ( 4 * 1024 ) )
 #define configMAX_TASK_NAME_LEN                 ( 16 )
-#define configUSE_TRACE_FACILITY                0
+#define configUSE_TRACE_FACILITY                1
 #define configUSE_16_BIT_TICKS                  0
 #define configIDLE_SHOULD_YIELD                 1
 #define configUSE_MUTEXES                       1
@@ -37,6 +37,13 @@
 #define configUSE_APPLICATION_TASK_TAG          0
 #define configUSE_COUNTING_SEMAPHORES           1
 
+/* Run-time statistics, see Scheduler::getStats. The DWT cycle counter
+   counts them at the CPU clock, without taking up a timer. */
+#define configGENERATE_RUN_TIME_STATS           1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() do { ( *( volatile unsigned long * ) 0xE000EDFC ) |= ( 1UL << 24 ); \
+                                                     ( *( volatile unsigned long * ) 0xE0001000 ) |= ( 1UL << 0 ); } while( 0 )
+#define portGET_RUN_TIME_COUNTER_VALUE()        ( *( volatile unsigned long * ) 0xE0001004 )
+
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES                   0
 #define configMAX_CO_ROUTINE_PRIORITIES         ( 2 )
@@ -56,6 +63,7 @@
 #define INCLUDE_vTaskSuspend                    1
 #define INCLUDE_vTaskDelayUntil                 1
 #define INCLUDE_vTaskDelay                      1
+#define INCLUDE_uxTaskGetStackHighWaterMark     1
 
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
@@ -82,4 +90,10 @@
 #define configTICK_LOWEST_INTERRUPT_PRIORITY            ( configLIBRARY_LOWEST_INTERRUPT_PRIORITY << (8 - configPRIO_BITS) )
 #define configMAX_SYSCALL_INTERRUPT_PRIORITY            ( configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY << (8 - configPRIO_BITS) ) 
 
+/* Event tracer, see Trace.h, which also defines the kernel trace hooks */
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED                           0
+#endif
+#include "Trace.h"
+
 #endif /* FREERTOS_CONFIG_H */
@@ -23,6 +23,7 @@
 #include "I2c.h"
 #include "Radio.h"
 #include "Serial.h"
+#include "SerialMux.h"
 
 #include "Adxl346.h"
 #include "Tps62730.h"
@@ -30,6 +31,7 @@
 #include "Callback.h"
 #include "Scheduler.h"
 #include "Semaphore.h"
+#include "StatsService.h"
 #include "Task.h"
 
 /*================================ define ===================================*/
@@ -37,6 +39,11 @@
 #define GREEN_LED_TASK_PRIORITY             ( tskIDLE_PRIORITY + 0 )
 #define SENSOR_TASK_PRIORITY                ( tskIDLE_PRIORITY + 1 )
 #define CONCENTRATOR_TASK_PRIORITY          ( tskIDLE_PRIORITY + 1 )
+#define STATS_TASK_PRIORITY                 ( tskIDLE_PRIORITY + 1 )
+
+#define GREEN_LED_TASK_STACK                ( 128 )
+#define SENSOR_TASK_STACK                   ( 128 )
+#define STATS_TASK_STACK                    ( 128 )
 
 #define RADIO_CHANNEL                       ( 26 )
 #define RADIO_POWER                         ( 0xFF )
@@ -58,9 +65,10 @@
 
 /*=============================== prototypes ================================*/
 
-static void prvGreenLedTask(void *pvParameters);
-static void prvSensorTask(void *pvParameters);
+static void prvGreenLedTask(void);
+static void prvSensorTask(void);
 static void prvConcentratorTask(void *pvParameters);
+static void prvStatsTask(void);
 
 static void radioRxInitCallback(void);
 static void radioRxDoneCallback(void);
@@ -70,19 +78,26 @@ static void adxl346Callback(void);
 
 /*=============================== variables =================================*/
 
+static StaticTask<GREEN_LED_TASK_STACK, GREEN_LED_TASK_PRIORITY> greenLedTask("LedTask");
+static StaticTask<SENSOR_TASK_STACK, SENSOR_TASK_PRIORITY> sensorTask("Sensor");
+static StaticTask<STATS_TASK_STACK, STATS_TASK_PRIORITY> statsTask("Stats");
+
 static Serial serial(uart);
+static SerialMux serialMux(serial);
+static StatsService statsService(serialMux);
 
 static SemaphoreBinary rxSemaphore, txSemaphore;
 static SemaphoreBinary adxl346Semaphore(false);
 
-static PlainCallback radioRxInitCallback_{radioRxInitCallback};
-static PlainCallback radioRxDoneCallback_{radioRxDoneCallback};
-static PlainCallback radioTxInitCallback_{radioTxInitCallback};
-static PlainCallback radioTxDoneCallback_{radioTxDoneCallback};
+static Delegate radioRxInitCallback_ = Delegate::create<radioRxInitCallback>();
+static Delegate radioRxDoneCallback_ = Delegate::create<radioRxDoneCallback>();
+static Delegate radioTxInitCallback_ = Delegate::create<radioTxInitCallback>();
+static Delegate radioTxDoneCallback_ = Delegate::create<radioTxDoneCallback>();
 
 static PlainCallback adxl346Callback_{adxl346Callback};
 
 static uint8_t  radioBuffer[128];
+static uint8_t  radioDmaBuffer[RADIO_DMA_BUFFER_LENGTH];
 static uint8_t* radioBuffer_ptr;
 static uint8_t  radioBuffer_len;
 static int8_t  rssi;
@@ -96,30 +111,35 @@ int main(void) {
     tps62730.setBypass();
 
     // Create FreeRTOS tasks
-    xTaskCreate(prvGreenLedTask, (const char *) "LedTask", 128, NULL, GREEN_LED_TASK_PRIORITY, NULL);
-    xTaskCreate(prvSensorTask, (const char *) "Sensor", 128, NULL, SENSOR_TASK_PRIORITY, NULL);
+    greenLedTask.start(Delegate::create<prvGreenLedTask>());
+    sensorTask.start(Delegate::create<prvSensorTask>());
     // xTaskCreate(prvConcentratorTask, (const char *) "Concentrator", 128, NULL, CONCENTRATOR_TASK_PRIORITY, NULL);
 
+    // Answer the run-time statistics queries, the concentrator writes raw frames to the same serial port
+    statsTask.start(Delegate::create<prvStatsTask>());
+
     // Start the scheduler
     Scheduler::run();
 }
 
 /*================================ private ==================================*/
 
-static void prvGreenLedTask(void *pvParameters) {
+static void prvGreenLedTask(void) {
+    TickType_t wakeTime = Task::getTicks();
+
     // Forever
     while (true) {
         // Turn off the green LED and keep it for 950 ms
         led_green.off();
-        Task::delay(950);
+        Task::delayUntil(wakeTime, 950);
 
         // Turn on the green LED and keep it for 50 ms
         led_green.on();
-        Task::delay(50);
+        Task::delayUntil(wakeTime, 50);
     }
 }
 
-static void prvSensorTask(void *pvParameters) {
+static void prvSensorTask(void) {
     uint8_t buffer[6];
     uint8_t counter;
 
@@ -139,10 +159,16 @@ static void prvSensorTask(void *pvParameters) {
     radio.setChannel(RADIO_CHANNEL);
     radio.setPower(RADIO_POWER);
 
+    // Back off with CSMA-CA, as all the sensors share the channel
+    radio.enableCsma();
+
     // Set Radio receive callbacks
-    radio.setTxCallbacks(&radioTxInitCallback_, &radioTxDoneCallback_);
+    radio.setTxCallbacks(radioTxInitCallback_, radioTxDoneCallback_);
     radio.enableInterrupts();
 
+    // Load the packets to the radio with the uDMA
+    radio.enableDma();
+
     // Calibrate the ADXL346 sensor
     // adxl346.calibrate();
 
@@ -179,7 +205,11 @@ static void prvSensorTask(void *pvParameters) {
             // Turn radio on, load packet and fire
             radio.on();
             radio.loadPacket(radioBuffer, counter);
-            radio.transmit();
+
+            // Drop the packet if the channel stays busy, no TX done follows
+            if (radio.transmit() != RadioResult_Success) {
+                txSemaphore.give();
+            }
         }
     }
 }
@@ -197,9 +227,12 @@ static void prvConcentratorTask(void *pvParameters) {
     radio.setChannel(RADIO_CHANNEL);
 
     // Set Radio receive callbacks
-    radio.setRxCallbacks(&radioRxInitCallback_, &radioRxDoneCallback_);
+    radio.setRxCallbacks(radioRxInitCallback_, radioRxDoneCallback_);
     radio.enableInterrupts();
 
+    // Move the received packets from the radio with the uDMA
+    radio.enableDma(radioDmaBuffer, sizeof(radioDmaBuffer));
+
     // Init the serial
     serial.init();
 
@@ -228,6 +261,21 @@ static void prvConcentratorTask(void *pvParameters) {
     }
 }
 
+static void prvStatsTask(void) {
+    // Enable the UART peripheral
+    uart.enable(UART_BAUDRATE);
+
+    // Init the serial and register on the stats channel
+    serial.init();
+    statsService.init();
+
+    // Forever
+    while (true) {
+        // This call blocks until a frame is received
+        serialMux.dispatch();
+    }
+}
+
 static void adxl346Callback(void) {
     adxl346Semaphore.giveFromInterrupt();
 }
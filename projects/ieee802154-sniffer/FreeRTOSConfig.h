@@ -82,4 +82,10 @@
 #define configTICK_LOWEST_INTERRUPT_PRIORITY            ( configLIBRARY_LOWEST_INTERRUPT_PRIORITY << (8 - configPRIO_BITS) )
 #define configMAX_SYSCALL_INTERRUPT_PRIORITY 	        ( configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY << (8 - configPRIO_BITS) ) 
 
+/* Event tracer, see Trace.h, which also defines the kernel trace hooks */
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED                           0
+#endif
+#include "Trace.h"
+
 #endif /* FREERTOS_CONFIG_H */
@@ -26,8 +26,10 @@
 #include "Ethernet.h"
 
 #include "Callback.h"
+#include "Packet.h"
 #include "Scheduler.h"
 #include "Task.h"
+#include "Trace.h"
 
 #include "SnifferEthernet.h"
 #include "SnifferSerial.h"
@@ -38,31 +40,45 @@
 #define SERIAL_TASK_PRIORITY                ( tskIDLE_PRIORITY + 1 )
 #define SNIFFER_TASK_PRIORITY               ( tskIDLE_PRIORITY + 2 )
 
+#define GREEN_LED_TASK_STACK                ( 128 )
+#define SERIAL_TASK_STACK                   ( 128 )
+#define SNIFFER_TASK_STACK                  ( 128 )
+
 #define SNIFFER_DEFAULT_CHANNEL             ( 26 )
 #define SERIAL_CHANGE_CHANNEL_CMD           ( 0xCC )
+#define SERIAL_TRACE_DUMP_CMD               ( 0xDD )
 
 #define SNIFFER_ETHERNET                    ( 0 )
 #define SNIFFER_SERIAL                      ( 1 )
 
 #define SNIFFER_TYPE                        ( SNIFFER_SERIAL )
 
+#define SNIFFER_PACKETS                     ( 4 )
+
 /*================================ typedef ==================================*/
 
 /*=============================== prototypes ================================*/
 
-static void prvGreenLedTask(void *pvParameters);
-static void prvSnifferTask(void *pvParameters);
-static void prvSerialTask(void *pvParamters);
+static void prvGreenLedTask(void);
+static void prvSnifferTask(void);
+static void prvSerialTask(void);
 
 /*=============================== variables =================================*/
 
+static StaticTask<GREEN_LED_TASK_STACK, GREEN_LED_TASK_PRIORITY> greenLedTask("LedTask");
+static StaticTask<SNIFFER_TASK_STACK, SNIFFER_TASK_PRIORITY> snifferTask("SnifferTask");
+static StaticTask<SERIAL_TASK_STACK, SERIAL_TASK_PRIORITY> serialTask("SerialTask");
+
 static Serial serial(uart);
 static Ethernet ethernet(enc28j60);
 
+static Packet packets[SNIFFER_PACKETS];
+static PacketPool pool(packets, SNIFFER_PACKETS);
+
 #if (SNIFFER_TYPE == SNIFFER_SERIAL)
-static SnifferSerial   sniffer(board, radio, serial);
+static SnifferSerial   sniffer(board, radio, pool, serial);
 #elif  (SNIFFER_TYPE == SNIFFER_ETHERNET)
-static SnifferEthernet sniffer(board, radio, ethernet);
+static SnifferEthernet sniffer(board, radio, pool, ethernet);
 #else
 #error "SNIFFER_TYPE not defined or not valid!"
 #endif
@@ -87,17 +103,22 @@ int main(void)
     // Enable the UART peripheral
     uart.enable();
 
-    // Init the serial
-    serial.init();
+    // Init the serial, draining the UART from the work queue daemon
+    serial.init(CallbackContext_Deferred);
+
+#if (TRACE_ENABLED == 1)
+    // Start recording events, the SerialTask dumps them on request
+    Trace::start();
+#endif
 
     // Create the blink task
-    xTaskCreate(prvGreenLedTask, (const char *) "LedTask", 128, NULL, GREEN_LED_TASK_PRIORITY, NULL);
+    greenLedTask.start(Delegate::create<prvGreenLedTask>());
 
     // Create the sniffer task to process packets
-    xTaskCreate(prvSnifferTask, (const char *) "SnifferTask", 128, NULL, SNIFFER_TASK_PRIORITY, NULL);
+    snifferTask.start(Delegate::create<prvSnifferTask>());
 
     // Create the serial task to receive commands
-    xTaskCreate(prvSerialTask, (const char *) "SerialTask", 128, NULL, SERIAL_TASK_PRIORITY, NULL);
+    serialTask.start(Delegate::create<prvSerialTask>());
 
     // Start the scheduler
     Scheduler::run();
@@ -105,22 +126,24 @@ int main(void)
 
 /*================================ private ==================================*/
 
-static void prvGreenLedTask(void *pvParameters)
+static void prvGreenLedTask(void)
 {
+    TickType_t wakeTime = Task::getTicks();
+
     // Forever
     while (true)
     {
         // Turn off the green LED and keep it for 950 ms
         led_green.off();
-        Task::delay(950);
+        Task::delayUntil(wakeTime, 950);
 
         // Turn on the green LED and keep it for 50 ms
         led_green.on();
-        Task::delay(50);
+        Task::delayUntil(wakeTime, 50);
     }
 }
 
-static void prvSerialTask(void *pvParamters)
+static void prvSerialTask(void)
 {
     while (true)
     {
@@ -137,6 +160,10 @@ static void prvSerialTask(void *pvParamters)
             sniffer_command = serial_buffer[0];
             sniffer_channel = serial_buffer[1];
         }
+        else if (serial_buffer_len == 1)
+        {
+            sniffer_command = serial_buffer[0];
+        }
 
         // Check if the received command is valid
         if (sniffer_command == SERIAL_CHANGE_CHANNEL_CMD) {
@@ -149,6 +176,14 @@ static void prvSerialTask(void *pvParamters)
             // Re-start the sniffer
             sniffer.start();
         }
+#if (TRACE_ENABLED == 1)
+        else if (sniffer_command == SERIAL_TRACE_DUMP_CMD)
+        {
+            // Send the recorded events and start recording again
+            Trace::dump(serial);
+            Trace::start();
+        }
+#endif
 
         // Reset the sniffer command and channel
         sniffer_command = 0x00;
@@ -156,7 +191,7 @@ static void prvSerialTask(void *pvParamters)
     }
 }
 
-static void prvSnifferTask(void *pvParameters)
+static void prvSnifferTask(void)
 {
     // Initialize the sniffer
     sniffer.init();
@@ -164,12 +199,12 @@ static void prvSnifferTask(void *pvParameters)
     // Set the default sniffer channel
     sniffer.setChannel(SNIFFER_DEFAULT_CHANNEL);
 
+    // Start the sniffer, which keeps receiving from then on
+    sniffer.start();
+
     while (true)
     {
-        // Start the sniffer
-        sniffer.start();
-
-        // Process a frame
+        // Process the frames received
         sniffer.processRadioFrame();
     }
 }
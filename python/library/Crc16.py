@@ -53,6 +53,14 @@ class Crc16(object):
     def push(self, byte):    
         tbl_idx = ((self.crc >> 8) ^ ord(byte)) & 0xFF;
         self.crc = (self.__crc16_table[tbl_idx] ^ (self.crc << 8)) & 0xFFFF;
+
+    def update(self, data):
+        # Fold a whole buffer with local lookups, avoiding a call per byte
+        table = self.__crc16_table
+        crc = self.crc
+        for byte in bytearray(data):
+            crc = (table[((crc >> 8) ^ byte) & 0xFF] ^ (crc << 8)) & 0xFFFF
+        self.crc = crc
     
     def check(self):
         return (self.crc == 0)
@@ -34,8 +34,7 @@ class Hdlc(object):
         
         # Check the CRC checksum
         crc_engine = Crc16.Crc16()
-        for o in output:
-            crc_engine.push(o)
+        crc_engine.update(output)
         crc_result = crc_engine.get()
         
         # Append the CRC checksum
@@ -74,8 +73,7 @@ class Hdlc(object):
         
         # Compute the CRC checksum
         crc_engine = Crc16.Crc16()
-        for o in output[:-2]:
-            crc_engine.push(o)
+        crc_engine.update(output[:-2])
         crc_result = crc_engine.get()
         
         # Check CRC checksum
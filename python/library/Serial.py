@@ -11,6 +11,7 @@
 
 # Import Python libraries
 import serial
+import struct
 import threading
 import time
 import logging
@@ -224,4 +225,95 @@ class Serial(threading.Thread):
         self.transmit_message = message
 
         # Release the transmit condition
-        self.transmit_condition.release()
\ No newline at end of file
+        self.transmit_condition.release()
+
+class SerialMux(object):
+    
+    # Channels, as in library/utils/SerialMux.h
+    CHANNEL_DATA    = 0
+    CHANNEL_COMMAND = 1
+    CHANNEL_LOG     = 2
+    CHANNEL_STATS   = 3
+    CHANNEL_COUNT   = 8
+    
+    # Flags, their meaning is up to each channel
+    FLAG_NONE     = 0x00
+    FLAG_REQUEST  = 0x01
+    FLAG_RESPONSE = 0x02
+    FLAG_ERROR    = 0x04
+    
+    # Channel, sequence number and flags in front of the payload
+    HEADER_FORMAT = 'BBB'
+    HEADER_LENGTH = struct.calcsize(HEADER_FORMAT)
+    
+    def __init__(self, serial = None):
+        assert serial != None, logger.error("Serial object not defined.")
+        
+        self.serial = serial
+        
+        # Handlers are called as handler(channel, sequence, flags, payload)
+        self.handlers = {}
+        
+        # Sequence numbers run per channel in each direction
+        self.tx_sequence = [0] * self.CHANNEL_COUNT
+        self.rx_sequence = {}
+        
+        # Receive statistics
+        self.rx_dropped = 0
+        self.rx_lost    = 0
+    
+    # Registers the handler of a channel, or removes it with None
+    def register(self, channel, handler):
+        assert channel < self.CHANNEL_COUNT, logger.error("Channel %d not valid.", channel)
+        
+        if (handler == None):
+            self.handlers.pop(channel, None)
+        else:
+            self.handlers[channel] = handler
+    
+    # Transmit a message on a channel
+    def transmit(self, channel, message, flags = FLAG_NONE):
+        assert channel < self.CHANNEL_COUNT, logger.error("Channel %d not valid.", channel)
+        
+        # Build the header and take the next sequence number
+        header = struct.pack(self.HEADER_FORMAT, channel, self.tx_sequence[channel], flags)
+        self.tx_sequence[channel] = (self.tx_sequence[channel] + 1) & 0xFF
+        
+        self.serial.transmit(header + message)
+    
+    # Receive a message and hand it to the handler of its channel
+    def dispatch(self):
+        # Try to receive a message with timeout
+        (status, message, length) = self.serial.receive()
+        
+        if (message == None):
+            return status
+        
+        # Drop the messages that are too short to carry a header
+        if (length < self.HEADER_LENGTH):
+            logger.warning('dispatch: Dropped a message with %d bytes.', length)
+            self.rx_dropped += 1
+            return status
+        
+        (channel, sequence, flags) = struct.unpack(self.HEADER_FORMAT, message[:self.HEADER_LENGTH])
+        payload = message[self.HEADER_LENGTH:]
+        
+        # Drop the messages for channels without a handler
+        handler = self.handlers.get(channel)
+        if (handler == None):
+            logger.warning('dispatch: Dropped a message for channel %d.', channel)
+            self.rx_dropped += 1
+            return status
+        
+        # Count the messages missed since the last one on the channel
+        expected = self.rx_sequence.get(channel)
+        if (expected != None and sequence != expected):
+            logger.warning('dispatch: Missed %d messages on channel %d.', (sequence - expected) & 0xFF, channel)
+            self.rx_lost += (sequence - expected) & 0xFF
+        
+        self.rx_sequence[channel] = (sequence + 1) & 0xFF
+        
+        # Hand the message to the channel handler
+        handler(channel, sequence, flags, payload)
+        
+        return status
@@ -0,0 +1,143 @@
+'''
+@file       Stats.py
+@author     Pere Tuset-Peiro  (peretuset@openmote.com)
+@version    v0.1
+@date       May, 2016
+@brief      Queries and decodes the run-time statistics of library/utils/StatsService.cpp.
+
+@copyright  Copyright 2015, OpenMote Technologies, S.L.
+            This file is licensed under the GNU General Public License v2.
+'''
+
+# Import Python libraries
+import struct
+import sys
+import time
+import logging
+
+# Import logging configuration
+logger = logging.getLogger(__name__)
+
+class Stats(object):
+    
+    # Report layout, as in library/utils/Scheduler.cpp, names of 12
+    # characters are not NUL-terminated
+    VERSION       = 2
+    HEADER_FORMAT = '<BBBIIIIIII'
+    TASK_FORMAT   = '<BBBHHI12s'
+    
+    # Task states, as eTaskState in the FreeRTOS task.h
+    STATES = ['Running', 'Ready', 'Blocked', 'Suspended', 'Deleted']
+    
+    def __init__(self):
+        self.ticks     = 0
+        self.run_time  = 0
+        self.clock_hz  = 0
+        self.heap_size = 0
+        self.heap_free = 0
+        self.heap_minimum = 0
+        self.heap_largest = 0
+        self.task_count = 0
+        self.tasks     = []
+    
+    # Decodes a report, returns False if it is malformed
+    def decode(self, report):
+        report = bytes(bytearray(report))
+        header_length = struct.calcsize(self.HEADER_FORMAT)
+        task_length   = struct.calcsize(self.TASK_FORMAT)
+        
+        if (len(report) < header_length):
+            logger.error('decode: Report too short, %d bytes.', len(report))
+            return False
+        
+        (version, self.task_count, tasks, self.ticks, self.run_time, self.clock_hz,
+         self.heap_size, self.heap_free, self.heap_minimum, self.heap_largest) = \
+            struct.unpack_from(self.HEADER_FORMAT, report)
+        
+        if (version != self.VERSION or len(report) != header_length + tasks * task_length):
+            logger.error('decode: Unknown report, version %d.', version)
+            return False
+        
+        self.tasks = []
+        for i in range(tasks):
+            (number, priority, state, load, stack_free, run_time, name) = \
+                struct.unpack_from(self.TASK_FORMAT, report, header_length + i * task_length)
+            name = name.split(b'\x00')[0].decode('ascii', 'replace')
+            self.tasks.append({'number' : number, 'priority' : priority, 'state' : state,
+                               'load' : load / 10.0, 'stack_free' : stack_free,
+                               'run_time' : run_time, 'name' : name})
+        
+        return True
+    
+    # Returns the report as lines of text
+    def get_table(self):
+        lines = []
+        
+        if (self.clock_hz > 0):
+            window = self.run_time * 1000.0 / self.clock_hz
+        else:
+            window = 0.0
+        
+        lines.append('Tick %d, %.1f ms since the previous query, heap %d of %d bytes free' %
+                     (self.ticks, window, self.heap_free, self.heap_size))
+        lines.append('Heap largest free block %d bytes, lowest free %d bytes' %
+                     (self.heap_largest, self.heap_minimum))
+        
+        if (len(self.tasks) != self.task_count):
+            lines.append('Only %d of %d tasks reported' % (len(self.tasks), self.task_count))
+        
+        lines.append('%3s %-12s %4s %-9s %7s %10s' % ('#', 'Task', 'Prio', 'State', 'CPU', 'Free stack'))
+        
+        for task in sorted(self.tasks, key = lambda task: task['number']):
+            state = self.STATES[task['state']] if (task['state'] < len(self.STATES)) else '?'
+            lines.append('%3d %-12s %4d %-9s %6.1f%% %5d words' %
+                         (task['number'], task['name'], task['priority'], state,
+                          task['load'], task['stack_free']))
+        
+        return lines
+
+# Queries the statistics periodically and prints them
+def main(argv):
+    # Import OpenMote libraries
+    from Serial import Serial, SerialMux
+    
+    if (len(argv) < 2):
+        print('Usage: %s <serial_port> [baud_rate] [period_s]' % argv[0])
+        return 1
+    
+    serial_name = argv[1]
+    baud_rate   = int(argv[2]) if (len(argv) > 2) else 576000
+    period      = float(argv[3]) if (len(argv) > 3) else 2.0
+    
+    serial = Serial(serial_name = serial_name, baud_rate = baud_rate, bsl_mode = "false")
+    serial.start()
+    
+    mux   = SerialMux(serial)
+    stats = Stats()
+    
+    def receive(channel, sequence, flags, payload):
+        if (flags & SerialMux.FLAG_ERROR):
+            print('The report did not fit')
+        elif (stats.decode(payload)):
+            print('\n'.join(stats.get_table()) + '\n')
+    
+    mux.register(SerialMux.CHANNEL_STATS, receive)
+    
+    try:
+        while (True):
+            # Request a report, the answer comes on the stats channel
+            mux.transmit(SerialMux.CHANNEL_STATS, b'', SerialMux.FLAG_REQUEST)
+            
+            deadline = time.time() + period
+            while (time.time() < deadline):
+                if (mux.dispatch()):
+                    return 0
+    except KeyboardInterrupt:
+        pass
+    finally:
+        serial.stop()
+    
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,219 @@
+'''
+@file       Trace.py
+@author     Pere Tuset-Peiro  (peretuset@openmote.com)
+@version    v0.1
+@date       May, 2016
+@brief      Decodes the event trace dumped by library/utils/Trace.cpp.
+
+@copyright  Copyright 2015, OpenMote Technologies, S.L.
+            This file is licensed under the GNU General Public License v2.
+'''
+
+# Import Python libraries
+import struct
+import sys
+import logging
+
+# Import logging configuration
+logger = logging.getLogger(__name__)
+
+class Trace(object):
+    
+    # Frame types, as in library/utils/Trace.cpp
+    FRAME_HEADER  = 0xE0
+    FRAME_TASKS   = 0xE1
+    FRAME_RECORDS = 0xE2
+    FRAME_END     = 0xE3
+    
+    VERSION = 1
+    
+    HEADER_FORMAT = '<B2sBBBHIIIH'
+    TASK_FORMAT   = '<HB12s'
+    RECORD_FORMAT = '<IBBH'
+    
+    # Events, as in library/utils/Trace.h
+    EVENTS = {
+        0x00 : 'Start',
+        0x01 : 'Stop',
+        0x10 : 'TaskCreate',
+        0x11 : 'TaskSwitchedIn',
+        0x12 : 'TaskSwitchedOut',
+        0x18 : 'QueueSend',
+        0x19 : 'QueueSendFailed',
+        0x1A : 'QueueSendFromIsr',
+        0x1B : 'QueueSendFromIsrFailed',
+        0x1C : 'QueueReceive',
+        0x1D : 'QueueReceiveFailed',
+        0x1E : 'QueueReceiveFromIsr',
+        0x1F : 'QueueBlockingSend',
+        0x20 : 'QueueBlockingReceive',
+        0x30 : 'IsrEnter',
+        0x31 : 'IsrExit',
+        0x40 : 'RadioSfd',
+        0x41 : 'RadioRxDone',
+        0x42 : 'RadioTxDone',
+        0x43 : 'RadioFifop',
+        0x44 : 'RadioError',
+        0x45 : 'RadioDma',
+        0x46 : 'RadioBusy',
+        0x48 : 'UartRx',
+        0x49 : 'UartRxDma',
+        0x4A : 'UartTx',
+        0x50 : 'I2cStart',
+        0x51 : 'I2cDone',
+        0x52 : 'I2cTimeout'
+    }
+    
+    # Events whose argument identifies a task
+    TASK_EVENTS = [0x10, 0x11, 0x12]
+    
+    def __init__(self):
+        self.reset()
+    
+    def reset(self):
+        self.clock_hz = None
+        self.count    = 0
+        self.first    = 0
+        self.overhead = 0
+        self.tasks    = {}
+        self.records  = {}
+        self.complete = False
+    
+    # Decodes a dump frame, returns True once the end frame is decoded
+    def decode(self, frame):
+        frame = bytearray(frame)
+        
+        if (len(frame) == 0):
+            return self.complete
+        
+        kind = frame[0]
+        
+        if (kind == self.FRAME_HEADER):
+            (kind, magic, version, record_length, tasks, length, self.clock_hz,
+             self.count, self.first, self.overhead) = struct.unpack_from(self.HEADER_FORMAT, bytes(frame))
+            
+            if (magic != b'TR' or version != self.VERSION):
+                logger.error('decode: Unknown trace header, version %d.', version)
+                raise ValueError('Unknown trace header')
+            
+            self.tasks    = {}
+            self.records  = {}
+            self.complete = False
+            
+        elif (kind == self.FRAME_TASKS):
+            size = struct.calcsize(self.TASK_FORMAT)
+            for i in range(frame[1]):
+                (task, priority, name) = struct.unpack_from(self.TASK_FORMAT, bytes(frame), 2 + i * size)
+                name = name.split(b'\x00')[0].decode('ascii', 'replace')
+                self.tasks[task] = (name, priority)
+            
+        elif (kind == self.FRAME_RECORDS):
+            (index,) = struct.unpack_from('<I', bytes(frame), 1)
+            size = struct.calcsize(self.RECORD_FORMAT)
+            for offset in range(5, len(frame) - size + 1, size):
+                self.records[index] = struct.unpack_from(self.RECORD_FORMAT, bytes(frame), offset)
+                index += 1
+            
+        elif (kind == self.FRAME_END):
+            if (len(self.records) != self.count - self.first):
+                logger.warning('decode: Got %d out of %d records.', len(self.records), self.count - self.first)
+            self.complete = True
+            
+        else:
+            logger.warning('decode: Dropped a frame of type 0x%02X.', kind)
+        
+        return self.complete
+    
+    # Returns the records as (cycles, event, id, arg) with the timestamps
+    # unwrapped, sorted by time
+    def get_events(self):
+        events = []
+        cycles = 0
+        last   = None
+        
+        for index in sorted(self.records.keys()):
+            (timestamp, event, id, arg) = self.records[index]
+            
+            # Records are written in order, so each delta is small and may
+            # only be negative when a record preempted the previous one
+            if (last != None):
+                delta = (timestamp - last) & 0xFFFFFFFF
+                if (delta >= 0x80000000):
+                    delta -= 0x100000000
+                cycles += delta
+            last = timestamp
+            
+            events.append((cycles, event, id, arg))
+        
+        return sorted(events, key = lambda event: event[0])
+    
+    def get_name(self, event):
+        if (event >= 0x80):
+            return 'User+%d' % (event - 0x80)
+        return self.EVENTS.get(event, 'Unknown(0x%02X)' % event)
+    
+    # Returns the timeline as lines of text, in microseconds since the first
+    # record and since the previous one
+    def get_timeline(self):
+        lines  = []
+        events = self.get_events()
+        scale  = 1000000.0 / self.clock_hz
+        
+        lines.append('%d events, %d kept, %d cycles (%.3f us) per event' %
+                     (self.count, len(events), self.overhead, self.overhead * scale))
+        
+        if (not events):
+            return lines
+        
+        start    = events[0][0]
+        previous = start
+        
+        for (cycles, event, id, arg) in events:
+            detail = 'id=%3d arg=0x%04X' % (id, arg)
+            if (event in self.TASK_EVENTS and arg in self.tasks):
+                detail += ' (%s)' % self.tasks[arg][0]
+            
+            lines.append('%12.3f us %+10.3f us  %-22s %s' %
+                         ((cycles - start) * scale, (cycles - previous) * scale,
+                          self.get_name(event), detail))
+            previous = cycles
+        
+        return lines
+
+# Sends the dump command to the sniffer and prints the timeline
+def main(argv):
+    # Import OpenMote libraries
+    from Serial import Serial
+    
+    if (len(argv) < 2):
+        print('Usage: %s <serial_port> [baud_rate]' % argv[0])
+        return 1
+    
+    serial_name = argv[1]
+    baud_rate   = int(argv[2]) if (len(argv) > 2) else 115200
+    
+    serial = Serial(serial_name = serial_name, baud_rate = baud_rate, bsl_mode = "false")
+    serial.start()
+    
+    trace = Trace()
+    
+    # Request the dump, as SERIAL_TRACE_DUMP_CMD in ieee802154-sniffer
+    serial.transmit('\xDD')
+    
+    try:
+        while (True):
+            (status, message, length) = serial.receive()
+            if (status):
+                break
+            if (message != None and trace.decode(message)):
+                break
+    finally:
+        serial.stop()
+    
+    for line in trace.get_timeline():
+        print(line)
+    
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,312 @@
+/**
+ * @file       main.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host micro-benchmarks of the library/utils and library/ethernet
+ *             hot paths, reported in ns/byte and ns/frame.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "Buffer.h"
+#include "CircularBuffer.h"
+#include "Crc.h"
+#include "Crc16.h"
+#include "Hdlc.h"
+#include "MessageQueue.h"
+
+#include "Ethernet.h"
+#include "EthernetDevice.h"
+#include "EthernetFrame.h"
+
+/*================================ define ===================================*/
+
+#define BENCHMARK_RUNS                      ( 5 )
+#define BENCHMARK_FRAMES                    ( 10000 )
+
+#define RADIO_FRAME_LENGTH                  ( 127 )
+#define ETHERNET_FRAME_LENGTH               ( 1518 )
+
+/*================================ typedef ==================================*/
+
+// Hands every transmitted frame back on the next receive
+class LoopbackDevice : public EthernetDevice
+{
+public:
+    void init(uint8_t* mac_address) {setMacAddress(mac_address);}
+    void reset(void) {length_ = 0;}
+    void setCallback(Callback* callback_) {}
+    void clearCallback(void) {}
+    OperationResult transmitFrame(uint8_t* data, uint32_t length)
+    {
+        if (length > sizeof(frame_)) return ResultError;
+        memcpy(frame_, data, length);
+        length_ = length;
+        return ResultSuccess;
+    }
+    OperationResult receiveFrame(uint8_t* buffer, uint32_t* length)
+    {
+        if (length_ == 0) return ResultError;
+        memcpy(buffer, frame_, length_);
+        *length = length_;
+        length_ = 0;
+        return ResultSuccess;
+    }
+private:
+    uint8_t frame_[ETHERNET_FRAME_LENGTH];
+    uint32_t length_ = 0;
+};
+
+/*=============================== prototypes ================================*/
+
+template <typename T>
+static void measure(const char* name, uint32_t length, T function);
+
+/*=============================== variables =================================*/
+
+// Results are folded into the sink so that no benchmark is optimised out
+static volatile uint32_t sink;
+
+static FILE* output;
+
+static uint8_t radio_frame[RADIO_FRAME_LENGTH];
+static uint8_t ethernet_frame[ETHERNET_FRAME_LENGTH];
+
+static uint8_t buffer_storage[256];
+static uint8_t rx_storage[256];
+static uint8_t tx_storage[512];
+
+/*================================= public ==================================*/
+
+int main(int argc, char** argv)
+{
+    // Append the results to a CSV file, if any, for regression tracking
+    if (argc > 1)
+    {
+        output = fopen(argv[1], "a");
+        if (output == nullptr)
+        {
+            printf("Error: cannot open %s\n", argv[1]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    srand(0xBE4C);
+
+    for (uint32_t i = 0; i < sizeof(radio_frame); i++)
+    {
+        radio_frame[i] = (uint8_t) rand();
+    }
+
+    // An Ethernet frame followed by its FCS, least significant byte first
+    for (uint32_t i = 0; i < sizeof(ethernet_frame) - 4; i++)
+    {
+        ethernet_frame[i] = (uint8_t) rand();
+    }
+
+    uint32_t fcs = CrcEthernet::compute(ethernet_frame, sizeof(ethernet_frame) - 4);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        ethernet_frame[sizeof(ethernet_frame) - 4 + i] = (uint8_t) (fcs >> (8 * i));
+    }
+
+    printf("%-28s %10s %12s\n", "Benchmark", "ns/byte", "ns/frame");
+
+    // CRC engines
+    measure("crc16-set", RADIO_FRAME_LENGTH, []()
+    {
+        Crc16 crc;
+        for (uint32_t i = 0; i < RADIO_FRAME_LENGTH; i++)
+        {
+            crc.set(radio_frame[i]);
+        }
+        sink += crc.get();
+    });
+
+    measure("crc16-update", RADIO_FRAME_LENGTH, []()
+    {
+        sink += Crc16::compute(radio_frame, RADIO_FRAME_LENGTH);
+    });
+
+    measure("crc-ieee802154-update", RADIO_FRAME_LENGTH, []()
+    {
+        sink += CrcIeee802154::compute(radio_frame, RADIO_FRAME_LENGTH);
+    });
+
+    measure("crc-ethernet-update", ETHERNET_FRAME_LENGTH, []()
+    {
+        sink += CrcEthernet::compute(ethernet_frame, ETHERNET_FRAME_LENGTH);
+    });
+
+    // HDLC encoder and decoder, on a frame of radio length
+    CircularBuffer rxBuffer(rx_storage, sizeof(rx_storage));
+    CircularBuffer txBuffer(tx_storage, sizeof(tx_storage));
+    Hdlc hdlc(rxBuffer, txBuffer);
+    uint8_t encoded[2 * RADIO_FRAME_LENGTH + 6];
+    uint32_t encodedLength;
+
+    hdlc.txOpen();
+    hdlc.txPut(radio_frame, RADIO_FRAME_LENGTH);
+    hdlc.txClose();
+    encodedLength = txBuffer.getSize();
+    txBuffer.read(encoded, encodedLength);
+
+    measure("hdlc-encode", RADIO_FRAME_LENGTH, [&]()
+    {
+        hdlc.txOpen();
+        hdlc.txPut(radio_frame, RADIO_FRAME_LENGTH);
+        hdlc.txClose();
+        sink += txBuffer.getSize();
+        txBuffer.commitRead(txBuffer.getSize());
+    });
+
+    measure("hdlc-decode", RADIO_FRAME_LENGTH, [&]()
+    {
+        uint8_t decoded[RADIO_FRAME_LENGTH];
+
+        hdlc.rxOpen();
+        hdlc.rxPut(0x7E);
+        for (uint32_t i = 0; i < encodedLength; i++)
+        {
+            hdlc.rxPut(encoded[i]);
+        }
+        hdlc.rxClose();
+        sink += hdlc.rxRead(decoded, sizeof(decoded));
+    });
+
+    // Byte buffers, one frame written and read back one byte at a time
+    Buffer buffer(buffer_storage, sizeof(buffer_storage));
+    CircularBuffer circularBuffer(buffer_storage, sizeof(buffer_storage));
+    static MessageQueue<uint8_t, 128> queue;
+
+    measure("buffer-byte", RADIO_FRAME_LENGTH, [&]()
+    {
+        uint8_t byte = 0;
+        for (uint32_t i = 0; i < RADIO_FRAME_LENGTH; i++)
+        {
+            buffer.write(radio_frame[i]);
+        }
+        for (uint32_t i = 0; i < RADIO_FRAME_LENGTH; i++)
+        {
+            buffer.read(&byte);
+        }
+        buffer.reset();
+        sink += byte;
+    });
+
+    measure("messagequeue-byte", RADIO_FRAME_LENGTH, [&]()
+    {
+        uint8_t byte = 0;
+        for (uint32_t i = 0; i < RADIO_FRAME_LENGTH; i++)
+        {
+            queue.trySend(radio_frame[i]);
+        }
+        for (uint32_t i = 0; i < RADIO_FRAME_LENGTH; i++)
+        {
+            queue.tryReceive(byte);
+        }
+        sink += byte;
+    });
+
+    measure("circularbuffer-byte", RADIO_FRAME_LENGTH, [&]()
+    {
+        uint8_t byte = 0;
+        for (uint32_t i = 0; i < RADIO_FRAME_LENGTH; i++)
+        {
+            circularBuffer.write(radio_frame[i]);
+        }
+        for (uint32_t i = 0; i < RADIO_FRAME_LENGTH; i++)
+        {
+            circularBuffer.read(&byte);
+        }
+        sink += byte;
+    });
+
+    measure("circularbuffer-bulk", RADIO_FRAME_LENGTH, [&]()
+    {
+        uint8_t frame[RADIO_FRAME_LENGTH];
+        circularBuffer.write(radio_frame, RADIO_FRAME_LENGTH);
+        circularBuffer.read(frame, RADIO_FRAME_LENGTH);
+        sink += frame[0];
+    });
+
+    // Ethernet frames through a loopback device, checking the FCS
+    LoopbackDevice device;
+    Ethernet ethernet(device);
+    uint8_t mac_address[6] = {0x00, 0x12, 0x4B, 0x00, 0x00, 0x01};
+
+    ethernet.init(mac_address);
+
+    measure("ethernet-loopback", ETHERNET_FRAME_LENGTH, [&]()
+    {
+        static uint8_t frame[ETHERNET_FRAME_LENGTH];
+        uint32_t length = 0;
+
+        ethernet.transmitFrame(ethernet_frame, ETHERNET_FRAME_LENGTH);
+        ethernet.receiveFrame(frame, &length);
+
+        EthernetFrame ethernetFrame(frame, length);
+        sink += ethernetFrame.isValid();
+    });
+
+    if (output != nullptr)
+    {
+        fclose(output);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+/**
+ * Runs the function once per frame and reports the best of several runs,
+ * which is the least disturbed by the rest of the host.
+ */
+template <typename T>
+static void measure(const char* name, uint32_t length, T function)
+{
+    std::chrono::steady_clock::time_point start, end;
+    double best = 0;
+
+    for (uint32_t run = 0; run < BENCHMARK_RUNS; run++)
+    {
+        start = std::chrono::steady_clock::now();
+
+        for (uint32_t i = 0; i < BENCHMARK_FRAMES; i++)
+        {
+            function();
+        }
+
+        end = std::chrono::steady_clock::now();
+
+        std::chrono::duration<double, std::nano> elapsed = end - start;
+
+        if (run == 0 || elapsed.count() < best)
+        {
+            best = elapsed.count();
+        }
+    }
+
+    double frame = best / BENCHMARK_FRAMES;
+    double byte = frame / length;
+
+    printf("%-28s %10.3f %12.1f\n", name, byte, frame);
+
+    if (output != nullptr)
+    {
+        fprintf(output, "%s,%.3f,%.1f\n", name, byte, frame);
+    }
+}
@@ -0,0 +1,223 @@
+/**
+ * @file       main.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host test of the Delegate and cycle comparison against the
+ *             virtual Callback on the radio RX interrupt path.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "Callback.h"
+
+/*================================ define ===================================*/
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            printf("Error: %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+#define BENCHMARK_INTERRUPTS                ( 10000000 )
+
+// Hides where a pointer comes from, as a callback registered at run time
+#define OPAQUE(pointer)                     asm volatile("" : "+r" (pointer))
+
+/*================================ typedef ==================================*/
+
+// Plays the role of the sniffer, which is woken up by the radio
+class Receiver
+{
+public:
+    void rxDone(void) {count++;}
+    void rxFrame(uint32_t length) {count += length;}
+public:
+    uint32_t count = 0;
+};
+
+// Plays the role of Radio::interruptHandler on the end of frame event
+class RadioHost
+{
+public:
+    __attribute__((noinline)) void interruptHandlerCallback(void)
+    {
+        Callback* callback = rxDoneCallback_;
+        OPAQUE(callback);
+
+        if (callback != nullptr)
+        {
+            callback->execute();
+        }
+    }
+
+    __attribute__((noinline)) void interruptHandlerDelegate(void)
+    {
+        Delegate* delegate = &rxDoneDelegate_;
+        OPAQUE(delegate);
+
+        if (delegate->isValid())
+        {
+            delegate->execute();
+        }
+    }
+public:
+    Callback* rxDoneCallback_ = nullptr;
+    Delegate rxDoneDelegate_;
+};
+
+/*=============================== prototypes ================================*/
+
+static void plainFunction(void);
+static void plainFrame(uint32_t length);
+static bool testDelegate(void);
+static void benchmark(void);
+static uint64_t timestamp(void);
+
+/*=============================== variables =================================*/
+
+static uint32_t plainCount;
+
+/*================================= public ==================================*/
+
+int main(void)
+{
+    bool status = true;
+
+    status &= testDelegate();
+
+    if (!status)
+    {
+        return EXIT_FAILURE;
+    }
+
+    benchmark();
+
+    return EXIT_SUCCESS;
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+static void plainFunction(void)
+{
+    plainCount++;
+}
+
+static void plainFrame(uint32_t length)
+{
+    plainCount += length;
+}
+
+static bool testDelegate(void)
+{
+    Receiver receiver;
+    GenericCallback<Receiver> generic(&receiver, &Receiver::rxDone);
+    PlainCallback plain(plainFunction);
+    Delegate delegate;
+    BasicDelegate<uint32_t> frame;
+
+    // Empty delegates are not valid, also when made from no callback
+    CHECK(!delegate.isValid());
+    delegate = Delegate((Callback*) nullptr);
+    CHECK(!delegate.isValid());
+
+    // Member functions are called on their object
+    delegate = Delegate::create<Receiver, &Receiver::rxDone>(&receiver);
+    CHECK(delegate.isValid());
+    delegate.execute();
+    CHECK(receiver.count == 1);
+
+    // Plain functions are called directly
+    delegate = Delegate::create<plainFunction>();
+    delegate.execute();
+    CHECK(plainCount == 1);
+
+    // Existing callbacks can still be wrapped
+    delegate = Delegate(&generic);
+    delegate.execute();
+    CHECK(receiver.count == 2);
+
+    delegate = Delegate(&plain);
+    delegate.execute();
+    CHECK(plainCount == 2);
+
+    // Arguments are passed on to the target
+    CHECK(!frame.isValid());
+    frame = BasicDelegate<uint32_t>::create<Receiver, &Receiver::rxFrame>(&receiver);
+    frame.execute(10);
+    CHECK(receiver.count == 12);
+
+    frame = BasicDelegate<uint32_t>::create<plainFrame>();
+    frame.execute(10);
+    CHECK(plainCount == 12);
+
+    return true;
+}
+
+static void benchmark(void)
+{
+    Receiver receiver;
+    GenericCallback<Receiver> generic(&receiver, &Receiver::rxDone);
+    RadioHost radio;
+    uint64_t start, callback_cycles, bridge_cycles, delegate_cycles;
+
+    // Callback through its vtable and the pointer to member
+    radio.rxDoneCallback_ = &generic;
+    start = timestamp();
+    for (uint32_t i = 0; i < BENCHMARK_INTERRUPTS; i++)
+    {
+        radio.interruptHandlerCallback();
+    }
+    callback_cycles = timestamp() - start;
+
+    // The same callback wrapped in a delegate
+    radio.rxDoneDelegate_ = Delegate(&generic);
+    start = timestamp();
+    for (uint32_t i = 0; i < BENCHMARK_INTERRUPTS; i++)
+    {
+        radio.interruptHandlerDelegate();
+    }
+    bridge_cycles = timestamp() - start;
+
+    // Delegate straight to the member function
+    radio.rxDoneDelegate_ = Delegate::create<Receiver, &Receiver::rxDone>(&receiver);
+    start = timestamp();
+    for (uint32_t i = 0; i < BENCHMARK_INTERRUPTS; i++)
+    {
+        radio.interruptHandlerDelegate();
+    }
+    delegate_cycles = timestamp() - start;
+
+    printf("Callback (virtual):     %6.2f cycles/interrupt\n", (double) callback_cycles / BENCHMARK_INTERRUPTS);
+    printf("Delegate (Callback):    %6.2f cycles/interrupt\n", (double) bridge_cycles / BENCHMARK_INTERRUPTS);
+    printf("Delegate (member):      %6.2f cycles/interrupt\n", (double) delegate_cycles / BENCHMARK_INTERRUPTS);
+    printf("Dispatched %u interrupts\n", receiver.count);
+}
+
+static uint64_t timestamp(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    // Time-stamp counter ticks, close to core cycles on current CPUs
+    return __rdtsc();
+#else
+    // Fall back to nanoseconds where there is no cycle counter
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
@@ -0,0 +1,304 @@
+/**
+ * @file       main.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host test and benchmark of the CRC engine and its variants.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "Crc.h"
+#include "Crc16.h"
+
+/*================================ define ===================================*/
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            printf("Error: %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+#define TEST_VECTORS                        ( 100000 )
+#define TEST_VECTOR_LENGTH                  ( 300 )
+
+#define BENCHMARK_FRAME_LENGTH              ( 128 )
+#define BENCHMARK_FRAMES                    ( 200000 )
+
+/*================================ typedef ==================================*/
+
+/*=============================== prototypes ================================*/
+
+static bool testCheckValue(void);
+static bool testRandomVectors(void);
+static bool testIeee802154(void);
+static bool testEthernet(void);
+template <typename T>
+static bool testAgainstBitwise(T& crc, uint32_t polynomial, uint32_t seed, uint32_t xorOut, uint32_t width);
+static void benchmark(void);
+
+static uint64_t timestamp(void);
+
+/*=============================== variables =================================*/
+
+/*================================= public ==================================*/
+
+int main(void)
+{
+    bool status = true;
+
+    srand(0xC16);
+
+    printf("CRC16_SLICES = %d (%u bytes of tables)\n", CRC16_SLICES, CRC16_SLICES * 512);
+
+    status &= testCheckValue();
+    status &= testRandomVectors();
+    status &= testIeee802154();
+    status &= testEthernet();
+
+    if (!status)
+    {
+        return EXIT_FAILURE;
+    }
+
+    benchmark();
+
+    return EXIT_SUCCESS;
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+static bool testCheckValue(void)
+{
+    const uint8_t vector[9] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    Crc16 crc;
+
+    // Same vector as the test-crc firmware image
+    crc.init();
+    crc.update(vector, sizeof(vector));
+    CHECK(crc.get() == 0xE7A1);
+
+    // Appending the CRC must yield the check value
+    const uint8_t trailer[2] = {0xE7, 0xA1};
+    crc.update(trailer, sizeof(trailer));
+    CHECK(crc.check());
+
+    return true;
+}
+
+static bool testRandomVectors(void)
+{
+    uint8_t vector[TEST_VECTOR_LENGTH];
+    Crc16 reference, crc;
+
+    for (uint32_t i = 0; i < TEST_VECTORS; i++)
+    {
+        uint32_t length = rand() % TEST_VECTOR_LENGTH;
+        uint32_t split = (length > 0) ? rand() % length : 0;
+
+        for (uint32_t j = 0; j < length; j++)
+        {
+            vector[j] = (uint8_t) rand();
+        }
+
+        // Reference is the original byte-at-a-time table lookup
+        reference.init();
+        for (uint32_t j = 0; j < length; j++)
+        {
+            reference.set(vector[j]);
+        }
+
+        // Split the vector so that every alignment and tail is covered
+        crc.init();
+        crc.update(vector, split);
+        crc.update(&vector[split], length - split);
+
+        if (crc.get() != reference.get())
+        {
+            printf("Error: vector %u (length %u, split %u) gives 0x%04X, expected 0x%04X\n",
+                   i, length, split, crc.get(), reference.get());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool testIeee802154(void)
+{
+    const uint8_t vector[9] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    uint8_t frame[sizeof(vector) + 2];
+    CrcIeee802154 crc;
+    uint16_t fcs;
+
+    // CRC-16/KERMIT check value
+    fcs = CrcIeee802154::compute(vector, sizeof(vector));
+    CHECK(fcs == 0x2189);
+
+    // The FCS goes least significant byte first, as the radio appends it
+    memcpy(frame, vector, sizeof(vector));
+    frame[sizeof(vector) + 0] = (uint8_t) (fcs >> 0);
+    frame[sizeof(vector) + 1] = (uint8_t) (fcs >> 8);
+
+    crc.init();
+    crc.update(frame, sizeof(frame));
+    CHECK(crc.check());
+
+    // A corrupted frame must not check
+    frame[3] ^= 0x10;
+    crc.init();
+    crc.update(frame, sizeof(frame));
+    CHECK(!crc.check());
+
+    return testAgainstBitwise(crc, 0x8408, 0x0000, 0x0000, 16);
+}
+
+static bool testEthernet(void)
+{
+    const uint8_t vector[9] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    uint8_t frame[sizeof(vector) + 4];
+    CrcEthernet crc;
+    uint32_t fcs;
+
+    // CRC-32 check value
+    fcs = CrcEthernet::compute(vector, sizeof(vector));
+    CHECK(fcs == 0xCBF43926);
+
+    // The FCS goes least significant byte first and leaves the residue
+    memcpy(frame, vector, sizeof(vector));
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        frame[sizeof(vector) + i] = (uint8_t) (fcs >> (8 * i));
+    }
+
+    crc.init();
+    crc.update(frame, sizeof(frame));
+    CHECK(crc.check());
+
+    return testAgainstBitwise(crc, 0xEDB88320, 0xFFFFFFFF, 0xFFFFFFFF, 32);
+}
+
+template <typename T>
+static bool testAgainstBitwise(T& crc, uint32_t polynomial, uint32_t seed, uint32_t xorOut, uint32_t width)
+{
+    uint8_t vector[TEST_VECTOR_LENGTH];
+    uint32_t mask = (width == 32) ? 0xFFFFFFFF : ((1UL << width) - 1);
+
+    for (uint32_t i = 0; i < TEST_VECTORS / 10; i++)
+    {
+        uint32_t length = rand() % TEST_VECTOR_LENGTH;
+        uint32_t split = (length > 0) ? rand() % length : 0;
+        uint32_t reference = seed;
+
+        for (uint32_t j = 0; j < length; j++)
+        {
+            vector[j] = (uint8_t) rand();
+        }
+
+        // Reference is the textbook reflected bit-at-a-time division
+        for (uint32_t j = 0; j < length; j++)
+        {
+            reference ^= vector[j];
+            for (uint32_t k = 0; k < 8; k++)
+            {
+                reference = (reference & 1) ? ((reference >> 1) ^ polynomial) : (reference >> 1);
+            }
+        }
+        reference = (reference ^ xorOut) & mask;
+
+        crc.init();
+        crc.update(vector, split);
+        crc.update(&vector[split], length - split);
+
+        if (crc.get() != reference)
+        {
+            printf("Error: vector %u (length %u, split %u) gives 0x%08X, expected 0x%08X\n",
+                   i, length, split, (uint32_t) crc.get(), reference);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void benchmark(void)
+{
+    static uint8_t frame[BENCHMARK_FRAME_LENGTH];
+    volatile uint16_t sink;
+    volatile uint32_t sink32;
+    uint64_t start, set_cycles, update_cycles, ethernet_cycles;
+    Crc16 crc;
+
+    for (uint32_t i = 0; i < sizeof(frame); i++)
+    {
+        frame[i] = (uint8_t) rand();
+    }
+
+    // Byte at a time, as Hdlc used to call it
+    start = timestamp();
+    for (uint32_t i = 0; i < BENCHMARK_FRAMES; i++)
+    {
+        crc.init();
+        for (uint32_t j = 0; j < sizeof(frame); j++)
+        {
+            crc.set(frame[j]);
+        }
+        sink = crc.get();
+    }
+    set_cycles = timestamp() - start;
+
+    // Whole frame at once
+    start = timestamp();
+    for (uint32_t i = 0; i < BENCHMARK_FRAMES; i++)
+    {
+        crc.init();
+        crc.update(frame, sizeof(frame));
+        sink = crc.get();
+    }
+    update_cycles = timestamp() - start;
+
+    (void) sink;
+
+    // Ethernet FCS through the same kernel
+    start = timestamp();
+    for (uint32_t i = 0; i < BENCHMARK_FRAMES; i++)
+    {
+        sink32 = CrcEthernet::compute(frame, sizeof(frame));
+    }
+    ethernet_cycles = timestamp() - start;
+
+    (void) sink32;
+
+    printf("Crc16::set:         %6.2f cycles/byte\n", (double) set_cycles / (BENCHMARK_FRAMES * sizeof(frame)));
+    printf("Crc16::update:      %6.2f cycles/byte\n", (double) update_cycles / (BENCHMARK_FRAMES * sizeof(frame)));
+    printf("CrcEthernet:        %6.2f cycles/byte\n", (double) ethernet_cycles / (BENCHMARK_FRAMES * sizeof(frame)));
+}
+
+static uint64_t timestamp(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    // Time-stamp counter ticks, close to core cycles on current CPUs
+    return __rdtsc();
+#else
+    // Fall back to nanoseconds where there is no cycle counter
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
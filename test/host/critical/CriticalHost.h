@@ -0,0 +1,41 @@
+/**
+ * @file       CriticalHost.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host stand-ins for the Cortex-M3 interrupt masks and the
+ *             cycle counter that CriticalSection uses.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef CRITICAL_HOST_H_
+#define CRITICAL_HOST_H_
+
+#include <stdint.h>
+
+// PRIMASK, BASEPRI and the DWT cycle counter
+extern uint32_t hostPrimask;
+extern uint32_t hostBasepri;
+extern uint32_t hostCycles;
+
+#define getPrimask(lock)                    do { (lock) = hostPrimask; } while (0)
+#define setPrimask(lock)                    do { hostPrimask = (lock) & 1; } while (0)
+#define disableInterrupts()                 do { hostPrimask = 1; } while (0)
+#define getBasepri(lock)                    do { (lock) = hostBasepri; } while (0)
+#define setBasepri(lock)                    do { hostBasepri = (lock) & 0xE0; } while (0)
+
+// BASEPRI_MAX only writes a value that masks more than the current one
+#define raiseBasepri(priority)                                              \
+    do {                                                                    \
+        uint32_t value = (priority) & 0xE0;                                 \
+        if (value != 0 && (hostBasepri == 0 || value < hostBasepri)) {      \
+            hostBasepri = value;                                            \
+        }                                                                   \
+    } while (0)
+
+#define CRITICAL_SECTION_TIMESTAMP()        ( hostCycles )
+#define CRITICAL_SECTION_TIMESTAMP_START()  do { hostCycles = 0; } while (0)
+
+#endif /* CRITICAL_HOST_H_ */
@@ -0,0 +1,164 @@
+/**
+ * @file       main.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host test of the CriticalSection masks, nesting and timing.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "CriticalSection.h"
+
+/*================================ define ===================================*/
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            printf("Error: %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+#define TEST_PRIORITY_HIGH                  ( 2 << 5 )
+#define TEST_PRIORITY_LOW                   ( 6 << 5 )
+
+/*=============================== prototypes ================================*/
+
+static bool testMask(void);
+static bool testNesting(void);
+static bool testStats(void);
+
+/*=============================== variables =================================*/
+
+uint32_t hostPrimask;
+uint32_t hostBasepri;
+uint32_t hostCycles;
+
+/*================================= public ==================================*/
+
+int main(void)
+{
+    bool status = true;
+
+    status &= testMask();
+    status &= testNesting();
+    status &= testStats();
+
+    return (status ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+static bool testMask(void)
+{
+    // By default only BASEPRI is raised, to the kernel level
+    {
+        CriticalSection section;
+        CHECK(hostBasepri == configMAX_SYSCALL_INTERRUPT_PRIORITY);
+        CHECK(hostPrimask == 0);
+    }
+    CHECK(hostBasepri == 0 && hostPrimask == 0);
+
+    // Priority 0 masks everything through PRIMASK
+    {
+        CriticalSection section(CRITICAL_SECTION_ALL);
+        CHECK(hostPrimask == 1);
+        CHECK(hostBasepri == 0);
+    }
+    CHECK(hostBasepri == 0 && hostPrimask == 0);
+
+    return true;
+}
+
+static bool testNesting(void)
+{
+    {
+        CriticalSection outer;
+
+        // An inner section never lowers the mask of an outer one
+        {
+            CriticalSection inner(TEST_PRIORITY_LOW);
+            CHECK(hostBasepri == configMAX_SYSCALL_INTERRUPT_PRIORITY);
+        }
+        CHECK(hostBasepri == configMAX_SYSCALL_INTERRUPT_PRIORITY);
+
+        // But it may raise it, until it exits
+        {
+            CriticalSection inner(TEST_PRIORITY_HIGH);
+            CHECK(hostBasepri == TEST_PRIORITY_HIGH);
+
+            {
+                CriticalSection all(CRITICAL_SECTION_ALL);
+                CHECK(hostPrimask == 1);
+
+                {
+                    CriticalSection again(CRITICAL_SECTION_ALL);
+                }
+                CHECK(hostPrimask == 1);
+            }
+            CHECK(hostPrimask == 0);
+            CHECK(hostBasepri == TEST_PRIORITY_HIGH);
+        }
+        CHECK(hostBasepri == configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    }
+    CHECK(hostBasepri == 0 && hostPrimask == 0);
+
+    return true;
+}
+
+static bool testStats(void)
+{
+    CriticalSectionStats stats;
+
+    CriticalSection::startStats();
+    CHECK(hostPrimask == 0);
+
+    // Only the outermost sections are timed, the nested ones are part of them
+    {
+        CriticalSection outer;
+        hostCycles += 10;
+        {
+            CriticalSection inner(CRITICAL_SECTION_ALL);
+            hostCycles += 5;
+        }
+    }
+
+    {
+        CriticalSection all(CRITICAL_SECTION_ALL);
+        hostCycles += 40;
+    }
+    CHECK(hostPrimask == 0 && hostBasepri == 0);
+
+    {
+        CriticalSection section;
+        hostCycles += 20;
+    }
+
+    // Updating the statistics leaves the masks as they were
+    CHECK(hostPrimask == 0 && hostBasepri == 0);
+
+    CriticalSection::getStats(stats);
+    CHECK(stats.count == 3);
+    CHECK(stats.cycles == 75);
+    CHECK(stats.maxCycles == 40);
+    CHECK(stats.maxCaller != nullptr);
+
+    printf("Timed %u sections, the longest held the mask for %u cycles\n",
+           stats.count, stats.maxCycles);
+
+    // Starting again clears them
+    CriticalSection::startStats();
+    CriticalSection::getStats(stats);
+    CHECK(stats.count == 0 && stats.cycles == 0 && stats.maxCycles == 0);
+
+    return true;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file       Registers.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host register file and stubs for the libcc2538 functions that
+ *             the uDMA driver links against.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <map>
+
+#include "hw_types.h"
+#include "interrupt.h"
+
+/*================================ define ===================================*/
+
+/*================================ typedef ==================================*/
+
+/*=============================== variables =================================*/
+
+// Registers are created as zero on first access and never move
+static std::map<uint32_t, uint32_t> registers;
+
+/*=============================== prototypes ================================*/
+
+/*================================= public ==================================*/
+
+extern "C" volatile uint32_t* hostRegister(uint32_t address)
+{
+    return &registers[address];
+}
+
+void IntRegister(uint32_t interrupt, void (*handler)(void))
+{
+}
+
+void IntUnregister(uint32_t interrupt)
+{
+}
+
+void IntEnable(uint32_t interrupt)
+{
+}
+
+void IntDisable(uint32_t interrupt)
+{
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
@@ -0,0 +1,39 @@
+/**
+ * @file       hw_types.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host stand-in for the libcc2538 hw_types.h that redirects the
+ *             register accesses to a register file in memory.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef __HW_TYPES_H__
+#define __HW_TYPES_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned char tBoolean;
+
+// Returns the value of the register at the given address
+volatile uint32_t* hostRegister(uint32_t address);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define HWREG(x)                                                              \
+        (*hostRegister((uint32_t)(x)))
+#define HWREGH(x)                                                             \
+        (*(volatile uint16_t *) hostRegister((uint32_t)(x)))
+#define HWREGB(x)                                                             \
+        (*(volatile unsigned char *) hostRegister((uint32_t)(x)))
+
+#endif // __HW_TYPES_H__
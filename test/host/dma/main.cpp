@@ -0,0 +1,250 @@
+/**
+ * @file       main.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host test of the uDMA programming against a register fake.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Dma.h"
+
+#include "cc2538_include.h"
+
+/*================================ define ===================================*/
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            printf("Error: %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+#define UART_TX_CONTROL         ( UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_1 )
+#define UART_RX_CONTROL         ( UDMA_SIZE_8 | UDMA_SRC_INC_NONE | UDMA_DST_INC_8 | UDMA_ARB_1 )
+
+/*================================ typedef ==================================*/
+
+/*=============================== prototypes ================================*/
+
+static bool testEnable(void);
+static bool testConfigure(void);
+static bool testTransfer(void);
+static bool testDone(void);
+static bool testPingPong(void);
+static bool testRequest(void);
+
+/*=============================== variables =================================*/
+
+// Transfers hold 32-bit addresses, so the buffer must be static
+static uint8_t buffer[64];
+
+/*================================= public ==================================*/
+
+int main(void)
+{
+    bool status = true;
+
+    status &= testEnable();
+    status &= testConfigure();
+    status &= testTransfer();
+    status &= testDone();
+    status &= testPingPong();
+    status &= testRequest();
+
+    return (status ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+static bool testEnable(void)
+{
+    Dma& dma = Dma::getInstance();
+    uint32_t base;
+
+    dma.enable();
+
+    // The controller is enabled with a 1024-byte aligned control table
+    base = HWREG(UDMA_CTLBASE);
+    CHECK(HWREG(UDMA_CFG) == UDMA_CFG_MASTEN);
+    CHECK(base != 0);
+    CHECK((base & 0x3FF) == 0);
+
+    // Enabling it again from another peripheral keeps the same table
+    HWREG(UDMA_CTLBASE) = 0;
+    dma.enable();
+    CHECK(HWREG(UDMA_CTLBASE) == 0);
+    HWREG(UDMA_CTLBASE) = base;
+
+    return true;
+}
+
+static bool testConfigure(void)
+{
+    Dma& dma = Dma::getInstance();
+    tDMAControlTable* table = (tDMAControlTable *) (uintptr_t) HWREG(UDMA_CTLBASE);
+
+    // Channel 9 is shared by UART0 TX (encoding 0) and UART1 TX (encoding 1)
+    dma.configure(UDMA_CH9_UART1TX, UART_TX_CONTROL);
+    CHECK(((HWREG(UDMA_CHMAP1) >> 4) & 0xF) == 1);
+
+    HWREG(UDMA_CHMAP1) |= 0xF;
+    dma.configure(UDMA_CH9_UART0TX, UART_TX_CONTROL);
+    CHECK(((HWREG(UDMA_CHMAP1) >> 4) & 0xF) == 0);
+    CHECK((HWREG(UDMA_CHMAP1) & 0xF) == 0xF);
+
+    // Every attribute of the channel is cleared
+    CHECK(HWREG(UDMA_USEBURSTCLR) == (1 << 9));
+    CHECK(HWREG(UDMA_ALTCLR) == (1 << 9));
+    CHECK(HWREG(UDMA_PRIOCLR) == (1 << 9));
+    CHECK(HWREG(UDMA_REQMASKCLR) == (1 << 9));
+
+    // The primary control word holds the sizes, increments and arbitration
+    CHECK(table[9].ui32Control == UART_TX_CONTROL);
+
+    return true;
+}
+
+static bool testTransfer(void)
+{
+    Dma& dma = Dma::getInstance();
+    tDMAControlTable* table = (tDMAControlTable *) (uintptr_t) HWREG(UDMA_CTLBASE);
+    void* data = (void *) (UART0_BASE + UART_O_DR);
+
+    // Lengths that do not fit in one transfer are rejected
+    CHECK(!dma.transfer(UDMA_CH9_UART0TX, buffer, data, 0));
+    CHECK(!dma.transfer(UDMA_CH9_UART0TX, buffer, data, 1025));
+
+    // And so are the channels above the table
+    CHECK(!dma.transfer(UDMA_CH31_RESERVED0, buffer, data, sizeof(buffer)));
+    CHECK(!dma.transferPingPong(UDMA_CH31_RESERVED0, data, buffer, buffer, 1));
+    CHECK(HWREG(UDMA_ENASET) == 0);
+
+    CHECK(dma.transfer(UDMA_CH9_UART0TX, buffer, data, sizeof(buffer)));
+
+    // The source advances to the last byte, the data register stays put
+    CHECK(table[9].pvSrcEndAddr == &buffer[sizeof(buffer) - 1]);
+    CHECK(table[9].pvDstEndAddr == data);
+
+    // Basic mode with the size encoded as length minus one
+    CHECK((table[9].ui32Control & UDMACHCTL_CHCTL_XFERMODE_M) == UDMA_MODE_BASIC);
+    CHECK(((table[9].ui32Control & UDMACHCTL_CHCTL_XFERSIZE_M) >> UDMACHCTL_CHCTL_XFERSIZE_S) == sizeof(buffer) - 1);
+    CHECK((table[9].ui32Control & ~(UDMACHCTL_CHCTL_XFERMODE_M | UDMACHCTL_CHCTL_XFERSIZE_M)) == UART_TX_CONTROL);
+
+    // The channel is enabled and the controller has not finished yet
+    CHECK(HWREG(UDMA_ENASET) == (1 << 9));
+    CHECK(dma.isBusy(UDMA_CH9_UART0TX));
+    CHECK(!dma.transfer(UDMA_CH9_UART0TX, buffer, data, sizeof(buffer)));
+
+    // The controller disables the channel once the transfer is done
+    HWREG(UDMA_ENASET) = 0;
+    CHECK(!dma.isBusy(UDMA_CH9_UART0TX));
+
+    return true;
+}
+
+static bool testDone(void)
+{
+    Dma& dma = Dma::getInstance();
+
+    // Completion of another channel is not taken as ours
+    HWREG(UDMA_CHIS) = (1 << 8);
+    CHECK(!dma.isDone(UDMA_CH9_UART0TX));
+    CHECK(HWREG(UDMA_CHIS) == (1 << 8));
+
+    // Only the bit of the channel is written back to clear it
+    HWREG(UDMA_CHIS) = (1 << 8) | (1 << 9);
+    CHECK(dma.isDone(UDMA_CH9_UART0TX));
+    CHECK(HWREG(UDMA_CHIS) == (1 << 9));
+
+    return true;
+}
+
+static bool testPingPong(void)
+{
+    Dma& dma = Dma::getInstance();
+    tDMAControlTable* table = (tDMAControlTable *) (uintptr_t) HWREG(UDMA_CTLBASE);
+    tDMAControlTable* primary = &table[8];
+    tDMAControlTable* alternate = &table[8 | UDMA_ALT_SELECT];
+    void* data = (void *) (UART0_BASE + UART_O_DR);
+    uint32_t half = sizeof(buffer) / 2;
+
+    // Both structures get the control word
+    dma.configure(UDMA_CH8_UART0RX, UART_RX_CONTROL);
+    CHECK(primary->ui32Control == UART_RX_CONTROL);
+    CHECK(alternate->ui32Control == UART_RX_CONTROL);
+
+    HWREG(UDMA_ENASET) = 0;
+    CHECK(dma.transferPingPong(UDMA_CH8_UART0RX, data, &buffer[0], &buffer[half], half));
+
+    // The transfer starts with the primary structure filling the first half
+    CHECK(HWREG(UDMA_ALTCLR) == (1 << 8));
+    CHECK(HWREG(UDMA_ENASET) == (1 << 8));
+    CHECK(primary->pvSrcEndAddr == data);
+    CHECK(primary->pvDstEndAddr == &buffer[half - 1]);
+    CHECK(alternate->pvDstEndAddr == &buffer[2 * half - 1]);
+    CHECK((primary->ui32Control & UDMACHCTL_CHCTL_XFERMODE_M) == UDMA_MODE_PINGPONG);
+    CHECK((alternate->ui32Control & UDMACHCTL_CHCTL_XFERMODE_M) == UDMA_MODE_PINGPONG);
+    CHECK(dma.getRemaining(UDMA_CH8_UART0RX, false) == half);
+    CHECK(!dma.isStopped(UDMA_CH8_UART0RX, false));
+
+    // The controller stops the primary structure once the first half is full
+    primary->ui32Control &= ~(UDMACHCTL_CHCTL_XFERMODE_M | UDMACHCTL_CHCTL_XFERSIZE_M);
+    CHECK(dma.isStopped(UDMA_CH8_UART0RX, false));
+    CHECK(!dma.isStopped(UDMA_CH8_UART0RX, true));
+
+    // Reloading it points it at the first half again
+    HWREG(UDMA_ENASET) = 0;
+    dma.reload(UDMA_CH8_UART0RX, false, data, &buffer[0], half);
+    CHECK(!dma.isStopped(UDMA_CH8_UART0RX, false));
+    CHECK(primary->pvDstEndAddr == &buffer[half - 1]);
+    CHECK(dma.getRemaining(UDMA_CH8_UART0RX, false) == half);
+    CHECK(HWREG(UDMA_ENASET) == (1 << 8));
+
+    return true;
+}
+
+static bool testRequest(void)
+{
+    Dma& dma = Dma::getInstance();
+    tDMAControlTable* table = (tDMAControlTable *) (uintptr_t) HWREG(UDMA_CTLBASE);
+    void* data = (void *) (UART0_BASE + UART_O_DR);
+
+    dma.configure(UDMA_CH30_SW, UART_RX_CONTROL);
+
+    // Lengths that do not fit in one transfer are rejected
+    HWREG(UDMA_ENASET) = 0;
+    HWREG(UDMA_SWREQ) = 0;
+    CHECK(!dma.request(UDMA_CH30_SW, UART_TX_CONTROL, buffer, data, 0));
+    CHECK(HWREG(UDMA_SWREQ) == 0);
+
+    // The control word is replaced, as it may change between transfers
+    CHECK(dma.request(UDMA_CH30_SW, UART_TX_CONTROL, buffer, data, 16));
+    CHECK((table[30].ui32Control & ~(UDMACHCTL_CHCTL_XFERMODE_M | UDMACHCTL_CHCTL_XFERSIZE_M)) == UART_TX_CONTROL);
+    CHECK(table[30].pvSrcEndAddr == &buffer[15]);
+    CHECK(table[30].pvDstEndAddr == data);
+
+    // A single software request moves all the items
+    CHECK((table[30].ui32Control & UDMACHCTL_CHCTL_XFERMODE_M) == UDMA_MODE_AUTO);
+    CHECK(HWREG(UDMA_ENASET) == (1 << 30));
+    CHECK(HWREG(UDMA_SWREQ) == (1 << 30));
+
+    // The channel cannot be requested again until it is done
+    CHECK(!dma.request(UDMA_CH30_SW, UART_RX_CONTROL, data, buffer, 16));
+    HWREG(UDMA_ENASET) = 0;
+    CHECK(dma.request(UDMA_CH30_SW, UART_RX_CONTROL, data, buffer, 16));
+    CHECK(table[30].pvSrcEndAddr == data);
+    CHECK(table[30].pvDstEndAddr == &buffer[15]);
+
+    return true;
+}
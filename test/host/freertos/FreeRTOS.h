@@ -0,0 +1,74 @@
+/**
+ * @file       FreeRTOS.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host shim of the FreeRTOS kernel types used by the library.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef FREERTOS_H_
+#define FREERTOS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+#define configCPU_CLOCK_HZ                  ( 32000000 )
+#define configTICK_RATE_HZ                  ( ( TickType_t ) 1000 )
+#define configMAX_PRIORITIES                ( 5 )
+#define configMINIMAL_STACK_SIZE            ( ( uint16_t ) 64 )
+#define configTOTAL_HEAP_SIZE               ( ( size_t ) ( 4 * 1024 ) )
+#define configMAX_SYSCALL_INTERRUPT_PRIORITY ( 5 << 5 )
+
+#define portMAX_DELAY                       ( ( TickType_t ) 0xFFFFFFFFUL )
+#define portTICK_PERIOD_MS                  ( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portTICK_RATE_MS                    portTICK_PERIOD_MS
+#define portYIELD_FROM_ISR( x )             ( ( void ) ( x ) )
+
+#define pdFALSE                             ( ( BaseType_t ) 0 )
+#define pdTRUE                              ( ( BaseType_t ) 1 )
+#define pdPASS                              ( pdTRUE )
+#define pdFAIL                              ( pdFALSE )
+
+#define tskIDLE_PRIORITY                    ( ( UBaseType_t ) 0U )
+
+/* Definitions that the kernel heap allocators need to build on the host */
+#define portBYTE_ALIGNMENT                  ( 8 )
+#define portBYTE_ALIGNMENT_MASK             ( 0x0007 )
+#define portPOINTER_SIZE_TYPE               size_t
+
+#define configASSERT( x )
+#define mtCOVERAGE_TEST_MARKER()
+#define traceMALLOC( pvAddress, uiSize )
+#define traceFREE( pvAddress, uiSize )
+
+typedef struct xHEAP_STATS
+{
+    size_t xAvailableHeapSpaceInBytes;
+    size_t xSizeOfLargestFreeBlockInBytes;
+    size_t xSizeOfSmallestFreeBlockInBytes;
+    size_t xNumberOfFreeBlocks;
+    size_t xMinimumEverFreeBytesRemaining;
+    size_t xNumberOfSuccessfulAllocations;
+    size_t xNumberOfSuccessfulFrees;
+} HeapStats_t;
+
+size_t xPortGetFreeHeapSize(void);
+void vPortGetHeapStats(HeapStats_t* pxHeapStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FREERTOS_H_ */
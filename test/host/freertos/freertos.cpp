@@ -0,0 +1,337 @@
+/**
+ * @file       freertos.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host shim of the FreeRTOS kernel on top of the C++ threads.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <pthread.h>
+
+/*================================ define ===================================*/
+
+/*================================ typedef ==================================*/
+
+struct HostSemaphore
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    UBaseType_t count;
+    UBaseType_t maxCount;
+    std::thread::id owner;
+    UBaseType_t depth;
+};
+
+/*=============================== variables =================================*/
+
+static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+static std::atomic<UBaseType_t> tasks(0);
+
+static std::recursive_mutex scheduler;
+
+/*=============================== prototypes ================================*/
+
+static SemaphoreHandle_t create(UBaseType_t count, UBaseType_t maxCount);
+static BaseType_t take(SemaphoreHandle_t semaphore, TickType_t ticks);
+static BaseType_t give(SemaphoreHandle_t semaphore);
+
+/*================================= public ==================================*/
+
+/**
+ * Runs the task in a thread of its own, which outlives the test. Neither
+ * the stack depth nor the priority have a host equivalent.
+ */
+BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const char* const pcName, uint16_t usStackDepth,
+                       void* pvParameters, UBaseType_t uxPriority, TaskHandle_t* pxCreatedTask)
+{
+    std::thread thread(pvTaskCode, pvParameters);
+
+    tasks++;
+
+    if (pxCreatedTask != NULL)
+    {
+        *pxCreatedTask = NULL;
+    }
+
+    thread.detach();
+
+    return pdPASS;
+}
+
+/**
+ * The thread keeps its own stack, so the stack buffer is not used.
+ */
+BaseType_t xTaskGenericCreate(TaskFunction_t pxTaskCode, const char* const pcName, const uint16_t usStackDepth,
+                              void* const pvParameters, UBaseType_t uxPriority, TaskHandle_t* const pxCreatedTask,
+                              StackType_t* const puxStackBuffer, const MemoryRegion_t* const xRegions)
+{
+    return xTaskCreate(pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+    return (TickType_t) std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(xTicksToDelay * portTICK_PERIOD_MS));
+}
+
+/**
+ * Sleeps until the wake time, which is advanced by the increment whether or
+ * not it has already passed, as the kernel does.
+ */
+void vTaskDelayUntil(TickType_t* const pxPreviousWakeTime, const TickType_t xTimeIncrement)
+{
+    TickType_t wakeTime = *pxPreviousWakeTime + xTimeIncrement;
+    int32_t remaining = (int32_t) (wakeTime - xTaskGetTickCount());
+
+    *pxPreviousWakeTime = wakeTime;
+
+    if (remaining > 0)
+    {
+        vTaskDelay((TickType_t) remaining);
+    }
+}
+
+/**
+ * Ends the calling thread. Deleting another task has no host equivalent.
+ */
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+    if (xTaskToDelete == NULL)
+    {
+        tasks--;
+        pthread_exit(NULL);
+    }
+}
+
+/**
+ * The tasks already run in their threads, so the caller just waits.
+ */
+void vTaskStartScheduler(void)
+{
+    while (true)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void)
+{
+    return tasks;
+}
+
+/**
+ * There is no scheduler to suspend, so other threads are kept out of the
+ * section instead.
+ */
+void vTaskSuspendAll(void)
+{
+    scheduler.lock();
+}
+
+BaseType_t xTaskResumeAll(void)
+{
+    scheduler.unlock();
+
+    return pdFALSE;
+}
+
+/**
+ * The host allocates from the C++ heap, so the kernel heap is always free.
+ */
+size_t xPortGetFreeHeapSize(void)
+{
+    return configTOTAL_HEAP_SIZE;
+}
+
+void vPortGetHeapStats(HeapStats_t* pxHeapStats)
+{
+    pxHeapStats->xAvailableHeapSpaceInBytes = configTOTAL_HEAP_SIZE;
+    pxHeapStats->xSizeOfLargestFreeBlockInBytes = configTOTAL_HEAP_SIZE;
+    pxHeapStats->xSizeOfSmallestFreeBlockInBytes = configTOTAL_HEAP_SIZE;
+    pxHeapStats->xNumberOfFreeBlocks = 1;
+    pxHeapStats->xMinimumEverFreeBytesRemaining = configTOTAL_HEAP_SIZE;
+    pxHeapStats->xNumberOfSuccessfulAllocations = 0;
+    pxHeapStats->xNumberOfSuccessfulFrees = 0;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return create(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void)
+{
+    return create(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return create(0, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount)
+{
+    return create(uxInitialCount, uxMaxCount);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+    delete xSemaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+{
+    return take(xSemaphore, xBlockTime);
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t xMutex, TickType_t xBlockTime)
+{
+    {
+        std::lock_guard<std::mutex> lock(xMutex->mutex);
+
+        // The owner may take the mutex again without blocking
+        if (xMutex->depth > 0 && xMutex->owner == std::this_thread::get_id())
+        {
+            xMutex->depth++;
+            return pdTRUE;
+        }
+    }
+
+    if (take(xMutex, xBlockTime) != pdTRUE)
+    {
+        return pdFALSE;
+    }
+
+    std::lock_guard<std::mutex> lock(xMutex->mutex);
+    xMutex->owner = std::this_thread::get_id();
+    xMutex->depth = 1;
+
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t xSemaphore, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken != NULL)
+    {
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    }
+
+    return take(xSemaphore, 0);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+    return give(xSemaphore);
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t xMutex)
+{
+    {
+        std::lock_guard<std::mutex> lock(xMutex->mutex);
+
+        // Only the owner may give the mutex back
+        if (xMutex->depth == 0 || xMutex->owner != std::this_thread::get_id())
+        {
+            return pdFALSE;
+        }
+
+        // Release the mutex once the outermost take is undone
+        if (--xMutex->depth > 0)
+        {
+            return pdTRUE;
+        }
+
+        xMutex->owner = std::thread::id();
+    }
+
+    return give(xMutex);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t xSemaphore, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken != NULL)
+    {
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    }
+
+    return give(xSemaphore);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t xSemaphore)
+{
+    std::lock_guard<std::mutex> lock(xSemaphore->mutex);
+    return xSemaphore->count;
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+static SemaphoreHandle_t create(UBaseType_t count, UBaseType_t maxCount)
+{
+    SemaphoreHandle_t semaphore = new HostSemaphore;
+
+    semaphore->count = count;
+    semaphore->maxCount = maxCount;
+    semaphore->depth = 0;
+
+    return semaphore;
+}
+
+static BaseType_t take(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+
+    if (ticks == portMAX_DELAY)
+    {
+        semaphore->condition.wait(lock, [semaphore]{ return semaphore->count > 0; });
+    }
+    else
+    {
+        std::chrono::milliseconds timeout(ticks * portTICK_PERIOD_MS);
+        if (!semaphore->condition.wait_for(lock, timeout, [semaphore]{ return semaphore->count > 0; }))
+        {
+            return pdFALSE;
+        }
+    }
+
+    semaphore->count--;
+
+    return pdTRUE;
+}
+
+static BaseType_t give(SemaphoreHandle_t semaphore)
+{
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+
+    if (semaphore->count >= semaphore->maxCount)
+    {
+        return pdFALSE;
+    }
+
+    semaphore->count++;
+    semaphore->condition.notify_one();
+
+    return pdTRUE;
+}
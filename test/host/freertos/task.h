@@ -0,0 +1,43 @@
+/**
+ * @file       task.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host shim of the FreeRTOS task API used by the library.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef TASK_H
+#define TASK_H
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+typedef struct MemoryRegion MemoryRegion_t;
+
+BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const char* const pcName, uint16_t usStackDepth,
+                       void* pvParameters, UBaseType_t uxPriority, TaskHandle_t* pxCreatedTask);
+BaseType_t xTaskGenericCreate(TaskFunction_t pxTaskCode, const char* const pcName, const uint16_t usStackDepth,
+                              void* const pvParameters, UBaseType_t uxPriority, TaskHandle_t* const pxCreatedTask,
+                              StackType_t* const puxStackBuffer, const MemoryRegion_t* const xRegions);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(const TickType_t xTicksToDelay);
+void vTaskDelayUntil(TickType_t* const pxPreviousWakeTime, const TickType_t xTimeIncrement);
+void vTaskDelete(TaskHandle_t xTaskToDelete);
+void vTaskStartScheduler(void);
+UBaseType_t uxTaskGetNumberOfTasks(void);
+void vTaskSuspendAll(void);
+BaseType_t xTaskResumeAll(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TASK_H */
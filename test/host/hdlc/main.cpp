@@ -0,0 +1,248 @@
+/**
+ * @file       main.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host test and benchmark of the Hdlc encoder and decoder.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "CircularBuffer.h"
+#include "Crc16.h"
+#include "Hdlc.h"
+
+/*================================ define ===================================*/
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            printf("Error: %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+#define HDLC_FLAG                           ( 0x7E )
+#define HDLC_ESCAPE                         ( 0x7D )
+#define HDLC_ESCAPE_MASK                    ( 0x20 )
+
+#define TEST_FRAMES                         ( 10000 )
+#define TEST_FRAME_LENGTH                   ( 200 )
+
+#define BENCHMARK_FRAME_LENGTH              ( 127 )
+#define BENCHMARK_FRAMES                    ( 200000 )
+
+/*================================ typedef ==================================*/
+
+/*=============================== prototypes ================================*/
+
+static uint32_t referenceEncode(const uint8_t* input, uint32_t length, uint8_t* output);
+static bool testRoundTrip(void);
+static bool testMaxLength(void);
+static void benchmark(void);
+
+/*=============================== variables =================================*/
+
+static uint8_t rx_storage[256];
+static uint8_t tx_storage[512];
+
+static CircularBuffer rxBuffer(rx_storage, sizeof(rx_storage));
+static CircularBuffer txBuffer(tx_storage, sizeof(tx_storage));
+
+static Hdlc hdlc(rxBuffer, txBuffer);
+
+/*================================= public ==================================*/
+
+int main(void)
+{
+    bool status = true;
+
+    srand(0x0E4D);
+
+    status &= testRoundTrip();
+    status &= testMaxLength();
+
+    if (!status)
+    {
+        return EXIT_FAILURE;
+    }
+
+    benchmark();
+
+    return EXIT_SUCCESS;
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+static uint32_t referenceEncode(const uint8_t* input, uint32_t length, uint8_t* output)
+{
+    uint8_t trailer[2];
+    uint32_t count = 0;
+    Crc16 crc;
+
+    crc.init();
+    for (uint32_t i = 0; i < length; i++)
+    {
+        crc.set(input[i]);
+    }
+    trailer[0] = (crc.get() >> 8) & 0xFF;
+    trailer[1] = (crc.get() >> 0) & 0xFF;
+
+    // One byte at a time, exactly as the original Hdlc::txPut
+    output[count++] = HDLC_FLAG;
+    for (uint32_t i = 0; i < length + 2; i++)
+    {
+        uint8_t byte = (i < length) ? input[i] : trailer[i - length];
+        if (byte == HDLC_FLAG || byte == HDLC_ESCAPE)
+        {
+            output[count++] = HDLC_ESCAPE;
+            byte ^= HDLC_ESCAPE_MASK;
+        }
+        output[count++] = byte;
+    }
+    output[count++] = HDLC_FLAG;
+
+    return count;
+}
+
+static bool testRoundTrip(void)
+{
+    uint8_t input[TEST_FRAME_LENGTH];
+    uint8_t expected[2 * TEST_FRAME_LENGTH + 6];
+    uint8_t encoded[2 * TEST_FRAME_LENGTH + 6];
+    uint8_t decoded[TEST_FRAME_LENGTH + 2];
+    uint32_t expectedLength, encodedLength;
+
+    for (uint32_t frame = 0; frame < TEST_FRAMES; frame++)
+    {
+        uint32_t length = rand() % TEST_FRAME_LENGTH;
+
+        // Bias the payload towards flag and escape bytes
+        for (uint32_t i = 0; i < length; i++)
+        {
+            uint32_t choice = rand() % 8;
+            input[i] = (choice == 0) ? HDLC_FLAG : (choice == 1) ? HDLC_ESCAPE : (uint8_t) rand();
+        }
+
+        // Leave the transmit indices at a different offset every frame
+        txBuffer.reset();
+        for (uint32_t i = 0; i < frame % 64; i++)
+        {
+            uint8_t byte;
+            txBuffer.write(0x00);
+            txBuffer.read(&byte);
+        }
+
+        // Encode the frame
+        CHECK(hdlc.txOpen() == HdlcResult_Ok);
+        CHECK(hdlc.txPut(input, length) == HdlcResult_Ok);
+        CHECK(hdlc.txClose() == HdlcResult_Ok);
+
+        encodedLength = txBuffer.getSize();
+        CHECK(txBuffer.read(encoded, encodedLength));
+
+        // The output must match the byte-by-byte encoder exactly
+        expectedLength = referenceEncode(input, length, expected);
+        CHECK(encodedLength == expectedLength);
+        CHECK(encodedLength <= Hdlc::getTxMaxLength(length));
+        CHECK(memcmp(encoded, expected, encodedLength) == 0);
+
+        // Decode the frame, the opening flag needs a preceding flag
+        rxBuffer.reset();
+        CHECK(hdlc.rxOpen() == HdlcResult_Ok);
+        CHECK(hdlc.rxPut(HDLC_FLAG) == HdlcResult_Ok);
+        for (uint32_t i = 0; i < encodedLength; i++)
+        {
+            CHECK(hdlc.rxPut(encoded[i]) == HdlcResult_Ok);
+        }
+        CHECK(hdlc.getRxStatus() == HdlcStatus_Done);
+        CHECK(hdlc.rxClose() == HdlcResult_Ok);
+
+        // The queued frame carries the payload without the CRC
+        CHECK(hdlc.rxRead(decoded, sizeof(decoded)) == length);
+        CHECK(memcmp(decoded, input, length) == 0);
+        CHECK(rxBuffer.isEmpty());
+    }
+
+    return true;
+}
+
+static bool testMaxLength(void)
+{
+    uint8_t input[TEST_FRAME_LENGTH];
+    uint32_t length;
+
+    // A payload made of flags doubles in size
+    memset(input, HDLC_FLAG, sizeof(input));
+
+    txBuffer.reset();
+    CHECK(hdlc.txOpen() == HdlcResult_Ok);
+    CHECK(hdlc.txPut(input, sizeof(input)) == HdlcResult_Ok);
+    CHECK(hdlc.txClose() == HdlcResult_Ok);
+
+    length = txBuffer.getSize();
+    CHECK(length >= 2 * sizeof(input) + 4);
+    CHECK(length <= Hdlc::getTxMaxLength(sizeof(input)));
+
+    // Running out of transmit buffer is reported, not overrun
+    CHECK(hdlc.txOpen() == HdlcResult_Ok);
+    CHECK(hdlc.txPut(input, sizeof(input)) == HdlcResult_Error);
+    CHECK(txBuffer.getSize() <= sizeof(tx_storage));
+
+    // and the partial frame is never published
+    CHECK(txBuffer.getSize() == length);
+
+    return true;
+}
+
+static void benchmark(void)
+{
+    uint8_t input[BENCHMARK_FRAME_LENGTH];
+    std::chrono::steady_clock::time_point start;
+    std::chrono::duration<double> bytewise, bulk;
+
+    // Typical sniffed frame, with the odd byte that needs escaping
+    for (uint32_t i = 0; i < sizeof(input); i++)
+    {
+        input[i] = (rand() % 64 == 0) ? HDLC_FLAG : (uint8_t) rand();
+    }
+
+    // One byte at a time, as Serial::write used to do
+    start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < BENCHMARK_FRAMES; frame++)
+    {
+        txBuffer.reset();
+        hdlc.txOpen();
+        for (uint32_t i = 0; i < sizeof(input); i++)
+        {
+            hdlc.txPut(input[i]);
+        }
+        hdlc.txClose();
+    }
+    bytewise = std::chrono::steady_clock::now() - start;
+
+    // Whole frame, scanned and copied in runs
+    start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < BENCHMARK_FRAMES; frame++)
+    {
+        txBuffer.reset();
+        hdlc.txOpen();
+        hdlc.txPut(input, sizeof(input));
+        hdlc.txClose();
+    }
+    bulk = std::chrono::steady_clock::now() - start;
+
+    printf("Hdlc::txPut (byte):    %8.1f ns/frame\n", bytewise.count() * 1e9 / BENCHMARK_FRAMES);
+    printf("Hdlc::txPut (buffer):  %8.1f ns/frame\n", bulk.count() * 1e9 / BENCHMARK_FRAMES);
+}
@@ -0,0 +1,18 @@
+/**
+ * @file       Heap1.c
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      The kernel heap_1 allocator, renamed to link next to the others.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#define pvPortMalloc                        heap1Malloc
+#define vPortFree                           heap1Free
+#define vPortInitialiseBlocks               heap1InitialiseBlocks
+#define vPortGetHeapStats                   heap1GetHeapStats
+#define xPortGetFreeHeapSize                heap1GetFreeHeapSize
+
+#include "heap_1.c"
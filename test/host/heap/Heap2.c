@@ -0,0 +1,19 @@
+/**
+ * @file       Heap2.c
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      The kernel heap_2 allocator, renamed to link next to the others.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#define pvPortMalloc                        heap2Malloc
+#define vPortFree                           heap2Free
+#define vPortInitialiseBlocks               heap2InitialiseBlocks
+#define vPortGetHeapStats                   heap2GetHeapStats
+#define xPortGetFreeHeapSize                heap2GetFreeHeapSize
+#define xPortGetMinimumEverFreeHeapSize     heap2GetMinimumEverFreeHeapSize
+
+#include "heap_2.c"
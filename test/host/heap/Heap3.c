@@ -0,0 +1,16 @@
+/**
+ * @file       Heap3.c
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      The kernel heap_3 allocator, renamed to link next to the others.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#define pvPortMalloc                        heap3Malloc
+#define vPortFree                           heap3Free
+#define vPortGetHeapStats                   heap3GetHeapStats
+
+#include "heap_3.c"
@@ -0,0 +1,19 @@
+/**
+ * @file       Heap4.c
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      The kernel heap_4 allocator, renamed to link next to the others.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#define pvPortMalloc                        heap4Malloc
+#define vPortFree                           heap4Free
+#define vPortInitialiseBlocks               heap4InitialiseBlocks
+#define vPortGetHeapStats                   heap4GetHeapStats
+#define xPortGetFreeHeapSize                heap4GetFreeHeapSize
+#define xPortGetMinimumEverFreeHeapSize     heap4GetMinimumEverFreeHeapSize
+
+#include "heap_4.c"
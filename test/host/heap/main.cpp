@@ -0,0 +1,468 @@
+/**
+ * @file       main.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host fuzz test of the kernel heap allocators and statistics.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "FreeRTOS.h"
+
+#include "Heap.h"
+
+/*================================ define ===================================*/
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            printf("Error: %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+#define TEST_TRACES                         ( 8 )
+#define TEST_TRACE_STEPS                    ( 4000 )
+#define TEST_LIVE_BYTES                     ( configTOTAL_HEAP_SIZE / 2 )
+
+/*================================ typedef ==================================*/
+
+// One step of an allocation trace
+struct TraceStep
+{
+    bool allocate;
+    uint32_t id;
+    uint32_t size;
+};
+
+// A kernel heap allocator under test
+struct Allocator
+{
+    const char* name;
+    void* (*malloc)(size_t size);
+    void (*free)(void* pointer);
+    void (*getStats)(HeapStats_t* stats);
+    size_t initialFree;
+    uint32_t failures;
+    uint32_t samples;
+    uint64_t fragmentation;
+    uint16_t maxFragmentation;
+};
+
+/*=============================== prototypes ================================*/
+
+extern "C" void* heap1Malloc(size_t size);
+extern "C" void heap1GetHeapStats(HeapStats_t* stats);
+extern "C" void* heap2Malloc(size_t size);
+extern "C" void heap2Free(void* pointer);
+extern "C" void heap2GetHeapStats(HeapStats_t* stats);
+extern "C" void* heap3Malloc(size_t size);
+extern "C" void heap3Free(void* pointer);
+extern "C" void heap3GetHeapStats(HeapStats_t* stats);
+extern "C" void* heap4Malloc(size_t size);
+extern "C" void heap4Free(void* pointer);
+extern "C" void heap4GetHeapStats(HeapStats_t* stats);
+
+static uint32_t random32(uint32_t& state);
+static void generate(std::vector<TraceStep>& trace, uint32_t seed);
+static bool load(std::vector<TraceStep>& trace, const char* path);
+static void getStats(Allocator& allocator, HeapStats& stats);
+static bool replay(Allocator& allocator, const std::vector<TraceStep>& trace);
+static bool testFragmentation(void);
+static bool testStats(void);
+static bool testSimpleHeaps(void);
+static bool testTraces(const char* path);
+
+/*=============================== variables =================================*/
+
+static Allocator heap2 = {"heap_2", heap2Malloc, heap2Free, heap2GetHeapStats, 0, 0, 0, 0, 0};
+static Allocator heap4 = {"heap_4", heap4Malloc, heap4Free, heap4GetHeapStats, 0, 0, 0, 0, 0};
+
+// Sizes of the kernel objects that tasks create and delete, in bytes
+static const uint32_t objectSizes[] = {
+    96,     // Task control block
+    256,    // Task stack of 64 words
+    512,    // Task stack of 128 words
+    80,     // Semaphore or mutex
+    112,    // Queue of 8 pointers
+    208,    // Queue of 8 messages of 16 bytes
+};
+
+/*================================= public ==================================*/
+
+int main(int argc, char** argv)
+{
+    bool status = true;
+
+    status &= testFragmentation();
+    status &= testStats();
+    status &= testSimpleHeaps();
+    status &= testTraces(argc > 1 ? argv[1] : NULL);
+
+    return (status ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+static uint32_t random32(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    return state;
+}
+
+/**
+ * Generates a trace of tasks and their objects being created and deleted
+ * in random order, with a few small short-lived buffers in between, and
+ * ends it by freeing whatever is left.
+ */
+static void generate(std::vector<TraceStep>& trace, uint32_t seed)
+{
+    std::vector<TraceStep> live;
+    uint32_t state = seed;
+    uint32_t liveBytes = 0;
+    uint32_t id = 0;
+
+    trace.clear();
+
+    for (uint32_t i = 0; i < TEST_TRACE_STEPS; i++)
+    {
+        uint32_t size;
+
+        if (random32(state) % 4 == 0)
+        {
+            size = 8 + random32(state) % 120;
+        }
+        else
+        {
+            size = objectSizes[random32(state) % (sizeof(objectSizes) / sizeof(objectSizes[0]))];
+        }
+
+        if (live.empty() || (liveBytes + size <= TEST_LIVE_BYTES && random32(state) % 2 == 0))
+        {
+            live.push_back(TraceStep{true, id++, size});
+            trace.push_back(live.back());
+            liveBytes += size;
+        }
+        else
+        {
+            uint32_t index = random32(state) % live.size();
+
+            trace.push_back(TraceStep{false, live[index].id, 0});
+            liveBytes -= live[index].size;
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+
+    for (uint32_t i = 0; i < live.size(); i++)
+    {
+        trace.push_back(TraceStep{false, live[i].id, 0});
+    }
+}
+
+/**
+ * Reads a trace with one step per line, "m <id> <size>" to allocate and
+ * "f <id>" to free.
+ */
+static bool load(std::vector<TraceStep>& trace, const char* path)
+{
+    FILE* file;
+    char line[64];
+    char operation;
+    unsigned id, size;
+
+    file = fopen(path, "r");
+    if (file == NULL) return false;
+
+    trace.clear();
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (sscanf(line, " %c %u %u", &operation, &id, &size) == 3 && operation == 'm')
+        {
+            trace.push_back(TraceStep{true, id, size});
+        }
+        else if (sscanf(line, " %c %u", &operation, &id) == 2 && operation == 'f')
+        {
+            trace.push_back(TraceStep{false, id, 0});
+        }
+    }
+
+    fclose(file);
+
+    return true;
+}
+
+static void getStats(Allocator& allocator, HeapStats& stats)
+{
+    HeapStats_t heapStats;
+
+    allocator.getStats(&heapStats);
+
+    stats.size = configTOTAL_HEAP_SIZE;
+    stats.free = heapStats.xAvailableHeapSpaceInBytes;
+    stats.minimumFree = heapStats.xMinimumEverFreeBytesRemaining;
+    stats.largestBlock = heapStats.xSizeOfLargestFreeBlockInBytes;
+    stats.freeBlocks = heapStats.xNumberOfFreeBlocks;
+    stats.allocations = heapStats.xNumberOfSuccessfulAllocations;
+    stats.frees = heapStats.xNumberOfSuccessfulFrees;
+}
+
+/**
+ * Replays the trace on the allocator, filling each block with its id and
+ * checking it is intact when freed, and samples the fragmentation after
+ * each step. A failed allocation is counted and its free is skipped.
+ */
+static bool replay(Allocator& allocator, const std::vector<TraceStep>& trace)
+{
+    std::vector<uint8_t*> blocks;
+    std::vector<uint32_t> sizes;
+    HeapStats stats;
+    uint32_t live = 0;
+    uint16_t fragmentation;
+
+    for (uint32_t i = 0; i < trace.size(); i++)
+    {
+        const TraceStep& step = trace[i];
+
+        if (step.id >= blocks.size())
+        {
+            blocks.resize(step.id + 1, nullptr);
+            sizes.resize(step.id + 1, 0);
+        }
+
+        if (step.allocate)
+        {
+            CHECK(blocks[step.id] == nullptr);
+
+            blocks[step.id] = (uint8_t*) allocator.malloc(step.size);
+            sizes[step.id] = step.size;
+
+            if (blocks[step.id] == nullptr)
+            {
+                allocator.failures++;
+                continue;
+            }
+
+            CHECK(((uintptr_t) blocks[step.id] & portBYTE_ALIGNMENT_MASK) == 0);
+            memset(blocks[step.id], (uint8_t) step.id, step.size);
+            live++;
+        }
+        else
+        {
+            if (blocks[step.id] == nullptr) continue;
+
+            // Another block written over this one would show here
+            for (uint32_t j = 0; j < sizes[step.id]; j++)
+            {
+                CHECK(blocks[step.id][j] == (uint8_t) step.id);
+            }
+
+            allocator.free(blocks[step.id]);
+            blocks[step.id] = nullptr;
+            live--;
+        }
+
+        getStats(allocator, stats);
+        CHECK(stats.allocations - stats.frees == live);
+        CHECK(stats.minimumFree <= stats.free);
+        CHECK(stats.largestBlock <= stats.free);
+
+        fragmentation = Heap::getFragmentation(stats);
+        allocator.fragmentation += fragmentation;
+        allocator.samples++;
+        if (fragmentation > allocator.maxFragmentation)
+        {
+            allocator.maxFragmentation = fragmentation;
+        }
+    }
+
+    // Free the blocks of a trace that does not free everything
+    for (uint32_t i = 0; i < blocks.size(); i++)
+    {
+        allocator.free(blocks[i]);
+    }
+
+    // Every byte is back, although heap_2 may keep it in pieces
+    getStats(allocator, stats);
+    CHECK(stats.free == allocator.initialFree);
+    CHECK(stats.allocations == stats.frees);
+
+    return true;
+}
+
+static bool testFragmentation(void)
+{
+    HeapStats stats = {};
+
+    // Nothing free is not fragmented
+    CHECK(Heap::getFragmentation(stats) == 0);
+
+    stats.free = 1000;
+    stats.largestBlock = 1000;
+    CHECK(Heap::getFragmentation(stats) == 0);
+
+    stats.largestBlock = 250;
+    CHECK(Heap::getFragmentation(stats) == 750);
+
+    stats.largestBlock = 1;
+    CHECK(Heap::getFragmentation(stats) == 999);
+
+    // Sizes past 22 bits are scaled down instead of overflowing
+    stats.free = 0x80000000;
+    stats.largestBlock = 0x20000000;
+    CHECK(Heap::getFragmentation(stats) == 750);
+
+    return true;
+}
+
+/**
+ * Checks the statistics of both allocators on a pattern that heap_2 cannot
+ * merge back: small blocks freed in place of a large one.
+ */
+static bool testStats(void)
+{
+    Allocator* allocators[] = {&heap2, &heap4};
+    HeapStats stats;
+    void* blocks[4];
+    void* large;
+
+    for (Allocator* allocator : allocators)
+    {
+        // Before the first allocation the heap is a single free block
+        getStats(*allocator, stats);
+        CHECK(stats.freeBlocks == 1);
+        CHECK(stats.allocations == 0 && stats.frees == 0);
+        CHECK(stats.largestBlock <= stats.free);
+        CHECK(stats.free > configTOTAL_HEAP_SIZE - 64);
+
+        large = allocator->malloc(1);
+        allocator->free(large);
+
+        getStats(*allocator, stats);
+        allocator->initialFree = stats.free;
+        CHECK(stats.allocations == 1 && stats.frees == 1);
+
+        // Four small blocks, freed again, then a block as large as all of them
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            blocks[i] = allocator->malloc(200);
+            CHECK(blocks[i] != nullptr);
+        }
+
+        getStats(*allocator, stats);
+        CHECK(stats.free < allocator->initialFree - 4 * 200);
+        CHECK(stats.minimumFree == stats.free);
+        CHECK(stats.allocations == 5);
+
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            allocator->free(blocks[i]);
+        }
+
+        getStats(*allocator, stats);
+        CHECK(stats.free == allocator->initialFree);
+        CHECK(stats.minimumFree < stats.free);
+        CHECK(stats.frees == 5);
+    }
+
+    // heap_4 merges the blocks back into one, heap_2 keeps the pieces
+    getStats(heap4, stats);
+    CHECK(stats.freeBlocks == 1);
+    CHECK(Heap::getFragmentation(stats) == 0);
+
+    getStats(heap2, stats);
+    CHECK(stats.freeBlocks > 1);
+    CHECK(Heap::getFragmentation(stats) > 0);
+
+    return true;
+}
+
+/**
+ * Checks that heap_1 and heap_3 keep the statistics that they can, so that
+ * Heap links with every allocator.
+ */
+static bool testSimpleHeaps(void)
+{
+    HeapStats_t heapStats;
+    void* block;
+
+    // heap_1 hands out the heap in order, what is left is a single block
+    CHECK(heap1Malloc(200) != NULL);
+    CHECK(heap1Malloc(56) != NULL);
+    heap1GetHeapStats(&heapStats);
+    CHECK(heapStats.xAvailableHeapSpaceInBytes == configTOTAL_HEAP_SIZE - portBYTE_ALIGNMENT - 256);
+    CHECK(heapStats.xSizeOfLargestFreeBlockInBytes == heapStats.xAvailableHeapSpaceInBytes);
+    CHECK(heapStats.xNumberOfFreeBlocks == 1);
+    CHECK(heapStats.xNumberOfSuccessfulAllocations == 2);
+    CHECK(heapStats.xNumberOfSuccessfulFrees == 0);
+
+    // heap_3 only counts the calls to the C library
+    block = heap3Malloc(200);
+    CHECK(block != NULL);
+    heap3Free(block);
+    heap3GetHeapStats(&heapStats);
+    CHECK(heapStats.xAvailableHeapSpaceInBytes == 0);
+    CHECK(heapStats.xNumberOfSuccessfulAllocations == 1);
+    CHECK(heapStats.xNumberOfSuccessfulFrees == 1);
+
+    return true;
+}
+
+/**
+ * Replays the same traces on both allocators and compares how fragmented
+ * they leave the heap.
+ */
+static bool testTraces(const char* path)
+{
+    std::vector<TraceStep> trace;
+    Allocator* allocators[] = {&heap2, &heap4};
+    HeapStats stats;
+
+    for (uint32_t i = 0; i < TEST_TRACES; i++)
+    {
+        generate(trace, 0x9E3779B9 * (i + 1));
+
+        CHECK(replay(heap2, trace));
+        CHECK(replay(heap4, trace));
+    }
+
+    if (path != NULL)
+    {
+        CHECK(load(trace, path));
+        CHECK(replay(heap2, trace));
+        CHECK(replay(heap4, trace));
+    }
+
+    // With every block freed heap_4 is whole again
+    getStats(heap4, stats);
+    CHECK(stats.freeBlocks == 1);
+
+    // Merging free blocks never leaves heap_4 worse off than heap_2
+    CHECK(heap4.failures <= heap2.failures);
+    CHECK(heap4.fragmentation <= heap2.fragmentation);
+
+    printf("Allocator  Failures  Fragmentation  Max fragmentation\n");
+    for (Allocator* allocator : allocators)
+    {
+        printf("%-9s  %8u  %12.1f%%  %16.1f%%\n", allocator->name, allocator->failures,
+               allocator->fragmentation / (10.0 * allocator->samples), allocator->maxFragmentation / 10.0);
+    }
+
+    return true;
+}
@@ -0,0 +1,293 @@
+/**
+ * @file       main.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host test of the MessageQueue template.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "MessageQueue.h"
+
+/*================================ define ===================================*/
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            printf("Error: %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+#define TEST_LENGTH                         ( 8 )
+#define TEST_PRODUCERS                      ( 4 )
+#define TEST_CONSUMERS                      ( 2 )
+#define TEST_MESSAGES                       ( 100000 )
+#define TEST_TIMEOUT_MS                     ( 20 )
+
+/*================================ typedef ==================================*/
+
+// A message that counts how many of its kind are alive
+class Tracked
+{
+public:
+    Tracked(uint32_t value_ = 0, uint32_t tag_ = 0):
+        value(value_), tag(tag_) {alive++;}
+    Tracked(const Tracked& other):
+        value(other.value), tag(other.tag) {alive++;}
+    Tracked& operator=(const Tracked& other) = default;
+    ~Tracked() {alive--;}
+public:
+    uint32_t value;
+    uint32_t tag;
+
+    static std::atomic<int32_t> alive;
+};
+
+// A descriptor, as a producer hands a buffer over to a consumer
+struct Descriptor
+{
+    uint32_t producer;
+    uint32_t sequence;
+};
+
+/*=============================== prototypes ================================*/
+
+static bool testOrder(void);
+static bool testEmplace(void);
+static bool testTimeout(void);
+static bool testBlocking(void);
+static bool testConcurrent(void);
+
+/*=============================== variables =================================*/
+
+std::atomic<int32_t> Tracked::alive(0);
+
+/*================================= public ==================================*/
+
+int main(void)
+{
+    bool status = true;
+
+    status &= testOrder();
+    status &= testEmplace();
+    status &= testTimeout();
+    status &= testBlocking();
+    status &= testConcurrent();
+
+    return (status ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+static bool testOrder(void)
+{
+    MessageQueue<uint32_t, TEST_LENGTH> queue;
+    uint32_t message;
+
+    CHECK(queue.isEmpty());
+    CHECK(!queue.tryReceive(message));
+    CHECK(queue.getLength() == TEST_LENGTH);
+
+    // Fill the queue a few times over, so that the slots wrap around
+    for (uint32_t lap = 0; lap < 3; lap++)
+    {
+        for (uint32_t i = 0; i < TEST_LENGTH; i++)
+        {
+            CHECK(queue.trySend(lap * TEST_LENGTH + i));
+        }
+
+        CHECK(queue.isFull());
+        CHECK(!queue.trySend(0));
+        CHECK(!queue.sendFromInterrupt(0));
+
+        for (uint32_t i = 0; i < TEST_LENGTH; i++)
+        {
+            CHECK(queue.tryReceive(message));
+            CHECK(message == lap * TEST_LENGTH + i);
+        }
+
+        CHECK(queue.isEmpty());
+    }
+
+    return true;
+}
+
+static bool testEmplace(void)
+{
+    {
+        MessageQueue<Tracked, TEST_LENGTH> queue;
+        Tracked message;
+
+        // Messages are built in their slot from the arguments
+        CHECK(queue.emplace(1, 10));
+        CHECK(queue.emplaceFromInterrupt(2, 20));
+        CHECK(queue.emplace(3, 30));
+        CHECK(Tracked::alive == 4);
+
+        // Receiving moves the message out and destroys the stored one
+        CHECK(queue.tryReceive(message));
+        CHECK(message.value == 1 && message.tag == 10);
+        CHECK(Tracked::alive == 3);
+
+        CHECK(queue.tryReceive(message));
+        CHECK(message.value == 2 && message.tag == 20);
+        CHECK(Tracked::alive == 2);
+    }
+
+    // The messages left behind are destroyed with the queue
+    CHECK(Tracked::alive == 0);
+
+    return true;
+}
+
+static bool testTimeout(void)
+{
+    MessageQueue<uint32_t, 2> queue;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::milliseconds elapsed;
+    uint32_t message;
+
+    // Receiving from an empty queue gives up after the timeout
+    start = std::chrono::steady_clock::now();
+    CHECK(!queue.receive(message, TEST_TIMEOUT_MS));
+    elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    CHECK(elapsed.count() >= TEST_TIMEOUT_MS - 1);
+
+    // Sending to a full queue too
+    CHECK(queue.send(1, TEST_TIMEOUT_MS));
+    CHECK(queue.send(2, TEST_TIMEOUT_MS));
+
+    start = std::chrono::steady_clock::now();
+    CHECK(!queue.send(3, TEST_TIMEOUT_MS));
+    elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    CHECK(elapsed.count() >= TEST_TIMEOUT_MS - 1);
+
+    CHECK(queue.receive(message, TEST_TIMEOUT_MS));
+    CHECK(message == 1);
+
+    return true;
+}
+
+static bool testBlocking(void)
+{
+    MessageQueue<uint32_t, 2> queue;
+    uint32_t message = 0;
+
+    // A receiver blocked on the empty queue wakes up on the next message
+    std::thread receiver([&queue, &message]()
+    {
+        queue.receive(message);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(TEST_TIMEOUT_MS));
+    CHECK(queue.sendFromInterrupt(42));
+    receiver.join();
+    CHECK(message == 42);
+
+    // A sender blocked on the full queue wakes up once there is room
+    CHECK(queue.trySend(1));
+    CHECK(queue.trySend(2));
+
+    std::thread sender([&queue]()
+    {
+        queue.send(3);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(TEST_TIMEOUT_MS));
+    CHECK(queue.tryReceive(message) && message == 1);
+    sender.join();
+
+    CHECK(queue.tryReceive(message) && message == 2);
+    CHECK(queue.tryReceive(message) && message == 3);
+
+    return true;
+}
+
+static bool testConcurrent(void)
+{
+    static MessageQueue<Descriptor, TEST_LENGTH> queue;
+    std::vector<std::thread> threads;
+    std::atomic<uint32_t> received(0);
+    std::atomic<bool> ordered(true);
+
+    // Half of the producers block on the full queue, the other half play
+    // the role of interrupts and retry without blocking
+    for (uint32_t p = 0; p < TEST_PRODUCERS; p++)
+    {
+        threads.push_back(std::thread([p]()
+        {
+            for (uint32_t i = 0; i < TEST_MESSAGES; i++)
+            {
+                if (p % 2 == 0)
+                {
+                    queue.send(Descriptor{p, i});
+                }
+                else
+                {
+                    while (!queue.sendFromInterrupt(Descriptor{p, i}))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        }));
+    }
+
+    // Each consumer sees the messages of a producer in the order they were
+    // sent, as it takes them one at a time from the head of the queue
+    for (uint32_t c = 0; c < TEST_CONSUMERS; c++)
+    {
+        threads.push_back(std::thread([&received, &ordered]()
+        {
+            int64_t last[TEST_PRODUCERS];
+            Descriptor descriptor;
+
+            for (uint32_t p = 0; p < TEST_PRODUCERS; p++)
+            {
+                last[p] = -1;
+            }
+
+            while (received.load() < TEST_PRODUCERS * TEST_MESSAGES)
+            {
+                if (!queue.receive(descriptor, TEST_TIMEOUT_MS)) continue;
+
+                if ((int64_t) descriptor.sequence <= last[descriptor.producer])
+                {
+                    ordered = false;
+                }
+                last[descriptor.producer] = descriptor.sequence;
+
+                received++;
+            }
+        }));
+    }
+
+    for (uint32_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+
+    CHECK(ordered);
+    CHECK(received == TEST_PRODUCERS * TEST_MESSAGES);
+    CHECK(queue.isEmpty());
+
+    printf("Passed %u descriptors from %u producers to %u consumers\n",
+           (uint32_t) received, TEST_PRODUCERS, TEST_CONSUMERS);
+
+    return true;
+}
@@ -0,0 +1,236 @@
+/**
+ * @file       main.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host test of the Packet buffers and the lock-free PacketPool.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "Packet.h"
+
+/*================================ define ===================================*/
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            printf("Error: %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+#define TEST_PACKETS                        ( 8 )
+#define TEST_SHARED_PACKETS                 ( 3 )
+#define TEST_THREADS                        ( 4 )
+#define TEST_ROUNDS                         ( 200000 )
+
+/*================================ typedef ==================================*/
+
+/*=============================== prototypes ================================*/
+
+static bool testRoom(void);
+static bool testReferences(void);
+static bool testExhausted(void);
+static bool testConcurrent(void);
+
+/*=============================== variables =================================*/
+
+static Packet packets[TEST_PACKETS];
+static PacketPool pool(packets, TEST_PACKETS);
+
+static Packet shared[TEST_SHARED_PACKETS];
+static PacketPool sharedPool(shared, TEST_SHARED_PACKETS);
+
+/*================================= public ==================================*/
+
+int main(void)
+{
+    bool status = true;
+
+    status &= testRoom();
+    status &= testReferences();
+    status &= testExhausted();
+    status &= testConcurrent();
+
+    return (status ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+static bool testRoom(void)
+{
+    Packet* packet;
+    uint8_t* data;
+
+    packet = pool.allocate();
+    CHECK(packet != nullptr);
+    CHECK(packet->getLength() == 0);
+    CHECK(packet->getHeadroom() == PACKET_HEADROOM);
+    CHECK(packet->getTailroom() == PACKET_LENGTH - PACKET_HEADROOM);
+
+    // A driver fills the tail in place and appends what it wrote
+    memset(packet->getTail(), 0xA5, 10);
+    CHECK(packet->append(10) != nullptr);
+    CHECK(packet->getData()[9] == 0xA5);
+
+    // Headers go in front of the data without moving it
+    data = packet->prepend(4);
+    CHECK(data != nullptr);
+    memset(data, 0x11, 4);
+    CHECK(packet->getLength() == 14);
+    CHECK(packet->getData()[0] == 0x11 && packet->getData()[4] == 0xA5);
+
+    // Trailers go after it
+    data = packet->append(2);
+    CHECK(data != nullptr);
+    data[0] = 0x22; data[1] = 0x33;
+    CHECK(packet->getData()[15] == 0x33);
+
+    // Parsed headers and trailers are trimmed
+    CHECK(packet->trimHead(4));
+    CHECK(packet->trimTail(2));
+    CHECK(packet->getLength() == 10);
+    CHECK(packet->getData()[0] == 0xA5);
+
+    // The room is never overrun
+    CHECK(packet->prepend(packet->getHeadroom() + 1) == nullptr);
+    CHECK(packet->append(packet->getTailroom() + 1) == nullptr);
+    CHECK(!packet->trimHead(11));
+    CHECK(packet->getLength() == 10);
+
+    packet->release();
+    CHECK(pool.getFree() == TEST_PACKETS);
+
+    return true;
+}
+
+static bool testReferences(void)
+{
+    Packet* packet;
+
+    packet = pool.allocate();
+    CHECK(packet != nullptr);
+    CHECK(pool.getFree() == TEST_PACKETS - 1);
+
+    // The packet stays out until every holder has released it
+    packet->retain();
+    packet->release();
+    CHECK(pool.getFree() == TEST_PACKETS - 1);
+
+    packet->release();
+    CHECK(pool.getFree() == TEST_PACKETS);
+
+    return true;
+}
+
+static bool testExhausted(void)
+{
+    std::vector<Packet*> taken;
+    Packet* packet;
+
+    // Every packet can be taken once
+    while ((packet = pool.allocate()) != nullptr)
+    {
+        for (uint32_t i = 0; i < taken.size(); i++)
+        {
+            CHECK(taken[i] != packet);
+        }
+        taken.push_back(packet);
+    }
+
+    CHECK(taken.size() == TEST_PACKETS);
+    CHECK(pool.getFree() == 0);
+    CHECK(pool.getFailed() == 1);
+
+    for (uint32_t i = 0; i < taken.size(); i++)
+    {
+        taken[i]->release();
+    }
+
+    CHECK(pool.getFree() == TEST_PACKETS);
+
+    return true;
+}
+
+static bool testConcurrent(void)
+{
+    std::atomic<uint32_t> owner[TEST_SHARED_PACKETS];
+    Packet* taken[TEST_SHARED_PACKETS];
+    std::atomic<bool> status(true);
+    std::vector<std::thread> threads;
+
+    for (uint32_t i = 0; i < TEST_SHARED_PACKETS; i++)
+    {
+        owner[i] = 0;
+    }
+
+    // Threads play the role of tasks and interrupt handlers, with fewer
+    // packets than threads so that the pool also runs out
+    for (uint32_t t = 1; t <= TEST_THREADS; t++)
+    {
+        threads.push_back(std::thread([t, &owner, &status]()
+        {
+            for (uint32_t i = 0; i < TEST_ROUNDS && status; i++)
+            {
+                Packet* packet = sharedPool.allocate();
+                if (packet == nullptr) continue;
+
+                // No other thread may hold the same packet
+                uint32_t index = packet - shared;
+                uint32_t none = 0;
+                if (!owner[index].compare_exchange_strong(none, t))
+                {
+                    printf("Error: packet %u allocated twice\n", index);
+                    status = false;
+                }
+
+                packet->getTail()[0] = (uint8_t) t;
+                packet->append(1);
+
+                owner[index] = 0;
+                packet->release();
+            }
+        }));
+    }
+
+    for (uint32_t i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+
+    CHECK(status);
+    CHECK(sharedPool.getFree() == TEST_SHARED_PACKETS);
+
+    // The free stack is intact, every packet can still be taken once
+    for (uint32_t i = 0; i < TEST_SHARED_PACKETS; i++)
+    {
+        taken[i] = sharedPool.allocate();
+        CHECK(taken[i] != nullptr);
+    }
+
+    CHECK(sharedPool.allocate() == nullptr);
+
+    for (uint32_t i = 0; i < TEST_SHARED_PACKETS; i++)
+    {
+        taken[i]->release();
+    }
+
+    printf("Shared %u packets between %u threads, %u allocations failed\n",
+           TEST_SHARED_PACKETS, TEST_THREADS, sharedPool.getFailed());
+
+    return true;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file       InterruptHandler.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host stand-in for the interrupt dispatch of the radio.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef INTERRUPT_HANDLER_H_
+#define INTERRUPT_HANDLER_H_
+
+#include "Radio.h"
+
+// Calls into the protected handlers as the platform InterruptHandler does
+class InterruptHandler
+{
+public:
+    static InterruptHandler& getInstance(void)
+    {
+        static InterruptHandler instance;
+        return instance;
+    }
+
+    static void setInterruptHandler(Radio* radio)
+    {
+    }
+
+    static void radioRx(Radio& radio)
+    {
+        radio.interruptHandler();
+    }
+
+    static void radioDma(Radio& radio)
+    {
+        radio.dmaHandler();
+    }
+
+    static void radioDeferred(Radio& radio)
+    {
+        radio.deferredHandler();
+    }
+};
+
+#endif /* INTERRUPT_HANDLER_H_ */
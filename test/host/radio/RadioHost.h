@@ -0,0 +1,51 @@
+/**
+ * @file       RadioHost.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host stand-in for the RF FIFOs behind the RFDATA register.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef RADIO_HOST_H_
+#define RADIO_HOST_H_
+
+#include <stdint.h>
+
+#include <deque>
+#include <vector>
+
+// Bytes that RFDATA returns next, i.e. the received frames
+extern std::deque<uint8_t> radioRxFifo;
+
+// Bytes written to RFDATA, i.e. the frame to transmit
+extern std::vector<uint8_t> radioTxFifo;
+
+// Number of accesses to RFDATA, as each one costs a bus cycle
+extern uint32_t radioDataAccesses;
+
+// Whether the RF core interrupt is enabled, and the deferred one pending
+extern bool radioInterruptEnabled;
+extern bool radioDeferredPending;
+
+// BASEPRI at the last read of RFDATA, i.e. what the reader masked
+extern uint32_t radioDataBasepri;
+
+// The interrupt masks and the cycle counter of CriticalSection
+extern uint32_t hostPrimask;
+extern uint32_t hostBasepri;
+extern uint32_t hostCycles;
+
+// Number of CCAs that find the channel busy before it is clear
+extern uint32_t radioBusyCcas;
+
+// Number of CCAs and of backoff periods that the CSP program waited
+extern uint32_t radioCcas;
+extern uint32_t radioBackoffs;
+
+// Raises the CSP_STOP interrupt once the CSP program stops, in the test
+void radioCspStopped(void);
+
+#endif /* RADIO_HOST_H_ */
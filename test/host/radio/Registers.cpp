@@ -0,0 +1,311 @@
+/**
+ * @file       Registers.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host register file with the RF FIFOs and stubs for the
+ *             libcc2538 functions that the radio links against.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <map>
+#include <vector>
+
+#include "RadioHost.h"
+
+#include "Radio.h"
+
+#include "cc2538_include.h"
+#include "cc2538_defines.h"
+
+/*================================ define ===================================*/
+
+/*================================ typedef ==================================*/
+
+/*=============================== variables =================================*/
+
+// Registers are created as zero on first access and never move
+static std::map<uint32_t, uint32_t> registers;
+
+// Instructions loaded to the CSP program memory
+static std::vector<uint8_t> cspProgram;
+
+std::deque<uint8_t> radioRxFifo;
+std::vector<uint8_t> radioTxFifo;
+uint32_t radioDataAccesses;
+uint32_t radioBusyCcas;
+bool radioInterruptEnabled;
+bool radioDeferredPending;
+uint32_t radioDataBasepri;
+uint32_t radioCcas;
+uint32_t radioBackoffs;
+
+// The interrupt masks and the cycle counter of CriticalSection
+uint32_t hostPrimask;
+uint32_t hostBasepri;
+uint32_t hostCycles;
+
+/*=============================== prototypes ================================*/
+
+static bool cspCondition(uint8_t condition);
+static void cspRun(void);
+
+/*================================= public ==================================*/
+
+extern "C" volatile uint32_t* hostRegister(uint32_t address)
+{
+    return &registers[address];
+}
+
+uint32_t hostRead(uint32_t address)
+{
+    uint32_t value = 0;
+
+    switch (address)
+    {
+        case RFCORE_SFR_RFDATA:
+            // Reading pops the oldest byte of the RX FIFO
+            radioDataAccesses++;
+            radioDataBasepri = hostBasepri;
+            if (!radioRxFifo.empty())
+            {
+                value = radioRxFifo.front();
+                radioRxFifo.pop_front();
+            }
+            break;
+        case RFCORE_XREG_RXFIRST:
+            // The oldest byte of the RX FIFO, which stays there
+            if (!radioRxFifo.empty())
+            {
+                value = radioRxFifo.front();
+            }
+            break;
+        case RFCORE_XREG_RXFIFOCNT:
+            value = radioRxFifo.size();
+            break;
+        default:
+            value = registers[address];
+            break;
+    }
+
+    return value;
+}
+
+void hostWrite(uint32_t address, uint32_t value)
+{
+    switch (address)
+    {
+        case RFCORE_SFR_RFDATA:
+            // Writing pushes a byte to the TX FIFO
+            radioDataAccesses++;
+            radioTxFifo.push_back((uint8_t) value);
+            break;
+        case RFCORE_SFR_RFST:
+            // The flush strobes empty the FIFOs, ISTXON starts transmitting,
+            // ISCLEAR and ISSTART handle the program, the rest is loaded
+            if (value == CC2538_RF_CSP_OP_ISFLUSHRX)
+            {
+                radioRxFifo.clear();
+            }
+            else if (value == CC2538_RF_CSP_OP_ISFLUSHTX)
+            {
+                radioTxFifo.clear();
+            }
+            else if (value == CC2538_RF_CSP_OP_ISTXON)
+            {
+                // Transmitting until the test is done with the frame
+                registers[RFCORE_XREG_FSMSTAT1] |= RFCORE_XREG_FSMSTAT1_TX_ACTIVE;
+            }
+            else if (value == CC2538_RF_CSP_OP_ISCLEAR)
+            {
+                cspProgram.clear();
+            }
+            else if (value == CC2538_RF_CSP_OP_ISSTART)
+            {
+                cspRun();
+            }
+            else if ((value & 0xE0) != 0xE0)
+            {
+                cspProgram.push_back((uint8_t) value);
+            }
+            registers[address] = value;
+            break;
+        case RFCORE_SFR_MTCTRL:
+            // The MAC timer runs as soon as it is started
+            registers[address] = value;
+            if (value & RFCORE_SFR_MTCTRL_RUN)
+            {
+                registers[address] |= RFCORE_SFR_MTCTRL_STATE;
+            }
+            break;
+        default:
+            registers[address] = value;
+            break;
+    }
+}
+
+void SysCtrlPeripheralEnable(uint32_t peripheral)
+{
+}
+
+void SysCtrlPeripheralSleepEnable(uint32_t peripheral)
+{
+}
+
+void SysCtrlPeripheralDeepSleepDisable(uint32_t peripheral)
+{
+}
+
+void IntRegister(uint32_t interrupt, void (*handler)(void))
+{
+}
+
+void IntUnregister(uint32_t interrupt)
+{
+}
+
+void IntEnable(uint32_t interrupt)
+{
+    if (interrupt == INT_RFCORERTX)
+    {
+        radioInterruptEnabled = true;
+    }
+}
+
+void IntDisable(uint32_t interrupt)
+{
+    if (interrupt == INT_RFCORERTX)
+    {
+        radioInterruptEnabled = false;
+    }
+}
+
+void IntPendSet(uint32_t interrupt)
+{
+    if (interrupt == RADIO_DEFERRED_INTERRUPT)
+    {
+        radioDeferredPending = true;
+    }
+}
+
+void IntPendClear(uint32_t interrupt)
+{
+    if (interrupt == RADIO_DEFERRED_INTERRUPT)
+    {
+        radioDeferredPending = false;
+    }
+}
+
+void IntPrioritySet(uint32_t interrupt, uint8_t priority)
+{
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+/**
+ * Evaluates a condition of SKIP and RPT. The CCA is busy as many times as
+ * radioBusyCcas tells, and each sample counts in radioCcas.
+ */
+static bool cspCondition(uint8_t condition)
+{
+    bool result = false;
+
+    switch (condition & ~CC2538_RF_CSP_CC_NOT)
+    {
+        case CC2538_RF_CSP_CC_CCA:
+            radioCcas++;
+            result = (radioBusyCcas == 0);
+            if (radioBusyCcas > 0)
+            {
+                radioBusyCcas--;
+            }
+            break;
+        case CC2538_RF_CSP_CC_X_ZERO:
+            result = (registers[RFCORE_XREG_CSPX] == 0);
+            break;
+        case CC2538_RF_CSP_CC_Y_ZERO:
+            result = (registers[RFCORE_XREG_CSPY] == 0);
+            break;
+        case CC2538_RF_CSP_CC_Z_ZERO:
+            result = (registers[RFCORE_XREG_CSPZ] == 0);
+            break;
+        default:
+            break;
+    }
+
+    return (condition & CC2538_RF_CSP_CC_NOT) ? !result : result;
+}
+
+/**
+ * Runs the loaded program at once, as if the MAC timer overflowed right
+ * away. RANDXY always draws ones, i.e. the longest backoffs, and WAITX
+ * adds the periods to radioBackoffs. The CSP then raises CSP_STOP.
+ */
+static void cspRun(void)
+{
+    uint32_t label = 0;
+    uint32_t pc = 0;
+    uint8_t op;
+
+    while (pc < cspProgram.size())
+    {
+        op = cspProgram[pc++];
+
+        if (op == CC2538_RF_CSP_OP_STOP)
+        {
+            break;
+        }
+        else if (op == CC2538_RF_CSP_OP_LABEL)
+        {
+            label = pc;
+        }
+        else if (op == CC2538_RF_CSP_OP_RANDXY)
+        {
+            registers[RFCORE_XREG_CSPX] = (1 << registers[RFCORE_XREG_CSPY]) - 1;
+        }
+        else if (op == CC2538_RF_CSP_OP_WAITX)
+        {
+            radioBackoffs += registers[RFCORE_XREG_CSPX];
+            registers[RFCORE_XREG_CSPX] = 0;
+        }
+        else if (op == CC2538_RF_CSP_OP_DECZ)
+        {
+            registers[RFCORE_XREG_CSPZ]--;
+        }
+        else if ((op & 0xF8) == CC2538_RF_CSP_OP_INCMAXY(0))
+        {
+            if (registers[RFCORE_XREG_CSPY] < (op & 0x07u))
+            {
+                registers[RFCORE_XREG_CSPY]++;
+            }
+        }
+        else if ((op & 0xF0) == CC2538_RF_CSP_OP_RPT(0))
+        {
+            if (cspCondition(op & 0x0F))
+            {
+                pc = label;
+            }
+        }
+        else if ((op & 0x80) == 0)
+        {
+            if (cspCondition(op & 0x0F))
+            {
+                pc += (op >> 4) & 0x07;
+            }
+        }
+        else if (op == CC2538_RF_CSP_OP_STXONCCA)
+        {
+            // The CCA was just sampled clear, so the radio starts
+            registers[RFCORE_XREG_FSMSTAT1] |= RFCORE_XREG_FSMSTAT1_SAMPLED_CCA |
+                                               RFCORE_XREG_FSMSTAT1_TX_ACTIVE;
+        }
+    }
+
+    radioCspStopped();
+}
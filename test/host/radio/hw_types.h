@@ -0,0 +1,92 @@
+/**
+ * @file       hw_types.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host stand-in for the libcc2538 hw_types.h that redirects the
+ *             register accesses to a register file in memory. Accesses from
+ *             C++ go through hooks, so that the RF FIFOs can be emulated.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef __HW_TYPES_H__
+#define __HW_TYPES_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned char tBoolean;
+
+// Returns the value of the register at the given address
+volatile uint32_t* hostRegister(uint32_t address);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+
+// Reads and writes a register, emulating the registers with side effects
+uint32_t hostRead(uint32_t address);
+void hostWrite(uint32_t address, uint32_t value);
+
+class HostRegister
+{
+public:
+    explicit HostRegister(uint32_t address):
+        address_(address)
+    {
+    }
+
+    operator uint32_t() const
+    {
+        return hostRead(address_);
+    }
+
+    HostRegister& operator=(uint32_t value)
+    {
+        hostWrite(address_, value);
+        return *this;
+    }
+
+    HostRegister& operator=(const HostRegister& other)
+    {
+        return (*this = (uint32_t) other);
+    }
+
+    HostRegister& operator|=(uint32_t value)
+    {
+        return (*this = (hostRead(address_) | value));
+    }
+
+    HostRegister& operator&=(uint32_t value)
+    {
+        return (*this = (hostRead(address_) & value));
+    }
+
+private:
+    uint32_t address_;
+};
+
+#define HWREG(x)                                                              \
+        (HostRegister((uint32_t)(x)))
+
+#else
+
+#define HWREG(x)                                                              \
+        (*hostRegister((uint32_t)(x)))
+
+#endif
+
+#define HWREGH(x)                                                             \
+        (*(volatile uint16_t *) hostRegister((uint32_t)(x)))
+#define HWREGB(x)                                                             \
+        (*(volatile unsigned char *) hostRegister((uint32_t)(x)))
+
+#endif // __HW_TYPES_H__
@@ -0,0 +1,851 @@
+/**
+ * @file       main.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host test of the radio frame handling and filtering, with and
+ *             without the uDMA, against a register fake of the RF FIFOs.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "InterruptHandler.h"
+#include "RadioHost.h"
+
+#include "Callback.h"
+#include "Packet.h"
+#include "Radio.h"
+
+#include "cc2538_include.h"
+#include "cc2538_defines.h"
+
+/*================================ define ===================================*/
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            printf("Error: %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+#define TEST_DMA_CHANNEL                ( UDMA_CH30_SW & 0xFF )
+#define TEST_RSSI                       ( -20 )
+#define TEST_CRC_LQI                    ( 0x80 | 0x55 )
+#define TEST_PACKETS                    ( 8 )
+
+/*================================ typedef ==================================*/
+
+/*=============================== prototypes ================================*/
+
+static void rxInit(void);
+static void rxDone(void);
+static void pushFrame(const std::vector<uint8_t>& payload, int8_t rssi, uint8_t crcLqi);
+static void raise(uint32_t irq);
+static void runDeferred(void);
+static void startReceive(void);
+static bool runDma(void);
+static bool checkPacket(const std::vector<uint8_t>& payload, int8_t rssi, uint8_t crcLqi);
+static bool checkQueued(const std::vector<uint8_t>& payload, int8_t rssi, uint8_t crcLqi);
+static bool testReceive(void);
+static bool testLoad(void);
+static bool testContinuous(void);
+static bool testFilter(void);
+static uint32_t getMask(uint32_t address);
+static bool testSourceMatch(void);
+static bool testReceiveDma(void);
+static bool testLoadDma(void);
+static bool testCsma(void);
+
+/*=============================== variables =================================*/
+
+// Transfers hold 32-bit addresses, so the radio and the buffers are static
+static Radio radio;
+static uint8_t txBuffer[125];
+static uint8_t dmaBuffer[RADIO_DMA_BUFFER_LENGTH];
+static uint8_t sourceTable[4 * RADIO_SOURCE_UNITS];
+
+static Packet packets[TEST_PACKETS];
+static PacketPool pool(packets, TEST_PACKETS);
+static RadioRxQueue rxQueue;
+
+static uint32_t rxInits;
+static uint32_t rxDones;
+static bool cspInterrupts = true;
+
+static const std::vector<uint8_t> frame = {0x41, 0x88, 0x01, 0xCD, 0xAB, 0xFF, 0xFF, 0x34, 0x12, 'O', 'K'};
+
+/*================================= public ==================================*/
+
+int main(void)
+{
+    bool status = true;
+
+    radio.enable();
+    radio.setRxCallbacks(Delegate::create<rxInit>(), Delegate::create<rxDone>());
+    radio.enableInterrupts();
+
+    // The radio is listening as soon as it is asked to
+    HWREG(RFCORE_XREG_FSMSTAT1) = RFCORE_XREG_FSMSTAT1_RX_ACTIVE;
+
+    status &= testReceive();
+    status &= testLoad();
+    status &= testContinuous();
+    status &= testFilter();
+    status &= testSourceMatch();
+    status &= testReceiveDma();
+    status &= testLoadDma();
+    status &= testCsma();
+
+    return (status ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/**
+ * Raises CSP_STOP once the fake CSP program stops, as the RF core does
+ * when the interrupts are enabled, and then the deferred interrupt.
+ */
+void radioCspStopped(void)
+{
+    if (cspInterrupts)
+    {
+        HWREG(RFCORE_SFR_RFIRQF0) = 0;
+        HWREG(RFCORE_SFR_RFIRQF1) = RFCORE_SFR_RFIRQF1_CSP_STOP;
+        InterruptHandler::radioRx(radio);
+        runDeferred();
+    }
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+static void rxInit(void)
+{
+    rxInits++;
+}
+
+static void rxDone(void)
+{
+    rxDones++;
+}
+
+/**
+ * Appends a frame to the RX FIFO as the radio stores it: the length byte,
+ * which counts the two CRC bytes, the payload and then the RSSI and the
+ * CRC_OK/LQI bytes in place of the CRC.
+ */
+static void pushFrame(const std::vector<uint8_t>& payload, int8_t rssi, uint8_t crcLqi)
+{
+    radioRxFifo.push_back((uint8_t) (payload.size() + 2));
+    radioRxFifo.insert(radioRxFifo.end(), payload.begin(), payload.end());
+    radioRxFifo.push_back((uint8_t) rssi);
+    radioRxFifo.push_back(crcLqi);
+}
+
+/**
+ * Raises the RF core interrupt, and then the deferred one if it pended it,
+ * as the NVIC runs them in order of priority.
+ */
+static void raise(uint32_t irq)
+{
+    HWREG(RFCORE_SFR_RFIRQF0) = irq;
+    InterruptHandler::radioRx(radio);
+    runDeferred();
+}
+
+static void runDeferred(void)
+{
+    if (radioDeferredPending)
+    {
+        InterruptHandler::radioDeferred(radio);
+    }
+}
+
+static void startReceive(void)
+{
+    radio.on();
+    radio.receive();
+
+    rxInits = 0;
+    rxDones = 0;
+}
+
+/**
+ * Runs a software-requested transfer as the uDMA controller would: moves
+ * the items, stops the structure, disables the channel and flags it done.
+ */
+static bool runDma(void)
+{
+    tDMAControlTable* table = (tDMAControlTable *) (uintptr_t) (uint32_t) HWREG(UDMA_CTLBASE);
+    tDMAControlTable* entry = &table[TEST_DMA_CHANNEL];
+    uint32_t mask = 1 << TEST_DMA_CHANNEL;
+    uint32_t control = entry->ui32Control;
+    uintptr_t source, destination;
+    bool sourceInc, destinationInc;
+    uint32_t items;
+    uint8_t byte;
+
+    // Only an enabled channel runs, once software has requested it
+    CHECK(HWREG(UDMA_ENASET) & mask);
+    CHECK(HWREG(UDMA_SWREQ) & mask);
+    CHECK((control & UDMACHCTL_CHCTL_XFERMODE_M) == UDMA_MODE_AUTO);
+
+    items = ((control & UDMACHCTL_CHCTL_XFERSIZE_M) >> UDMACHCTL_CHCTL_XFERSIZE_S) + 1;
+    sourceInc = ((control & UDMACHCTL_CHCTL_SRCINC_M) != UDMA_SRC_INC_NONE);
+    destinationInc = ((control & UDMACHCTL_CHCTL_DSTINC_M) != UDMA_DST_INC_NONE);
+
+    // The structure holds the end addresses
+    source = (uintptr_t) entry->pvSrcEndAddr - (sourceInc ? items - 1 : 0);
+    destination = (uintptr_t) entry->pvDstEndAddr - (destinationInc ? items - 1 : 0);
+
+    for (uint32_t i = 0; i < items; i++)
+    {
+        byte = sourceInc ? ((uint8_t *) source)[i] : (uint8_t) HWREG(source);
+
+        if (destinationInc)
+        {
+            ((uint8_t *) destination)[i] = byte;
+        }
+        else
+        {
+            HWREG(destination) = byte;
+        }
+    }
+
+    entry->ui32Control &= ~(UDMACHCTL_CHCTL_XFERMODE_M | UDMACHCTL_CHCTL_XFERSIZE_M);
+    HWREG(UDMA_SWREQ) = 0;
+    HWREG(UDMA_ENASET) = 0;
+    HWREG(UDMA_CHIS) = mask | (1 << 8);
+
+    return true;
+}
+
+static bool checkPacket(const std::vector<uint8_t>& payload, int8_t rssi, uint8_t crcLqi)
+{
+    uint8_t buffer[125];
+    uint8_t length = sizeof(buffer);
+    int8_t packetRssi;
+    uint8_t lqi, crc;
+
+    CHECK(radio.getPacket(buffer, &length, &packetRssi, &lqi, &crc) == RadioResult_Success);
+
+    // The CRC bytes are not part of the payload
+    CHECK(length == payload.size());
+    CHECK(memcmp(buffer, payload.data(), length) == 0);
+
+    // The RSSI is offset and the CRC_OK bit is split from the LQI
+    CHECK(packetRssi == rssi - CC2538_RF_RSSI_OFFSET);
+    CHECK(crc == (crcLqi & 0x80));
+    CHECK(lqi == (crcLqi & 0x7F));
+
+    return true;
+}
+
+/**
+ * Takes the next packet that the radio has queued in continuous mode,
+ * checks it as checkPacket does and releases it.
+ */
+static bool checkQueued(const std::vector<uint8_t>& payload, int8_t rssi, uint8_t crcLqi)
+{
+    Packet* packet;
+    int8_t packetRssi;
+    uint8_t lqi, crc;
+
+    CHECK(rxQueue.tryReceive(packet));
+    CHECK(radio.getPacket(packet, &packetRssi, &lqi, &crc) == RadioResult_Success);
+
+    // The packet is left with the payload only
+    CHECK(packet->getLength() == payload.size());
+    CHECK(memcmp(packet->getData(), payload.data(), payload.size()) == 0);
+
+    CHECK(packetRssi == rssi - CC2538_RF_RSSI_OFFSET);
+    CHECK(crc == (crcLqi & 0x80));
+    CHECK(lqi == (crcLqi & 0x7F));
+
+    packet->release();
+
+    return true;
+}
+
+static bool testReceive(void)
+{
+    uint8_t buffer[125];
+    uint8_t length;
+    int8_t rssi;
+    uint8_t lqi, crc;
+
+    // A frame is handed over at the end of the frame
+    startReceive();
+    pushFrame(frame, TEST_RSSI, TEST_CRC_LQI);
+    raise(RFCORE_SFR_RFIRQF0_SFD);
+    CHECK(rxInits == 1 && rxDones == 0);
+    raise(RFCORE_SFR_RFIRQF0_RXPKTDONE);
+    CHECK(rxDones == 1);
+
+    // Every byte is read from RFDATA
+    radioDataAccesses = 0;
+    CHECK(checkPacket(frame, TEST_RSSI, TEST_CRC_LQI));
+    CHECK(radioDataAccesses == frame.size() + 3);
+    CHECK(radioRxFifo.empty());
+
+    // Nothing is read twice
+    length = sizeof(buffer);
+    CHECK(radio.getPacket(buffer, &length, &rssi, &lqi, &crc) == RadioResult_Error);
+
+    // A failed CRC is reported as such
+    startReceive();
+    pushFrame(frame, TEST_RSSI, 0x12);
+    raise(RFCORE_SFR_RFIRQF0_SFD | RFCORE_SFR_RFIRQF0_RXPKTDONE);
+    CHECK(checkPacket(frame, TEST_RSSI, 0x12));
+
+    // A frame that does not fit in the buffer is flushed
+    startReceive();
+    pushFrame(frame, TEST_RSSI, TEST_CRC_LQI);
+    raise(RFCORE_SFR_RFIRQF0_SFD | RFCORE_SFR_RFIRQF0_RXPKTDONE);
+    length = frame.size() - 1;
+    CHECK(radio.getPacket(buffer, &length, &rssi, &lqi, &crc) == RadioResult_Error);
+    CHECK(radioRxFifo.empty());
+
+    // So is a frame with a length byte that is not valid
+    startReceive();
+    radioRxFifo.assign({2, 0xEC, 0x80});
+    raise(RFCORE_SFR_RFIRQF0_SFD | RFCORE_SFR_RFIRQF0_RXPKTDONE);
+    length = sizeof(buffer);
+    CHECK(radio.getPacket(buffer, &length, &rssi, &lqi, &crc) == RadioResult_Error);
+    CHECK(radioRxFifo.empty());
+
+    return true;
+}
+
+static bool testLoad(void)
+{
+    memcpy(txBuffer, frame.data(), frame.size());
+
+    radio.on();
+    radioTxFifo.clear();
+    radioDataAccesses = 0;
+
+    // The length byte counts the CRC that the radio appends
+    CHECK(radio.loadPacket(txBuffer, frame.size()) == RadioResult_Success);
+    CHECK(radioTxFifo.size() == frame.size() + 1);
+    CHECK(radioTxFifo[0] == frame.size() + 2);
+    CHECK(memcmp(&radioTxFifo[1], frame.data(), frame.size()) == 0);
+    CHECK(radioDataAccesses == frame.size() + 1);
+
+    // Frames that do not fit are refused
+    CHECK(radio.loadPacket(txBuffer, 126) == RadioResult_Error);
+    CHECK(radio.loadPacket(txBuffer, 1) == RadioResult_Error);
+
+    return true;
+}
+
+static bool testContinuous(void)
+{
+    std::vector<Packet*> taken;
+    RadioRxStats stats;
+    Packet* packet;
+    uint8_t buffer[125];
+    uint8_t length = sizeof(buffer);
+    int8_t rssi;
+    uint8_t lqi, crc;
+
+    radio.enableContinuous(pool, rxQueue);
+    startReceive();
+
+    // Every complete frame goes to a packet, the one being received stays
+    pushFrame(frame, TEST_RSSI, TEST_CRC_LQI);
+    pushFrame(std::vector<uint8_t>(frame.begin(), frame.begin() + 5), -40, 0x7F);
+    radioRxFifo.insert(radioRxFifo.end(), {20, 0x41, 0x88});
+    radioDataAccesses = 0;
+    raise(RFCORE_SFR_RFIRQF0_RXPKTDONE);
+    CHECK(rxDones == 1);
+    CHECK(radioRxFifo.size() == 3);
+    CHECK(pool.getFree() == TEST_PACKETS - 2);
+
+    // Each byte is read from the RX FIFO once, straight into the packet
+    CHECK(radioDataAccesses == (frame.size() + 3) + (5 + 3));
+
+    CHECK(checkQueued(frame, TEST_RSSI, TEST_CRC_LQI));
+    CHECK(checkQueued(std::vector<uint8_t>(frame.begin(), frame.begin() + 5), -40, 0x7F));
+    CHECK(rxQueue.isEmpty());
+    CHECK(pool.getFree() == TEST_PACKETS);
+
+    radio.getRxStats(stats);
+    CHECK(stats.frames == 2);
+    CHECK(stats.dropped == 0 && stats.overflows == 0 && stats.errors == 0);
+
+    // The frames past a full queue are dropped and their packets returned
+    radioRxFifo.clear();
+    for (uint32_t i = 0; i < RADIO_RX_PACKETS + 1; i++)
+    {
+        pushFrame(frame, TEST_RSSI, TEST_CRC_LQI);
+    }
+    raise(RFCORE_SFR_RFIRQF0_RXPKTDONE);
+    CHECK(radioRxFifo.empty());
+    CHECK(pool.getFree() == TEST_PACKETS - RADIO_RX_PACKETS);
+
+    for (uint32_t i = 0; i < RADIO_RX_PACKETS; i++)
+    {
+        CHECK(checkQueued(frame, TEST_RSSI, TEST_CRC_LQI));
+    }
+
+    radio.getRxStats(stats);
+    CHECK(stats.frames == 2 + RADIO_RX_PACKETS);
+    CHECK(stats.dropped == 1);
+
+    // Without a free packet the frames are taken out and dropped
+    while ((packet = pool.allocate()) != nullptr)
+    {
+        taken.push_back(packet);
+    }
+    pushFrame(frame, TEST_RSSI, TEST_CRC_LQI);
+    raise(RFCORE_SFR_RFIRQF0_RXPKTDONE);
+    CHECK(radioRxFifo.empty());
+    CHECK(rxQueue.isEmpty());
+
+    radio.getRxStats(stats);
+    CHECK(stats.dropped == 2);
+
+    for (Packet* held : taken)
+    {
+        held->release();
+    }
+
+    // The interrupt handler makes no kernel calls, the deferred one sends
+    // the frames to the queue
+    rxDones = 0;
+    pushFrame(frame, TEST_RSSI, TEST_CRC_LQI);
+    HWREG(RFCORE_SFR_RFIRQF0) = RFCORE_SFR_RFIRQF0_RXPKTDONE;
+    InterruptHandler::radioRx(radio);
+    CHECK(radioDeferredPending);
+    CHECK(rxQueue.isEmpty() && rxDones == 0);
+    runDeferred();
+    CHECK(!radioDeferredPending);
+    CHECK(rxDones == 1);
+    CHECK(checkQueued(frame, TEST_RSSI, TEST_CRC_LQI));
+
+    // Turning off queues the complete frames with the interrupt masked
+    pushFrame(frame, TEST_RSSI, TEST_CRC_LQI);
+    radioRxFifo.insert(radioRxFifo.end(), {20, 0x41, 0x88});
+    HWREG(RFCORE_XREG_RXENABLE) = 1;
+    radio.off();
+    CHECK(radioDataBasepri == RADIO_INTERRUPT_PRIORITY);
+    CHECK(hostBasepri == 0);
+    CHECK(radioInterruptEnabled);
+    CHECK(HWREG(RFCORE_XREG_RFIRQM0) != 0);
+    CHECK(radioRxFifo.empty());
+    runDeferred();
+    CHECK(checkQueued(frame, TEST_RSSI, TEST_CRC_LQI));
+    HWREG(RFCORE_XREG_RXENABLE) = 0;
+
+    // The frames only come in packets
+    CHECK(radio.getPacket(buffer, &length, &rssi, &lqi, &crc) == RadioResult_Error);
+
+    radio.disableContinuous();
+
+    return true;
+}
+
+static bool testFilter(void)
+{
+    const uint8_t address[8] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+
+    // The radio starts promiscuous, frames start at SFD
+    CHECK(radio.isPromiscuous());
+    CHECK(!(HWREG(RFCORE_XREG_FRMFILT0) & RFCORE_XREG_FRMFILT0_FRAME_FILTER_EN));
+    CHECK(HWREG(RFCORE_XREG_RFIRQM0) & RFCORE_SFR_RFIRQF0_SFD);
+    CHECK(!(HWREG(RFCORE_XREG_RFIRQM0) & RFCORE_SFR_RFIRQF0_FRAME_ACCEPTED));
+
+    radio.setPanId(0xABCD);
+    radio.setShortAddress(0x1234);
+    radio.setExtendedAddress(address);
+    radio.enableFilter(RadioFilter_Data | RadioFilter_Ack | RadioFilter_AutoAck);
+    CHECK(!radio.isPromiscuous());
+
+    // The addresses go least significant byte first
+    CHECK(HWREG(RFCORE_FFSM_PAN_ID0) == 0xCD && HWREG(RFCORE_FFSM_PAN_ID1) == 0xAB);
+    CHECK(HWREG(RFCORE_FFSM_SHORT_ADDR0) == 0x34 && HWREG(RFCORE_FFSM_SHORT_ADDR1) == 0x12);
+    for (uint32_t i = 0; i < sizeof(address); i++)
+    {
+        CHECK(HWREG(RFCORE_FFSM_EXT_ADDR0 + 4 * i) == address[i]);
+    }
+
+    // Only data and ACK frames are accepted, and acknowledged by the radio
+    CHECK(HWREG(RFCORE_XREG_FRMFILT0) & RFCORE_XREG_FRMFILT0_FRAME_FILTER_EN);
+    CHECK(!(HWREG(RFCORE_XREG_FRMFILT0) & RFCORE_XREG_FRMFILT0_PAN_COORDINATOR));
+    CHECK(HWREG(RFCORE_XREG_FRMFILT1) == (RFCORE_XREG_FRMFILT1_ACCEPT_FT_1_DATA | RFCORE_XREG_FRMFILT1_ACCEPT_FT_2_ACK));
+    CHECK(HWREG(RFCORE_XREG_FRMCTRL0) == (RFCORE_XREG_FRMCTRL0_AUTOCRC | RFCORE_XREG_FRMCTRL0_AUTOACK));
+
+    // The frames of other nodes raise no interrupt
+    CHECK(!(HWREG(RFCORE_XREG_RFIRQM0) & RFCORE_SFR_RFIRQF0_SFD));
+    CHECK(HWREG(RFCORE_XREG_RFIRQM0) & RFCORE_SFR_RFIRQF0_FRAME_ACCEPTED);
+
+    // Receiving starts once a frame is accepted, not at its SFD
+    startReceive();
+    raise(RFCORE_SFR_RFIRQF0_SFD);
+    CHECK(rxInits == 0);
+    raise(RFCORE_SFR_RFIRQF0_FRAME_ACCEPTED);
+    CHECK(rxInits == 1);
+    pushFrame(frame, TEST_RSSI, TEST_CRC_LQI);
+    raise(RFCORE_SFR_RFIRQF0_RXPKTDONE);
+    CHECK(rxDones == 1);
+    CHECK(checkPacket(frame, TEST_RSSI, TEST_CRC_LQI));
+
+    // SFD is unmasked while transmitting only
+    memcpy(txBuffer, frame.data(), frame.size());
+    radio.on();
+    CHECK(radio.loadPacket(txBuffer, frame.size()) == RadioResult_Success);
+    radio.transmit();
+    CHECK(HWREG(RFCORE_XREG_RFIRQM0) & RFCORE_SFR_RFIRQF0_SFD);
+    HWREG(RFCORE_XREG_FSMSTAT1) &= ~RFCORE_XREG_FSMSTAT1_TX_ACTIVE;
+    HWREG(RFCORE_SFR_RFIRQF1) = RFCORE_SFR_RFIRQF1_TXDONE;
+    raise(0);
+    CHECK(!(HWREG(RFCORE_XREG_RFIRQM0) & RFCORE_SFR_RFIRQF0_SFD));
+
+    // Without a frame type all of them are accepted
+    radio.enableFilter(RadioFilter_PanCoordinator);
+    CHECK(HWREG(RFCORE_XREG_FRMFILT1) == (RFCORE_XREG_FRMFILT1_ACCEPT_FT_0_BEACON | RFCORE_XREG_FRMFILT1_ACCEPT_FT_1_DATA |
+                                          RFCORE_XREG_FRMFILT1_ACCEPT_FT_2_ACK | RFCORE_XREG_FRMFILT1_ACCEPT_FT_3_MAC_CMD));
+    CHECK(HWREG(RFCORE_XREG_FRMFILT0) & RFCORE_XREG_FRMFILT0_PAN_COORDINATOR);
+    CHECK(!(HWREG(RFCORE_XREG_FRMCTRL0) & RFCORE_XREG_FRMCTRL0_AUTOACK));
+
+    // The filter survives a sleep
+    radio.sleep();
+    radio.wakeup();
+    CHECK(HWREG(RFCORE_XREG_FRMFILT0) & RFCORE_XREG_FRMFILT0_FRAME_FILTER_EN);
+    CHECK(HWREG(RFCORE_FFSM_PAN_ID0) == 0xCD);
+
+    // Promiscuous mode is back to receiving everything
+    radio.setPromiscuous();
+    CHECK(!(HWREG(RFCORE_XREG_FRMFILT0) & RFCORE_XREG_FRMFILT0_FRAME_FILTER_EN));
+    CHECK(!(HWREG(RFCORE_XREG_FRMCTRL0) & RFCORE_XREG_FRMCTRL0_AUTOACK));
+    CHECK(HWREG(RFCORE_XREG_RFIRQM0) & RFCORE_SFR_RFIRQF0_SFD);
+    CHECK(!(HWREG(RFCORE_XREG_RFIRQM0) & RFCORE_SFR_RFIRQF0_FRAME_ACCEPTED));
+
+    return true;
+}
+
+/**
+ * Reads a 24-bit source match mask split over three registers.
+ */
+static uint32_t getMask(uint32_t address)
+{
+    return (HWREG(address + 0) << 0) | (HWREG(address + 4) << 8) | (HWREG(address + 8) << 16);
+}
+
+static bool testSourceMatch(void)
+{
+    const uint8_t address[8] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+    int32_t child, sensor, node, other;
+
+    // Frame pending is set by the radio when asked to
+    radio.enableFilter(RadioFilter_Data | RadioFilter_AutoAck | RadioFilter_AutoPend);
+    CHECK(HWREG(RFCORE_XREG_SRCMATCH) == (RFCORE_XREG_SRCMATCH_SRC_MATCH_EN | RFCORE_XREG_SRCMATCH_AUTOPEND |
+                                          RFCORE_XREG_SRCMATCH_PEND_DATAREQ_ONLY));
+
+    // Without a table there are no entries, and only the units that fit
+    // in the table are used
+    CHECK(radio.addSource(0xABCD, 0x0001, true) == -1);
+    radio.setSourceTable(sourceTable, 8 + 3);
+    CHECK(radio.addSource(0xABCD, 0x0001, true) == 0);
+    CHECK(radio.addSource(0xABCD, 0x0002, true) == 1);
+    CHECK(radio.addSource(0xABCD, 0x0003, true) == -1);
+    CHECK(radio.addSource(address, false) == -1);
+    CHECK(radio.removeSource(0) && radio.removeSource(1));
+    CHECK(!radio.removeSource(2));
+    radio.setSourceTable(sourceTable, sizeof(sourceTable));
+
+    // Short entries take one unit, least significant byte first
+    child = radio.addSource(0xABCD, 0x0001, true);
+    CHECK(child == 0);
+    CHECK(HWREG(FRMF_SRCM_RAM_BASE + 0x0) == 0xCD && HWREG(FRMF_SRCM_RAM_BASE + 0x4) == 0xAB);
+    CHECK(HWREG(FRMF_SRCM_RAM_BASE + 0x8) == 0x01 && HWREG(FRMF_SRCM_RAM_BASE + 0xC) == 0x00);
+    CHECK(getMask(RFCORE_XREG_SRCSHORTEN0) == 0x000001);
+    CHECK(getMask(RFCORE_FFSM_SRCSHORTPENDEN0) == 0x000001);
+
+    // Extended entries take the next free pair
+    sensor = radio.addSource(address, false);
+    CHECK(sensor == 2);
+    for (uint32_t i = 0; i < sizeof(address); i++)
+    {
+        CHECK(HWREG(FRMF_SRCM_RAM_BASE + 4 * (8 + i)) == address[i]);
+    }
+    CHECK(getMask(RFCORE_XREG_SRCEXTEN0) == 0x000004);
+    CHECK(getMask(RFCORE_FFSM_SRCEXTPENDEN0) == 0x000000);
+
+    // Short entries fill the half taken pairs first
+    node = radio.addSource(0xABCD, 0x0002, false);
+    CHECK(node == 1);
+    CHECK(getMask(RFCORE_XREG_SRCSHORTEN0) == 0x000003);
+    CHECK(getMask(RFCORE_FFSM_SRCSHORTPENDEN0) == 0x000001);
+
+    // The pending flags are set per entry
+    CHECK(radio.setSourcePending(sensor, true));
+    CHECK(radio.setSourcePending(child, false));
+    CHECK(getMask(RFCORE_FFSM_SRCEXTPENDEN0) == 0x000004);
+    CHECK(getMask(RFCORE_FFSM_SRCSHORTPENDEN0) == 0x000000);
+    CHECK(!radio.setSourcePending(3, true));
+    CHECK(!radio.setSourcePending(RADIO_SOURCE_UNITS, true));
+
+    // A removed entry is disabled and its units reused
+    CHECK(radio.removeSource(sensor));
+    CHECK(!radio.removeSource(sensor));
+    CHECK(getMask(RFCORE_XREG_SRCEXTEN0) == 0x000000);
+    CHECK(getMask(RFCORE_FFSM_SRCEXTPENDEN0) == 0x000000);
+    other = radio.addSource(0xABCD, 0x0003, false);
+    CHECK(other == 2);
+    CHECK(radio.removeSource(other));
+
+    // The table fills up with pairs
+    for (int32_t i = 2; i < RADIO_SOURCE_UNITS; i += 2)
+    {
+        CHECK(radio.addSource(address, false) == i);
+    }
+    CHECK(radio.addSource(address, false) == -1);
+    CHECK(radio.addSource(0xABCD, 0x0004, false) == -1);
+    CHECK(getMask(RFCORE_XREG_SRCSHORTEN0) == 0x000003);
+    CHECK(getMask(RFCORE_XREG_SRCEXTEN0) == 0x555554);
+
+    // Extended entries do not fit in a half taken pair
+    CHECK(radio.removeSource(4));
+    CHECK(radio.addSource(0xABCD, 0x0004, false) == 4);
+    CHECK(radio.addSource(address, false) == -1);
+    CHECK(radio.addSource(0xABCD, 0x0005, false) == 5);
+    CHECK(getMask(RFCORE_XREG_SRCSHORTEN0) == 0x000033);
+    CHECK(getMask(RFCORE_XREG_SRCEXTEN0) == 0x555544);
+
+    // The table survives a sleep
+    CHECK(radio.removeSource(4) && radio.removeSource(5));
+    for (int32_t i = 2; i < RADIO_SOURCE_UNITS; i += 2)
+    {
+        if (i != 4) CHECK(radio.removeSource(i));
+    }
+    HWREG(FRMF_SRCM_RAM_BASE + 0x8) = 0;
+    HWREG(RFCORE_XREG_SRCSHORTEN0) = 0;
+    radio.sleep();
+    radio.wakeup();
+    CHECK(HWREG(FRMF_SRCM_RAM_BASE + 0x8) == 0x01);
+    CHECK(getMask(RFCORE_XREG_SRCSHORTEN0) == 0x000003);
+    CHECK(HWREG(RFCORE_XREG_SRCMATCH) & RFCORE_XREG_SRCMATCH_AUTOPEND);
+
+    // Promiscuous mode does not match sources
+    radio.setPromiscuous();
+    CHECK(HWREG(RFCORE_XREG_SRCMATCH) == 0);
+    CHECK(radio.removeSource(child));
+    CHECK(radio.removeSource(node));
+
+    return true;
+}
+
+static bool testReceiveDma(void)
+{
+    uint8_t buffer[125];
+    uint8_t length;
+    int8_t rssi;
+    uint8_t lqi, crc;
+
+    radio.enableDma(dmaBuffer, sizeof(dmaBuffer));
+
+    // The end of the frame starts the transfer of the whole frame
+    startReceive();
+    pushFrame(frame, TEST_RSSI, TEST_CRC_LQI);
+    raise(RFCORE_SFR_RFIRQF0_SFD | RFCORE_SFR_RFIRQF0_RXPKTDONE);
+    CHECK(rxInits == 1 && rxDones == 0);
+
+    // Which is not the packet yet
+    length = sizeof(buffer);
+    CHECK(radio.getPacket(buffer, &length, &rssi, &lqi, &crc) == RadioResult_Error);
+
+    // The completion of the transfer hands it over, the CPU reads nothing
+    radioDataAccesses = 0;
+    CHECK(runDma());
+    CHECK(radioRxFifo.empty());
+    InterruptHandler::radioDma(radio);
+    CHECK(rxDones == 1);
+
+    // Only the bit of the channel is written back to clear it
+    CHECK(HWREG(UDMA_CHIS) == (1 << TEST_DMA_CHANNEL));
+
+    radioDataAccesses = 0;
+    CHECK(checkPacket(frame, TEST_RSSI, TEST_CRC_LQI));
+    CHECK(radioDataAccesses == 0);
+
+    // A frame that does not fit in the buffer is dropped
+    startReceive();
+    pushFrame(frame, TEST_RSSI, 0x05);
+    raise(RFCORE_SFR_RFIRQF0_SFD | RFCORE_SFR_RFIRQF0_RXPKTDONE);
+    CHECK(runDma());
+    InterruptHandler::radioDma(radio);
+    length = frame.size() - 1;
+    CHECK(radio.getPacket(buffer, &length, &rssi, &lqi, &crc) == RadioResult_Error);
+
+    // A length byte that is not valid is not transferred at all
+    startReceive();
+    radioRxFifo.assign({0x80, 0x00});
+    raise(RFCORE_SFR_RFIRQF0_SFD | RFCORE_SFR_RFIRQF0_RXPKTDONE);
+    CHECK(rxDones == 1);
+    CHECK(!(HWREG(UDMA_ENASET) & (1 << TEST_DMA_CHANNEL)));
+    length = sizeof(buffer);
+    CHECK(radio.getPacket(buffer, &length, &rssi, &lqi, &crc) == RadioResult_Error);
+    CHECK(radioRxFifo.empty());
+
+    // A completion while the radio is off is only acknowledged
+    radio.off();
+    HWREG(UDMA_CHIS) = (1 << TEST_DMA_CHANNEL);
+    InterruptHandler::radioDma(radio);
+    CHECK(rxDones == 1);
+
+    // Nor is anything done without a completion
+    startReceive();
+    pushFrame(frame, TEST_RSSI, TEST_CRC_LQI);
+    raise(RFCORE_SFR_RFIRQF0_SFD | RFCORE_SFR_RFIRQF0_RXPKTDONE);
+    HWREG(UDMA_CHIS) = (1 << 8);
+    InterruptHandler::radioDma(radio);
+    CHECK(rxDones == 0);
+    CHECK(runDma());
+    InterruptHandler::radioDma(radio);
+    CHECK(rxDones == 1);
+    CHECK(checkPacket(frame, TEST_RSSI, TEST_CRC_LQI));
+
+    // Neither is a frame larger than the buffer
+    radio.enableDma(dmaBuffer, frame.size() + 2);
+    startReceive();
+    pushFrame(frame, TEST_RSSI, TEST_CRC_LQI);
+    raise(RFCORE_SFR_RFIRQF0_SFD | RFCORE_SFR_RFIRQF0_RXPKTDONE);
+    CHECK(rxDones == 1);
+    CHECK(!(HWREG(UDMA_ENASET) & (1 << TEST_DMA_CHANNEL)));
+    length = sizeof(buffer);
+    CHECK(radio.getPacket(buffer, &length, &rssi, &lqi, &crc) == RadioResult_Error);
+    CHECK(radioRxFifo.empty());
+    radio.enableDma(dmaBuffer, sizeof(dmaBuffer));
+
+    return true;
+}
+
+static bool testLoadDma(void)
+{
+    memcpy(txBuffer, frame.data(), frame.size());
+
+    radio.on();
+    radioTxFifo.clear();
+    radioDataAccesses = 0;
+
+    // Only the length byte is written by the CPU
+    CHECK(radio.loadPacket(txBuffer, frame.size()) == RadioResult_Success);
+    CHECK(radioTxFifo.size() == 1);
+    CHECK(radioTxFifo[0] == frame.size() + 2);
+    CHECK(radioDataAccesses == 1);
+
+    // The channel is busy until the payload is in
+    CHECK(radio.loadPacket(txBuffer, frame.size()) == RadioResult_Error);
+    radioTxFifo.assign({(uint8_t) (frame.size() + 2)});
+
+    CHECK(runDma());
+    CHECK(radioTxFifo.size() == frame.size() + 1);
+    CHECK(memcmp(&radioTxFifo[1], frame.data(), frame.size()) == 0);
+
+    // The completion is acknowledged without any callback
+    rxDones = 0;
+    InterruptHandler::radioDma(radio);
+    CHECK(HWREG(UDMA_CHIS) == (1 << TEST_DMA_CHANNEL));
+    CHECK(rxDones == 0);
+
+    printf("Loaded a %u byte frame with 1 RFDATA access, the uDMA made the other %u\n",
+           (uint32_t) frame.size() + 1, (uint32_t) frame.size());
+
+    return true;
+}
+
+static bool testCsma(void)
+{
+    RadioTxStats stats;
+    uint32_t frames;
+
+    memcpy(txBuffer, frame.data(), frame.size());
+    radio.on();
+    HWREG(RFCORE_XREG_RXENABLE) = 1;
+
+    // The MAC timer overflows once every backoff period of 320 us
+    radio.enableCsma();
+    CHECK(HWREG(RFCORE_SFR_MTM1) == (32 * 320) >> 8);
+    CHECK(HWREG(RFCORE_SFR_MTCTRL) & RFCORE_SFR_MTCTRL_RUN);
+
+    // The frames sent by the other tests count too
+    radio.getTxStats(stats);
+    frames = stats.frames;
+
+    // A clear channel takes a single backoff with the minimum exponent,
+    // waited by the CSP until its CSP_STOP interrupt wakes transmit up
+    CHECK(radio.transmit() == RadioResult_Success);
+    CHECK(HWREG(RFCORE_SFR_RFST) == CC2538_RF_CSP_OP_ISSTART);
+    CHECK(radioCcas == 1);
+    CHECK(radioBackoffs == 7);
+    radio.getTxStats(stats);
+    CHECK(stats.frames == frames + 1 && stats.failures == 0);
+    CHECK(stats.busy == 0 && stats.backoffs == 0);
+    HWREG(RFCORE_XREG_FSMSTAT1) &= ~RFCORE_XREG_FSMSTAT1_TX_ACTIVE;
+
+    // Every busy CCA doubles the backoff, up to the maximum exponent
+    radioCcas = 0;
+    radioBackoffs = 0;
+    radioBusyCcas = 3;
+    CHECK(radio.transmit() == RadioResult_Success);
+    CHECK(radioCcas == 4);
+    CHECK(radioBackoffs == 7 + 15 + 31 + 31);
+    radio.getTxStats(stats);
+    CHECK(stats.frames == frames + 2 && stats.failures == 0);
+    CHECK(stats.busy == 3 && stats.backoffs == 3);
+    HWREG(RFCORE_XREG_FSMSTAT1) &= ~RFCORE_XREG_FSMSTAT1_TX_ACTIVE;
+
+    // A channel that stays busy gives up after the last retry, even though
+    // the CCA sampled by the previous frame was clear
+    radioCcas = 0;
+    radioBusyCcas = 10;
+    CHECK(radio.transmit() == RadioResult_Busy);
+    CHECK(radioCcas == RADIO_CSMA_MAX_BACKOFFS + 1);
+    CHECK(!(HWREG(RFCORE_XREG_FSMSTAT1) & RFCORE_XREG_FSMSTAT1_TX_ACTIVE));
+    radio.getTxStats(stats);
+    CHECK(stats.frames == frames + 2 && stats.failures == 1);
+    CHECK(stats.busy == 8 && stats.backoffs == RADIO_CSMA_MAX_BACKOFFS + 1);
+
+    // Without the CSP_STOP interrupt transmit stops the program in time
+    radioCcas = 0;
+    radioBusyCcas = 0;
+    cspInterrupts = false;
+    CHECK(radio.transmit() == RadioResult_Error);
+    CHECK(HWREG(RFCORE_SFR_RFST) == CC2538_RF_CSP_OP_ISSTOP);
+    cspInterrupts = true;
+    HWREG(RFCORE_XREG_FSMSTAT1) &= ~RFCORE_XREG_FSMSTAT1_TX_ACTIVE;
+
+    // With the receiver off there is no CCA, and no program to run
+    radioCcas = 0;
+    radioBackoffs = 0;
+    HWREG(RFCORE_XREG_RXENABLE) = 0;
+    CHECK(radio.transmit() == RadioResult_Error);
+    CHECK(radioCcas == 0 && radioBackoffs == 0);
+    CHECK(!(HWREG(RFCORE_XREG_FSMSTAT1) & RFCORE_XREG_FSMSTAT1_TX_ACTIVE));
+    radio.getTxStats(stats);
+    CHECK(stats.frames == frames + 2 && stats.failures == 3);
+
+    // Without CSMA-CA the radio transmits right away
+    radioCcas = 0;
+    radio.disableCsma();
+    CHECK(radio.transmit() == RadioResult_Success);
+    CHECK(radioCcas == 0);
+    CHECK(HWREG(RFCORE_SFR_RFST) == CC2538_RF_CSP_OP_ISTXON);
+    HWREG(RFCORE_XREG_FSMSTAT1) &= ~RFCORE_XREG_FSMSTAT1_TX_ACTIVE;
+
+    printf("Sent %u frames with CSMA-CA after %u busy CCAs, gave up on %u\n",
+           stats.frames - frames, stats.busy, stats.failures);
+
+    return true;
+}
@@ -0,0 +1,343 @@
+/**
+ * @file       main.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host test and benchmark of the lock-free CircularBuffer.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <thread>
+
+#include "Buffer.h"
+#include "CircularBuffer.h"
+
+/*================================ define ===================================*/
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            printf("Error: %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+#define STRESS_BYTES                        ( 4 * 1024 * 1024 )
+#define BENCHMARK_BYTES                     ( 16 * 1024 * 1024 )
+#define BENCHMARK_CHUNK                     ( 64 )
+
+/*================================ typedef ==================================*/
+
+/*=============================== prototypes ================================*/
+
+static bool testEmptyFull(void);
+static bool testWrapAround(void);
+static bool testBulk(void);
+static bool testPeekCommit(void);
+static bool testProducerConsumer(void);
+
+template <typename T>
+static double benchmark(T& buffer, bool reset);
+static double benchmarkBulk(CircularBuffer& buffer);
+
+/*=============================== variables =================================*/
+
+/*================================= public ==================================*/
+
+int main(void)
+{
+    bool status = true;
+
+    status &= testEmptyFull();
+    status &= testWrapAround();
+    status &= testBulk();
+    status &= testPeekCommit();
+    status &= testProducerConsumer();
+
+    if (!status)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Compare the old mutex-per-byte buffer against the lock-free ring
+    uint8_t buffer_old[256];
+    Buffer bufferOld(buffer_old, sizeof(buffer_old));
+    double old_rate = benchmark(bufferOld, true);
+
+    uint8_t buffer_new[256];
+    CircularBuffer bufferNew(buffer_new, sizeof(buffer_new));
+    double new_rate = benchmark(bufferNew, false);
+    double bulk_rate = benchmarkBulk(bufferNew);
+
+    printf("Buffer (mutex):          %10.2f MB/s\n", old_rate / 1e6);
+    printf("CircularBuffer (SPSC):   %10.2f MB/s\n", new_rate / 1e6);
+    printf("CircularBuffer (bulk):   %10.2f MB/s\n", bulk_rate / 1e6);
+    printf("Speed-up:                %10.2fx\n", new_rate / old_rate);
+    printf("Speed-up (bulk):         %10.2fx\n", bulk_rate / old_rate);
+
+    return EXIT_SUCCESS;
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+static bool testEmptyFull(void)
+{
+    uint8_t storage[8];
+    CircularBuffer buffer(storage, sizeof(storage));
+    uint8_t byte;
+
+    CHECK(buffer.isEmpty());
+    CHECK(!buffer.isFull());
+    CHECK(!buffer.read(&byte));
+
+    // The whole storage is usable
+    for (uint8_t i = 0; i < sizeof(storage); i++)
+    {
+        CHECK(buffer.write(i));
+    }
+
+    CHECK(buffer.isFull());
+    CHECK(buffer.getSize() == sizeof(storage));
+    CHECK(buffer.getFree() == 0);
+    CHECK(!buffer.write(0xFF));
+
+    for (uint8_t i = 0; i < sizeof(storage); i++)
+    {
+        CHECK(buffer.read(&byte));
+        CHECK(byte == i);
+    }
+
+    CHECK(buffer.isEmpty());
+
+    // Reset discards pending data
+    CHECK(buffer.write(0xAA));
+    buffer.reset();
+    CHECK(buffer.isEmpty());
+
+    return true;
+}
+
+static bool testWrapAround(void)
+{
+    uint8_t storage[7];
+    CircularBuffer buffer(storage, sizeof(storage));
+    uint8_t input[5];
+    uint8_t output[5];
+    uint8_t counter = 0;
+
+    // Odd sizes make every offset act as the wrap point
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        for (uint8_t j = 0; j < sizeof(input); j++)
+        {
+            input[j] = counter++;
+        }
+
+        CHECK(buffer.write(input, sizeof(input)));
+        CHECK(buffer.getSize() == sizeof(input));
+        CHECK(buffer.read(output, sizeof(output)));
+        CHECK(buffer.isEmpty());
+
+        for (uint8_t j = 0; j < sizeof(input); j++)
+        {
+            CHECK(input[j] == output[j]);
+        }
+    }
+
+    return true;
+}
+
+static bool testBulk(void)
+{
+    uint8_t storage[16];
+    CircularBuffer buffer(storage, sizeof(storage));
+    uint8_t input[12];
+    uint8_t output[12];
+
+    for (uint8_t i = 0; i < sizeof(input); i++)
+    {
+        input[i] = 0xA0 + i;
+    }
+
+    // Move the indices so that the next write wraps
+    CHECK(buffer.write(input, 10));
+    CHECK(buffer.read(output, 10));
+
+    // Wrapped write and read are split in two segments
+    CHECK(buffer.write(input, sizeof(input)));
+    CHECK(buffer.getSize() == sizeof(input));
+    CHECK(buffer.read(output, sizeof(output)));
+
+    for (uint8_t i = 0; i < sizeof(input); i++)
+    {
+        CHECK(input[i] == output[i]);
+    }
+
+    // Bulk operations are all-or-nothing
+    CHECK(buffer.write(input, sizeof(input)));
+    CHECK(!buffer.write(input, sizeof(input)));
+    CHECK(buffer.getSize() == sizeof(input));
+    CHECK(!buffer.read(output, sizeof(input) + 1));
+    CHECK(buffer.getSize() == sizeof(input));
+
+    return true;
+}
+
+static bool testPeekCommit(void)
+{
+    uint8_t storage[10];
+    CircularBuffer buffer(storage, sizeof(storage));
+    uint8_t output[10];
+    uint8_t* span;
+    uint32_t length;
+
+    // Move the indices close to the end of the storage
+    CHECK(buffer.write(output, 7));
+    CHECK(buffer.read(output, 7));
+
+    // The contiguous free region stops at the end of the storage
+    length = buffer.peekWrite(&span);
+    CHECK(length == 3);
+    CHECK(span == &storage[7]);
+    span[0] = 1; span[1] = 2; span[2] = 3;
+
+    // Nothing is visible until it is committed
+    CHECK(buffer.isEmpty());
+    CHECK(buffer.commitWrite(length));
+
+    // The next region starts at the beginning of the storage
+    length = buffer.peekWrite(&span);
+    CHECK(length == 7);
+    CHECK(span == &storage[0]);
+    span[0] = 4;
+    CHECK(buffer.commitWrite(1));
+    CHECK(buffer.getSize() == 4);
+
+    // Drain in place, one contiguous region at a time
+    length = buffer.peekRead(&span);
+    CHECK(length == 3);
+    CHECK(span[0] == 1 && span[2] == 3);
+    CHECK(buffer.commitRead(length));
+
+    length = buffer.peekRead(&span);
+    CHECK(length == 1);
+    CHECK(span[0] == 4);
+    CHECK(buffer.commitRead(length));
+    CHECK(buffer.isEmpty());
+
+    // Commits cannot overrun the buffer
+    CHECK(!buffer.commitRead(1));
+    CHECK(!buffer.commitWrite(sizeof(storage) + 1));
+
+    return true;
+}
+
+static bool testProducerConsumer(void)
+{
+    static uint8_t storage[61];
+    CircularBuffer buffer(storage, sizeof(storage));
+    bool status = true;
+
+    // The producer plays the role of the UART interrupt handler
+    std::thread producer([&buffer]()
+    {
+        uint8_t value = 0;
+        for (uint32_t i = 0; i < STRESS_BYTES; i++)
+        {
+            while (!buffer.write(value))
+            {
+                std::this_thread::yield();
+            }
+            value++;
+        }
+    });
+
+    // The consumer plays the role of the task reading frames
+    uint8_t expected = 0;
+    for (uint32_t i = 0; i < STRESS_BYTES; i++)
+    {
+        uint8_t byte;
+        while (!buffer.read(&byte))
+        {
+            std::this_thread::yield();
+        }
+
+        if (byte != expected)
+        {
+            printf("Error: byte %u is 0x%02X, expected 0x%02X\n", i, byte, expected);
+            status = false;
+            break;
+        }
+        expected++;
+    }
+
+    producer.join();
+
+    return status;
+}
+
+template <typename T>
+static double benchmark(T& buffer, bool reset)
+{
+    std::chrono::steady_clock::time_point start, end;
+    uint8_t byte = 0;
+
+    start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < BENCHMARK_BYTES / BENCHMARK_CHUNK; i++)
+    {
+        // Same access pattern as the Hdlc and Serial byte paths
+        for (uint32_t j = 0; j < BENCHMARK_CHUNK; j++)
+        {
+            buffer.write(byte++);
+        }
+
+        for (uint32_t j = 0; j < BENCHMARK_CHUNK; j++)
+        {
+            buffer.read(&byte);
+        }
+
+        // The linear buffer never wraps and has to be rewound
+        if (reset)
+        {
+            buffer.reset();
+        }
+    }
+
+    end = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double> elapsed = end - start;
+
+    return (BENCHMARK_BYTES / elapsed.count());
+}
+
+static double benchmarkBulk(CircularBuffer& buffer)
+{
+    std::chrono::steady_clock::time_point start, end;
+    uint8_t chunk[BENCHMARK_CHUNK] = {0};
+
+    start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < BENCHMARK_BYTES / BENCHMARK_CHUNK; i++)
+    {
+        // Same access pattern as a whole frame moved in one call
+        buffer.write(chunk, sizeof(chunk));
+        buffer.read(chunk, sizeof(chunk));
+    }
+
+    end = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double> elapsed = end - start;
+
+    return (BENCHMARK_BYTES / elapsed.count());
+}
@@ -0,0 +1,203 @@
+/**
+ * @file       Uart.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host implementation of the Uart on top of UartHost.h.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include "UartHost.h"
+
+/*================================ define ===================================*/
+
+/*================================ typedef ==================================*/
+
+/*=============================== variables =================================*/
+
+uint8_t uartRxData;
+bool uartRxDma;
+uint8_t* uartRxDmaBuffer;
+uint32_t uartRxDmaLength;
+std::atomic<uint32_t> uartRxDmaCount;
+std::mutex uartRxDmaLock;
+std::vector<uint8_t> uartTxData;
+bool uartTxDma;
+uint32_t uartTxBasepri;
+
+uint32_t hostPrimask;
+uint32_t hostBasepri;
+uint32_t hostCycles;
+
+/*=============================== prototypes ================================*/
+
+/*================================= public ==================================*/
+
+Uart::Uart(Gpio& rx, Gpio& tx, UartConfig& config):
+    rx_(rx), tx_(tx), config_(config), \
+    rxSemaphore_(false), txSemaphore_(true), \
+    rx_callback_(), tx_callback_(), \
+    rxDmaBuffer_(nullptr), rxDmaLength_(0), rxDmaCount_(0), rxDmaAlternate_(false)
+{
+}
+
+void Uart::enable(uint32_t baudrate)
+{
+}
+
+void Uart::sleep(void)
+{
+}
+
+void Uart::wakeup(void)
+{
+}
+
+void Uart::setRxCallback(Delegate callback, CallbackContext context)
+{
+    rx_callback_ = rxWork_.bind(callback, context);
+}
+
+void Uart::setTxCallback(Delegate callback, CallbackContext context)
+{
+    tx_callback_ = txWork_.bind(callback, context);
+}
+
+void Uart::enableInterrupts(void)
+{
+}
+
+void Uart::disableInterrupts(void)
+{
+}
+
+void Uart::rxLock(void)
+{
+    rxSemaphore_.take();
+}
+
+void Uart::txLock(void)
+{
+    txSemaphore_.take();
+}
+
+void Uart::rxUnlock(void)
+{
+    rxSemaphore_.give();
+}
+
+void Uart::txUnlock(void)
+{
+    txSemaphore_.give();
+}
+
+void Uart::rxUnlockFromInterrupt(void)
+{
+    rxSemaphore_.giveFromInterrupt();
+}
+
+void Uart::txUnlockFromInterrupt(void)
+{
+    txSemaphore_.giveFromInterrupt();
+}
+
+uint8_t Uart::readByte(void)
+{
+    return uartRxData;
+}
+
+uint32_t Uart::readByte(uint8_t* buffer, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; i++)
+    {
+        *buffer++ = uartRxData;
+    }
+
+    return 0;
+}
+
+uint32_t Uart::readFifo(uint8_t* buffer, uint32_t length)
+{
+    // The host UART has a one-byte buffer
+    *buffer = uartRxData;
+
+    return 1;
+}
+
+bool Uart::readDma(uint8_t* buffer, uint32_t length)
+{
+    // Check that the host UART has a uDMA channel
+    if (!uartRxDma) return false;
+
+    // The test writes to the buffer as the uDMA does
+    uartRxDmaBuffer = buffer;
+    uartRxDmaLength = length;
+    uartRxDmaCount = 0;
+
+    return true;
+}
+
+uint32_t Uart::getDmaRxCount(void)
+{
+    std::lock_guard<std::mutex> lock(uartRxDmaLock);
+
+    return uartRxDmaCount;
+}
+
+void Uart::writeByte(uint8_t byte)
+{
+    uartTxBasepri = hostBasepri;
+    uartTxData.push_back(byte);
+}
+
+uint32_t Uart::writeByte(uint8_t* buffer, uint32_t length)
+{
+    uartTxData.insert(uartTxData.end(), buffer, buffer + length);
+
+    return 0;
+}
+
+bool Uart::writeDma(uint8_t* buffer, uint32_t length)
+{
+    // Check that the host UART has a uDMA channel
+    if (!uartTxDma) return false;
+
+    // The transfer completes at once, the test raises the interrupt
+    uartTxBasepri = hostBasepri;
+    uartTxData.insert(uartTxData.end(), buffer, buffer + length);
+
+    return true;
+}
+
+/*=============================== protected =================================*/
+
+UartConfig& Uart::getConfig(void)
+{
+    return config_;
+}
+
+void Uart::interruptHandler(void)
+{
+}
+
+/*================================ private ==================================*/
+
+void Uart::interruptHandlerRx(void)
+{
+    if (rx_callback_.isValid())
+    {
+        rx_callback_.execute();
+    }
+}
+
+void Uart::interruptHandlerTx(void)
+{
+    if (tx_callback_.isValid())
+    {
+        tx_callback_.execute();
+    }
+}
@@ -0,0 +1,70 @@
+/**
+ * @file       UartHost.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host stand-in for the UART registers and interrupt dispatch.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef UART_HOST_H_
+#define UART_HOST_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "Uart.h"
+
+class Gpio {};
+
+struct UartConfig {};
+
+// Byte returned by the next Uart::readByte and Uart::readFifo
+extern uint8_t uartRxData;
+
+// Whether Uart::readDma accepts transfers, and where they go
+extern bool uartRxDma;
+extern uint8_t* uartRxDmaBuffer;
+extern uint32_t uartRxDmaLength;
+
+// Bytes that the uDMA has written to the buffer, see Uart::getDmaRxCount
+extern std::atomic<uint32_t> uartRxDmaCount;
+
+// Held to keep Uart::getDmaRxCount out, as masking the interrupt does
+extern std::mutex uartRxDmaLock;
+
+// Bytes written with Uart::writeByte and Uart::writeDma
+extern std::vector<uint8_t> uartTxData;
+
+// Whether Uart::writeDma accepts transfers
+extern bool uartTxDma;
+
+// BASEPRI at the last Uart::writeByte or Uart::writeDma
+extern uint32_t uartTxBasepri;
+
+// The interrupt masks and the cycle counter of CriticalSection
+extern uint32_t hostPrimask;
+extern uint32_t hostBasepri;
+extern uint32_t hostCycles;
+
+// Calls into the private handlers as the platform InterruptHandler does
+class InterruptHandler
+{
+public:
+    static void uartRx(Uart& uart)
+    {
+        uart.interruptHandlerRx();
+    }
+
+    static void uartTx(Uart& uart)
+    {
+        uart.interruptHandlerTx();
+    }
+};
+
+#endif /* UART_HOST_H_ */
@@ -0,0 +1,766 @@
+/**
+ * @file       main.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host stress test of the Serial frame receive queue.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "UartHost.h"
+
+#include "CircularBuffer.h"
+#include "Hdlc.h"
+#include "Serial.h"
+#include "SerialMux.h"
+#include "WorkQueue.h"
+
+/*================================ define ===================================*/
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            printf("Error: %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+#define HDLC_FLAG                           ( 0x7E )
+
+#define TEST_BURSTS                         ( 20000 )
+#define TEST_BURST_FRAMES                   ( 5 )
+#define TEST_FRAME_LENGTH                   ( 40 )
+
+#define TEST_DMA_BURSTS                     ( 500 )
+#define TEST_DMA_BURST_FRAMES               ( 2 )
+#define TEST_DMA_FRAME_LENGTH               ( 20 )
+
+/*================================ typedef ==================================*/
+
+struct Frame
+{
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> encoded;
+    bool valid;
+};
+
+// Records the frames that the multiplexer hands to a channel
+class MuxRecorder
+{
+public:
+    void receive(SerialMuxFrame& frame)
+    {
+        channel = frame.channel;
+        flags = frame.flags;
+        payload.assign(frame.data, frame.data + frame.length);
+        count++;
+    }
+public:
+    uint8_t channel = 0xFF;
+    uint8_t flags = 0;
+    std::vector<uint8_t> payload;
+    uint32_t count = 0;
+};
+
+/*=============================== prototypes ================================*/
+
+static void encode(Frame& frame);
+static bool testBursts(void);
+static bool testOversized(void);
+static bool testWrite(bool dma);
+static bool testWriteQueued(bool dma);
+static void sentFrame(void);
+static void dmaReceive(const std::vector<uint8_t>& bytes);
+static bool testDmaBursts(void);
+static bool testDmaOverrun(void);
+static void muxReceive(uint8_t channel, uint8_t sequence, uint8_t flags, uint8_t length);
+static bool testMux(void);
+static bool testMuxWriters(void);
+static bool testDeferred(void);
+
+/*=============================== variables =================================*/
+
+static Gpio rx, tx;
+static UartConfig config;
+static Uart uart(rx, tx, config);
+static Serial serial(uart);
+
+static uint32_t sent;
+static Delegate sentCallback = Delegate::create<sentFrame>();
+
+static Uart uartDma(rx, tx, config);
+static Serial serialDma(uartDma);
+
+static Uart uartDeferred(rx, tx, config);
+static Serial serialDeferred(uartDeferred);
+
+static uint8_t encoder_rx[16];
+static uint8_t encoder_tx[2 * TEST_FRAME_LENGTH + 16];
+static CircularBuffer encoderRx(encoder_rx, sizeof(encoder_rx));
+static CircularBuffer encoderTx(encoder_tx, sizeof(encoder_tx));
+static Hdlc encoder(encoderRx, encoderTx);
+
+/*================================= public ==================================*/
+
+int main(void)
+{
+    bool status = true;
+
+    srand(0x5E41);
+
+    serial.init();
+
+    status &= testBursts();
+    status &= testOversized();
+    status &= testWrite(false);
+    status &= testWrite(true);
+    status &= testWriteQueued(false);
+    status &= testWriteQueued(true);
+    status &= testMux();
+    status &= testMuxWriters();
+
+    serialDeferred.init(CallbackContext_Deferred);
+
+    status &= testDeferred();
+
+    uartRxDma = true;
+    serialDma.init();
+
+    status &= testDmaBursts();
+    status &= testDmaOverrun();
+
+    return (status ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+static void encode(Frame& frame)
+{
+    uint8_t byte;
+
+    // Encode the payload as the host tools do
+    encoderTx.reset();
+    encoder.txOpen();
+    encoder.txPut(frame.payload.data(), frame.payload.size());
+    encoder.txClose();
+
+    frame.encoded.clear();
+    while (encoderTx.read(&byte))
+    {
+        frame.encoded.push_back(byte);
+    }
+
+    // Corrupt one payload byte after the CRC has been computed
+    if (!frame.valid)
+    {
+        frame.encoded[1] ^= 0x01;
+        if (frame.encoded[1] == HDLC_FLAG || frame.encoded[1] == 0x7D)
+        {
+            frame.encoded[1] ^= 0x03;
+        }
+    }
+}
+
+static bool testBursts(void)
+{
+    std::vector<Frame> frames;
+    std::vector<uint32_t> bursts;
+    std::atomic<uint32_t> consumed(0);
+    uint32_t expected = 0;
+
+    // Every burst fits in the receive queue if the reader is not running
+    for (uint32_t i = 0; i < TEST_BURSTS; i++)
+    {
+        uint32_t count = 1 + rand() % TEST_BURST_FRAMES;
+
+        for (uint32_t j = 0; j < count; j++)
+        {
+            Frame frame;
+            uint32_t length = 1 + rand() % TEST_FRAME_LENGTH;
+
+            // Tag each payload with its index so that reordering shows
+            frame.payload.resize(length);
+            for (uint32_t k = 0; k < length; k++)
+            {
+                frame.payload[k] = (k < 4) ? (uint8_t) (frames.size() >> (8 * k)) : (uint8_t) rand();
+            }
+
+            frame.valid = (rand() % 10 != 0);
+            encode(frame);
+            frames.push_back(frame);
+
+            expected += frame.valid ? 1 : 0;
+        }
+
+        bursts.push_back(count);
+    }
+
+    // The producer plays the role of the UART interrupt handler
+    std::thread producer([&frames, &bursts, &consumed]()
+    {
+        uint32_t index = 0;
+        uint32_t queued = 0;
+
+        for (uint32_t i = 0; i < bursts.size(); i++)
+        {
+            // Wait for the reader to drain the previous burst
+            while (consumed.load() != queued)
+            {
+                std::this_thread::yield();
+            }
+
+            // Fire the whole burst back-to-back
+            for (uint32_t j = 0; j < bursts[i]; j++, index++)
+            {
+                const Frame& frame = frames[index];
+
+                // Frames may share the flag between them
+                bool shared = (j > 0) && (rand() % 2 == 0);
+
+                for (uint32_t k = (shared ? 1 : 0); k < frame.encoded.size(); k++)
+                {
+                    uartRxData = frame.encoded[k];
+                    InterruptHandler::uartRx(uart);
+                }
+
+                queued += frame.valid ? 1 : 0;
+            }
+        }
+    });
+
+    // The consumer plays the role of the task reading frames
+    uint8_t buffer[TEST_FRAME_LENGTH];
+    uint32_t index = 0;
+    bool status = true;
+
+    for (uint32_t i = 0; i < expected && status; i++)
+    {
+        uint32_t length = serial.read(buffer, sizeof(buffer));
+
+        // Skip the frames that were corrupted on purpose
+        while (!frames[index].valid)
+        {
+            index++;
+        }
+
+        if (length != frames[index].payload.size() ||
+            memcmp(buffer, frames[index].payload.data(), length) != 0)
+        {
+            printf("Error: frame %u (length %u) received as length %u\n",
+                   index, (uint32_t) frames[index].payload.size(), length);
+            status = false;
+        }
+
+        index++;
+        consumed.store(i + 1);
+    }
+
+    // Unblock the producer if the consumer bailed out early
+    consumed.store(expected);
+    producer.join();
+
+    printf("Received %u frames in %u bursts, %u corrupted frames dropped\n",
+           expected, (uint32_t) bursts.size(), (uint32_t) frames.size() - expected);
+
+    return status;
+}
+
+static bool testOversized(void)
+{
+    uint8_t buffer[8];
+    Frame frame;
+
+    // A frame larger than the read buffer is dropped
+    frame.payload.assign(sizeof(buffer) + 1, 0xA5);
+    frame.valid = true;
+    encode(frame);
+
+    for (uint32_t i = 0; i < frame.encoded.size(); i++)
+    {
+        uartRxData = frame.encoded[i];
+        InterruptHandler::uartRx(uart);
+    }
+
+    // The next frame is still received
+    frame.payload.assign(sizeof(buffer), 0x5A);
+    encode(frame);
+
+    for (uint32_t i = 0; i < frame.encoded.size(); i++)
+    {
+        uartRxData = frame.encoded[i];
+        InterruptHandler::uartRx(uart);
+    }
+
+    CHECK(serial.read(buffer, sizeof(buffer)) == 0);
+    CHECK(serial.read(buffer, sizeof(buffer)) == sizeof(buffer));
+    CHECK(buffer[0] == 0x5A);
+
+    return true;
+}
+
+static bool testWrite(bool dma)
+{
+    Frame frame;
+    uint32_t interrupts;
+
+    // The payload includes bytes that have to be escaped
+    frame.payload.assign(TEST_FRAME_LENGTH, 0x55);
+    frame.payload[1] = HDLC_FLAG;
+    frame.payload[2] = 0x7D;
+    frame.valid = true;
+    encode(frame);
+
+    uartTxDma = dma;
+    uartTxData.clear();
+    sent = 0;
+
+    CHECK(serial.write(frame.payload.data(), frame.payload.size(), sentCallback));
+    CHECK(serial.getTxFrames() == 1);
+
+    // The writer starts the UART with the TX interrupt masked
+    CHECK(uartTxBasepri == configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    CHECK(hostBasepri == 0);
+
+    // Raise TX interrupts until the frame has been sent
+    interrupts = 0;
+    while (serial.getTxFrames() > 0 && interrupts < 2 * frame.encoded.size())
+    {
+        InterruptHandler::uartTx(uart);
+        interrupts++;
+    }
+
+    CHECK(uartTxData == frame.encoded);
+    CHECK(sent == 1);
+    CHECK(!dma || interrupts == 1);
+
+    printf("Sent a %u byte frame with %u TX interrupts (%s)\n",
+           (uint32_t) frame.encoded.size(), interrupts, dma ? "uDMA" : "byte");
+
+    return true;
+}
+
+static bool testWriteQueued(bool dma)
+{
+    std::vector<uint8_t> expected;
+    uint32_t queued = 0;
+    uint32_t interrupts;
+    Frame frame;
+
+    frame.payload.assign(TEST_FRAME_LENGTH, 0xA5);
+    frame.valid = true;
+    encode(frame);
+
+    uartTxDma = dma;
+    uartTxData.clear();
+    sent = 0;
+
+    // Writers do not wait for the UART, frames queue up until it is full
+    while (serial.write(frame.payload.data(), frame.payload.size(), sentCallback))
+    {
+        expected.insert(expected.end(), frame.encoded.begin(), frame.encoded.end());
+        queued++;
+    }
+
+    CHECK(queued > 1);
+    CHECK(serial.getTxFrames() == queued);
+    CHECK(serial.getTxDropped() > 0);
+
+    // The UART goes from one frame to the next without the writers
+    interrupts = 0;
+    while (serial.getTxFrames() > 0 && interrupts < 2 * expected.size())
+    {
+        InterruptHandler::uartTx(uart);
+        interrupts++;
+    }
+
+    CHECK(uartTxData == expected);
+    CHECK(sent == queued);
+
+    // Every byte of the transmit buffer is available again
+    CHECK(serial.getTxFree() >= expected.size());
+
+    printf("Sent %u queued frames with %u TX interrupts (%s)\n",
+           queued, interrupts, dma ? "uDMA" : "byte");
+
+    return true;
+}
+
+static void sentFrame(void)
+{
+    sent++;
+}
+
+static void dmaReceive(const std::vector<uint8_t>& bytes)
+{
+    uint32_t half = uartRxDmaLength / 2;
+    uint32_t count = uartRxDmaCount;
+
+    // Write the bytes as the uDMA does, signalling each full half
+    for (uint32_t i = 0; i < bytes.size(); i++)
+    {
+        uartRxDmaBuffer[count % uartRxDmaLength] = bytes[i];
+        uartRxDmaCount = ++count;
+
+        if (count % half == 0)
+        {
+            InterruptHandler::uartRx(uartDma);
+        }
+    }
+}
+
+static bool testDmaBursts(void)
+{
+    std::vector<Frame> frames;
+    std::vector<uint32_t> bursts;
+    std::atomic<uint32_t> consumed(0);
+    uint32_t expected = 0;
+
+    // Every burst fits in the uDMA buffer if the reader is not running
+    for (uint32_t i = 0; i < TEST_DMA_BURSTS; i++)
+    {
+        uint32_t count = 1 + rand() % TEST_DMA_BURST_FRAMES;
+
+        for (uint32_t j = 0; j < count; j++)
+        {
+            Frame frame;
+            uint32_t length = 1 + rand() % TEST_DMA_FRAME_LENGTH;
+
+            frame.payload.resize(length);
+            for (uint32_t k = 0; k < length; k++)
+            {
+                frame.payload[k] = (k < 4) ? (uint8_t) (frames.size() >> (8 * k)) : (uint8_t) rand();
+            }
+
+            frame.valid = (rand() % 10 != 0);
+            encode(frame);
+            frames.push_back(frame);
+
+            expected += frame.valid ? 1 : 0;
+        }
+
+        bursts.push_back(count);
+    }
+
+    // The producer plays the role of the uDMA and its interrupt handler
+    std::thread producer([&frames, &bursts, &consumed]()
+    {
+        uint32_t index = 0;
+        uint32_t queued = 0;
+
+        for (uint32_t i = 0; i < bursts.size(); i++)
+        {
+            std::vector<uint8_t> bytes;
+
+            // Wait for the reader to drain the previous burst
+            while (consumed.load() != queued)
+            {
+                std::this_thread::yield();
+            }
+
+            for (uint32_t j = 0; j < bursts[i]; j++, index++)
+            {
+                bytes.insert(bytes.end(), frames[index].encoded.begin(), frames[index].encoded.end());
+                queued += frames[index].valid ? 1 : 0;
+            }
+
+            dmaReceive(bytes);
+        }
+    });
+
+    // The consumer decodes in task context, most frames end within a half
+    uint8_t buffer[TEST_DMA_FRAME_LENGTH];
+    uint32_t index = 0;
+    bool status = true;
+
+    for (uint32_t i = 0; i < expected && status; i++)
+    {
+        uint32_t length = serialDma.read(buffer, sizeof(buffer));
+
+        while (!frames[index].valid)
+        {
+            index++;
+        }
+
+        if (length != frames[index].payload.size() ||
+            memcmp(buffer, frames[index].payload.data(), length) != 0)
+        {
+            printf("Error: frame %u (length %u) received as length %u\n",
+                   index, (uint32_t) frames[index].payload.size(), length);
+            status = false;
+        }
+
+        index++;
+        consumed.store(i + 1);
+    }
+
+    consumed.store(expected);
+    producer.join();
+
+    printf("Received %u frames with uDMA, %u corrupted frames dropped\n",
+           expected, (uint32_t) frames.size() - expected);
+
+    return status;
+}
+
+static bool testDmaOverrun(void)
+{
+    std::vector<uint8_t> bytes;
+    uint8_t buffer[8];
+    Frame frame;
+
+    // A frame that the uDMA overwrites before it is decoded is lost
+    frame.payload.assign(sizeof(buffer), 0xA5);
+    frame.valid = true;
+    encode(frame);
+
+    for (uint32_t i = 0; i < 3 * uartRxDmaLength; i += frame.encoded.size())
+    {
+        bytes.insert(bytes.end(), frame.encoded.begin(), frame.encoded.end());
+    }
+
+    std::thread producer([&bytes]()
+    {
+        Frame next;
+
+        // The reader cannot look in between, so it finds the buffer lapped
+        uartRxDmaLock.lock();
+        dmaReceive(bytes);
+        uartRxDmaLock.unlock();
+
+        // Let the reader skip the overwritten bytes before the next frame
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        next.payload.assign(sizeof(buffer), 0x5A);
+        next.valid = true;
+        encode(next);
+        dmaReceive(next.encoded);
+    });
+
+    uint32_t length = serialDma.read(buffer, sizeof(buffer));
+    producer.join();
+
+    CHECK(length == sizeof(buffer));
+    CHECK(buffer[0] == 0x5A);
+
+    return true;
+}
+
+static void muxReceive(uint8_t channel, uint8_t sequence, uint8_t flags, uint8_t length)
+{
+    Frame frame;
+
+    // Build the frame as the host demultiplexer does
+    frame.payload.assign(SerialMux::HEADER_LENGTH + length, (uint8_t) (channel + 0x10));
+    frame.payload[0] = channel;
+    frame.payload[1] = sequence;
+    frame.payload[2] = flags;
+    frame.valid = true;
+    encode(frame);
+
+    for (uint32_t i = 0; i < frame.encoded.size(); i++)
+    {
+        uartRxData = frame.encoded[i];
+        InterruptHandler::uartRx(uart);
+    }
+}
+
+static bool testMux(void)
+{
+    SerialMux mux(serial);
+    MuxRecorder data, command;
+    uint8_t payload[4] = {HDLC_FLAG, 1, 2, 3};
+    std::vector<uint8_t> expected;
+    uint32_t interrupts;
+
+    CHECK(mux.setHandler(SerialMuxChannel_Data, SerialMuxHandler::create<MuxRecorder, &MuxRecorder::receive>(&data)));
+    CHECK(mux.setHandler(SerialMuxChannel_Command, SerialMuxHandler::create<MuxRecorder, &MuxRecorder::receive>(&command)));
+    CHECK(!mux.setHandler(SerialMuxChannel_Count, SerialMuxHandler::create<MuxRecorder, &MuxRecorder::receive>(&data)));
+
+    // Each channel has its own sequence numbers
+    uint8_t headers[3][3] = {{SerialMuxChannel_Log, 0, SerialMuxFlag_None},
+                             {SerialMuxChannel_Log, 1, SerialMuxFlag_None},
+                             {SerialMuxChannel_Stats, 0, SerialMuxFlag_Response}};
+    uint32_t lengths[3] = {sizeof(payload), sizeof(payload), 1};
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        Frame frame;
+
+        frame.payload.assign(headers[i], headers[i] + SerialMux::HEADER_LENGTH);
+        frame.payload.insert(frame.payload.end(), payload, payload + lengths[i]);
+        frame.valid = true;
+        encode(frame);
+
+        expected.insert(expected.end(), frame.encoded.begin(), frame.encoded.end());
+    }
+
+    uartTxDma = true;
+    uartTxData.clear();
+
+    CHECK(mux.write(SerialMuxChannel_Log, SerialMuxFlag_None, payload, lengths[0]));
+    CHECK(mux.write(SerialMuxChannel_Log, SerialMuxFlag_None, payload, lengths[1]));
+    CHECK(mux.write(SerialMuxChannel_Stats, SerialMuxFlag_Response, payload, lengths[2]));
+    CHECK(!mux.write(SerialMuxChannel_Count, SerialMuxFlag_None, payload, 1));
+
+    interrupts = 0;
+    while (serial.getTxFrames() > 0 && interrupts < 16)
+    {
+        InterruptHandler::uartTx(uart);
+        interrupts++;
+    }
+
+    // The header and the payload go out as one frame
+    CHECK(uartTxData == expected);
+
+    // Received frames are routed by channel
+    muxReceive(SerialMuxChannel_Data, 7, SerialMuxFlag_None, 5);
+    CHECK(mux.dispatch());
+    CHECK(data.count == 1 && data.channel == SerialMuxChannel_Data);
+    CHECK(data.payload.size() == 5 && data.payload[0] == 0x10);
+
+    muxReceive(SerialMuxChannel_Command, 0, SerialMuxFlag_Request, 1);
+    CHECK(mux.dispatch());
+    CHECK(command.count == 1 && command.flags == SerialMuxFlag_Request);
+    CHECK(command.payload.size() == 1 && command.payload[0] == 0x11);
+
+    // A gap in the sequence of a channel counts the missed frames
+    muxReceive(SerialMuxChannel_Data, 10, SerialMuxFlag_None, 0);
+    CHECK(mux.dispatch());
+    CHECK(data.count == 2 && data.payload.empty());
+    CHECK(mux.getRxLost() == 2);
+
+    // Frames without a handler or a header are dropped
+    muxReceive(SerialMuxChannel_Log, 0, SerialMuxFlag_None, 1);
+    CHECK(!mux.dispatch());
+    muxReceive(SerialMuxChannel_Count, 0, SerialMuxFlag_None, 1);
+    CHECK(!mux.dispatch());
+    CHECK(mux.getRxDropped() == 2);
+
+    printf("Multiplexed %u frames on %u channels\n", data.count + command.count, 2);
+
+    return true;
+}
+
+/**
+ * Writes to one channel from several threads at once and checks that the
+ * frames go out in the order of their sequence numbers.
+ */
+static bool testMuxWriters(void)
+{
+    SerialMux mux(serial);
+    std::vector<std::thread> writers;
+    std::vector<uint8_t> frame;
+    std::vector<uint8_t> sequences;
+    std::atomic<uint32_t> written(0);
+    uint32_t interrupts;
+
+    uartTxDma = true;
+    uartTxData.clear();
+
+    // Every frame fits, the UART is not drained until they are all queued
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        writers.push_back(std::thread([&mux, &written]()
+        {
+            uint8_t payload[2] = {0x01, 0x02};
+
+            for (uint32_t j = 0; j < 2; j++)
+            {
+                if (mux.write(SerialMuxChannel_Log, SerialMuxFlag_None, payload, sizeof(payload)))
+                {
+                    written++;
+                }
+                std::this_thread::yield();
+            }
+        }));
+    }
+
+    for (std::thread& writer : writers)
+    {
+        writer.join();
+    }
+    CHECK(written == 8);
+
+    interrupts = 0;
+    while (serial.getTxFrames() > 0 && interrupts < 16)
+    {
+        InterruptHandler::uartTx(uart);
+        interrupts++;
+    }
+
+    // The channel and the small sequence numbers are never escaped
+    for (uint32_t i = 0; i < uartTxData.size(); i++)
+    {
+        if (uartTxData[i] != HDLC_FLAG)
+        {
+            frame.push_back(uartTxData[i]);
+        }
+        else if (!frame.empty())
+        {
+            sequences.push_back(frame[1]);
+            frame.clear();
+        }
+    }
+
+    CHECK(sequences.size() == 8);
+    for (uint32_t i = 0; i < sequences.size(); i++)
+    {
+        CHECK(sequences[i] == i);
+    }
+
+    return true;
+}
+
+static bool testDeferred(void)
+{
+    WorkQueue& workQueue = WorkQueue::getInstance();
+    uint8_t buffer[TEST_FRAME_LENGTH];
+    uint32_t executed;
+    uint32_t length;
+    Frame frame;
+
+    frame.payload.resize(TEST_FRAME_LENGTH);
+    for (uint32_t i = 0; i < frame.payload.size(); i++)
+    {
+        frame.payload[i] = (uint8_t) rand();
+    }
+    frame.valid = true;
+    encode(frame);
+
+    for (uint32_t i = 0; i < frame.encoded.size(); i++)
+    {
+        executed = workQueue.getExecuted();
+
+        // The interrupt only schedules the daemon, which drains the FIFO
+        uartRxData = frame.encoded[i];
+        InterruptHandler::uartRx(uartDeferred);
+
+        // The host FIFO holds one byte, so wait for the daemon to take it
+        while (workQueue.getExecuted() == executed)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    length = serialDeferred.read(buffer, sizeof(buffer));
+
+    CHECK(length == frame.payload.size());
+    CHECK(memcmp(buffer, frame.payload.data(), length) == 0);
+
+    return true;
+}
@@ -0,0 +1,266 @@
+/**
+ * @file       main.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host test of the run-time statistics report and service.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "UartHost.h"
+
+#include "CircularBuffer.h"
+#include "Hdlc.h"
+#include "Scheduler.h"
+#include "Serial.h"
+#include "SerialMux.h"
+#include "StatsService.h"
+
+/*================================ define ===================================*/
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            printf("Error: %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+#define TEST_FRAME_LENGTH                   ( 256 )
+
+/*=============================== prototypes ================================*/
+
+static uint32_t get16(const uint8_t* buffer);
+static uint32_t get32(const uint8_t* buffer);
+static void receive(const std::vector<uint8_t>& payload);
+static bool transmit(std::vector<uint8_t>& payload);
+static bool testLoad(void);
+static bool testReport(void);
+static bool testService(void);
+
+/*=============================== variables =================================*/
+
+static Gpio rx, tx;
+static UartConfig config;
+static Uart uart(rx, tx, config);
+static Serial serial(uart);
+static SerialMux mux(serial);
+static StatsService service(mux);
+
+static uint8_t codec_rx[TEST_FRAME_LENGTH];
+static uint8_t codec_tx[2 * TEST_FRAME_LENGTH];
+static CircularBuffer codecRx(codec_rx, sizeof(codec_rx));
+static CircularBuffer codecTx(codec_tx, sizeof(codec_tx));
+static Hdlc codec(codecRx, codecTx);
+
+/*================================= public ==================================*/
+
+int main(void)
+{
+    bool status = true;
+
+    serial.init();
+
+    status &= testLoad();
+    status &= testReport();
+    status &= testService();
+
+    return (status ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+static uint32_t get16(const uint8_t* buffer)
+{
+    return (buffer[0] << 0) | (buffer[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* buffer)
+{
+    return get16(buffer) | (get16(buffer + 2) << 16);
+}
+
+/**
+ * Encodes a frame as the host tools do and feeds it to the UART.
+ */
+static void receive(const std::vector<uint8_t>& payload)
+{
+    uint8_t byte;
+
+    // Keep the bytes of the answer only
+    uartTxData.clear();
+
+    codecTx.reset();
+    codec.txOpen();
+    codec.txPut((uint8_t*) payload.data(), payload.size());
+    codec.txClose();
+
+    while (codecTx.read(&byte))
+    {
+        uartRxData = byte;
+        InterruptHandler::uartRx(uart);
+    }
+}
+
+/**
+ * Raises TX interrupts until the queued frames are out and decodes the
+ * last one.
+ */
+static bool transmit(std::vector<uint8_t>& payload)
+{
+    uint8_t frame[TEST_FRAME_LENGTH];
+    uint32_t length = 0;
+
+    while (serial.getTxFrames() > 0)
+    {
+        InterruptHandler::uartTx(uart);
+    }
+
+    codec.rxOpen();
+
+    for (uint32_t i = 0; i < uartTxData.size(); i++)
+    {
+        CHECK(codec.rxPut(uartTxData[i]) == HdlcResult_Ok);
+
+        if (codec.getRxStatus() == HdlcStatus_Done)
+        {
+            CHECK(codec.rxClose() == HdlcResult_Ok);
+            length = codec.rxRead(frame, sizeof(frame));
+            codec.rxOpen();
+        }
+    }
+
+    CHECK(length > 0);
+    payload.assign(frame, frame + length);
+
+    return true;
+}
+
+static bool testLoad(void)
+{
+    CHECK(Scheduler::getLoad(0, 0) == 0);
+    CHECK(Scheduler::getLoad(0, 1000) == 0);
+    CHECK(Scheduler::getLoad(500, 1000) == 500);
+    CHECK(Scheduler::getLoad(1, 3) == 333);
+    CHECK(Scheduler::getLoad(2, 3) == 667);
+    CHECK(Scheduler::getLoad(1000, 1000) == 1000);
+
+    // A task may have been counted a little past the total
+    CHECK(Scheduler::getLoad(1001, 1000) == 1000);
+
+    // The counters of a 32 MHz clock over a whole wrap do not overflow
+    CHECK(Scheduler::getLoad(0xFFFFFFFE, 0xFFFFFFFF) == 1000);
+    CHECK(Scheduler::getLoad(0x7FFFFFFF, 0xFFFFFFFF) == 500);
+    CHECK(Scheduler::getLoad(0x40000000, 0x80000000) == 500);
+    CHECK(Scheduler::getLoad(12345678, 98765432) == 125);
+
+    return true;
+}
+
+static bool testReport(void)
+{
+    SchedulerTaskStats tasks[SCHEDULER_STATS_TASKS];
+    SchedulerStats stats;
+    uint8_t report[SCHEDULER_REPORT_LENGTH];
+    const uint8_t* task;
+    uint32_t length;
+
+    // Without run-time stats only the system is reported
+    CHECK(Scheduler::getStats(stats, tasks, SCHEDULER_STATS_TASKS) == 0);
+    CHECK(stats.tasks == 0);
+    CHECK(stats.clock == configCPU_CLOCK_HZ);
+    CHECK(stats.heapSize == configTOTAL_HEAP_SIZE);
+    CHECK(stats.heapFree == xPortGetFreeHeapSize());
+    CHECK(stats.heapMinimum <= stats.heapFree);
+    CHECK(stats.heapLargest <= stats.heapFree);
+
+    // Encode a report as the target would fill it
+    stats.ticks = 0x01020304;
+    stats.runTime = 32000000;
+    stats.heapFree = 1024;
+    stats.heapMinimum = 512;
+    stats.heapLargest = 768;
+    stats.taskCount = 3;
+    stats.tasks = 3;
+
+    tasks[0] = SchedulerTaskStats{1, 0, 1, 875, 40, 28000000, "IDLE"};
+    tasks[1] = SchedulerTaskStats{3, 1, 2, 125, 12, 4000000, "SensorTask"};
+    tasks[2] = SchedulerTaskStats{4, 2, 2, 0, 20, 0, "NetworkStack"};
+
+    CHECK(Scheduler::encodeReport(stats, tasks, report, SCHEDULER_REPORT_HEADER) == 0);
+
+    length = Scheduler::encodeReport(stats, tasks, report, sizeof(report));
+    CHECK(length == SCHEDULER_REPORT_HEADER + 3 * SCHEDULER_REPORT_TASK);
+
+    CHECK(report[0] == SCHEDULER_REPORT_VERSION);
+    CHECK(report[1] == 3 && report[2] == 3);
+    CHECK(get32(&report[3]) == 0x01020304);
+    CHECK(get32(&report[7]) == 32000000);
+    CHECK(get32(&report[11]) == configCPU_CLOCK_HZ);
+    CHECK(get32(&report[15]) == configTOTAL_HEAP_SIZE);
+    CHECK(get32(&report[19]) == 1024);
+    CHECK(get32(&report[23]) == 512);
+    CHECK(get32(&report[27]) == 768);
+
+    task = &report[SCHEDULER_REPORT_HEADER + SCHEDULER_REPORT_TASK];
+    CHECK(task[0] == 3 && task[1] == 1 && task[2] == 2);
+    CHECK(get16(&task[3]) == 125);
+    CHECK(get16(&task[5]) == 12);
+    CHECK(get32(&task[7]) == 4000000);
+    CHECK(strncmp((const char*) &task[11], "SensorTask", SCHEDULER_NAME_LENGTH) == 0);
+
+    // A name of the full length takes the whole field, without a NUL
+    task = &report[SCHEDULER_REPORT_HEADER + 2 * SCHEDULER_REPORT_TASK];
+    CHECK(memcmp(&task[11], "NetworkStack", SCHEDULER_NAME_LENGTH) == 0);
+
+    return true;
+}
+
+static bool testService(void)
+{
+    std::vector<uint8_t> payload;
+
+    CHECK(service.init());
+
+    // A request is answered with a report on the stats channel
+    receive({SerialMuxChannel_Stats, 0, SerialMuxFlag_Request});
+    CHECK(mux.dispatch());
+    CHECK(service.getRequests() == 1);
+
+    CHECK(transmit(payload));
+    CHECK(payload.size() == SerialMux::HEADER_LENGTH + SCHEDULER_REPORT_HEADER);
+    CHECK(payload[0] == SerialMuxChannel_Stats);
+    CHECK(payload[1] == 0);
+    CHECK(payload[2] == SerialMuxFlag_Response);
+    CHECK(payload[3] == SCHEDULER_REPORT_VERSION);
+    CHECK(get32(&payload[3 + 15]) == configTOTAL_HEAP_SIZE);
+
+    // Anything else on the channel is ignored
+    receive({SerialMuxChannel_Stats, 1, SerialMuxFlag_Response});
+    CHECK(mux.dispatch());
+    CHECK(service.getRequests() == 1);
+    CHECK(serial.getTxFrames() == 0);
+
+    // The responses are numbered as any other frame of the channel
+    receive({SerialMuxChannel_Stats, 2, SerialMuxFlag_Request});
+    CHECK(mux.dispatch());
+    CHECK(transmit(payload));
+    CHECK(payload[1] == 1);
+
+    printf("Answered %u requests with %u byte reports\n",
+           service.getRequests(), (uint32_t) payload.size() - SerialMux::HEADER_LENGTH);
+
+    return true;
+}
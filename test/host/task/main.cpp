@@ -0,0 +1,165 @@
+/**
+ * @file       main.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host test of the StaticTask wrapper and periodic delays.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <thread>
+
+#include "Task.h"
+
+/*================================ define ===================================*/
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            printf("Error: %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+#define TEST_STACK_WORDS                    ( 128 )
+#define TEST_PRIORITY                       ( tskIDLE_PRIORITY + 1 )
+#define TEST_PERIOD_MS                      ( 20 )
+#define TEST_PERIODS                        ( 10 )
+#define TEST_WORK_MS                        ( 5 )
+#define TEST_TIMEOUT_MS                     ( 2000 )
+
+/*================================ typedef ==================================*/
+
+// A periodic loop that does some work on each period
+class TestPeriodic
+{
+public:
+    void run(void)
+    {
+        TickType_t wakeTime = Task::getTicks();
+
+        start = wakeTime;
+
+        for (uint32_t i = 0; i < TEST_PERIODS; i++)
+        {
+            // The work must not shift the next period
+            Task::delay(TEST_WORK_MS);
+            Task::delayUntil(wakeTime, TEST_PERIOD_MS);
+            periods++;
+        }
+
+        end = Task::getTicks();
+        done = true;
+    }
+public:
+    TickType_t start = 0;
+    TickType_t end = 0;
+    std::atomic<uint32_t> periods{0};
+    std::atomic<bool> done{false};
+};
+
+/*=============================== prototypes ================================*/
+
+static void testFunction(void);
+static bool wait(std::atomic<bool>& flag);
+static bool testStart(void);
+static bool testDelayUntil(void);
+
+/*=============================== variables =================================*/
+
+static StaticTask<TEST_STACK_WORDS, TEST_PRIORITY> functionTask("Function");
+static StaticTask<TEST_STACK_WORDS, TEST_PRIORITY> periodicTask("Periodic");
+
+static std::atomic<bool> functionDone(false);
+
+static TestPeriodic periodic;
+
+/*================================= public ==================================*/
+
+int main(void)
+{
+    bool status = true;
+
+    status &= testStart();
+    status &= testDelayUntil();
+
+    return (status ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+static void testFunction(void)
+{
+    functionDone = true;
+}
+
+static bool wait(std::atomic<bool>& flag)
+{
+    TickType_t start = Task::getTicks();
+
+    while (!flag)
+    {
+        if (Task::getTicks() - start > TEST_TIMEOUT_MS) return false;
+        std::this_thread::yield();
+    }
+
+    return true;
+}
+
+static bool testStart(void)
+{
+    CHECK(!functionTask.isStarted());
+
+    // An empty delegate does not start the task
+    CHECK(!functionTask.start(Delegate()));
+    CHECK(!functionTask.isStarted());
+
+    // A plain function runs and returns, parking the task
+    CHECK(functionTask.start(Delegate::create<testFunction>()));
+    CHECK(functionTask.isStarted());
+    CHECK(wait(functionDone));
+
+    // A task only starts once
+    CHECK(!functionTask.start(Delegate::create<testFunction>()));
+
+    // The stack belongs to the task object
+    CHECK(sizeof(functionTask) >= TEST_STACK_WORDS * sizeof(StackType_t));
+
+    return true;
+}
+
+static bool testDelayUntil(void)
+{
+    TickType_t elapsed;
+
+    // A member function runs a periodic loop
+    CHECK(periodicTask.start(Delegate::create<TestPeriodic, &TestPeriodic::run>(&periodic)));
+    CHECK(wait(periodic.done));
+    CHECK(periodic.periods == TEST_PERIODS);
+
+    // The loop keeps its period even though each period does some work
+    elapsed = periodic.end - periodic.start;
+    CHECK(elapsed >= TEST_PERIODS * TEST_PERIOD_MS);
+    CHECK(elapsed < TEST_PERIODS * (TEST_PERIOD_MS + TEST_WORK_MS));
+
+    // A wake time that has already passed does not block
+    TickType_t wakeTime = Task::getTicks() - 10 * TEST_PERIOD_MS;
+    TickType_t before = Task::getTicks();
+    Task::delayUntil(wakeTime, TEST_PERIOD_MS);
+    CHECK(Task::getTicks() - before < TEST_PERIOD_MS);
+    CHECK(before - wakeTime == 9 * TEST_PERIOD_MS);
+
+    printf("Ran %u periods of %u ms in %u ms\n", TEST_PERIODS, TEST_PERIOD_MS, (uint32_t) elapsed);
+
+    return true;
+}
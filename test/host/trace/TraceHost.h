@@ -0,0 +1,20 @@
+/**
+ * @file       TraceHost.h
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host stand-in for the timestamp of the event tracer.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+#ifndef TRACE_HOST_H_
+#define TRACE_HOST_H_
+
+#include <stdint.h>
+
+// Nanoseconds of the steady clock, wrapping as the cycle counter does
+uint32_t traceHostTimestamp(void);
+
+#endif /* TRACE_HOST_H_ */
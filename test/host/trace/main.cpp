@@ -0,0 +1,454 @@
+/**
+ * @file       main.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host test of the event tracer and its dump frames.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "UartHost.h"
+
+#include "CircularBuffer.h"
+#include "Hdlc.h"
+#include "Serial.h"
+#include "Trace.h"
+
+/*================================ define ===================================*/
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            printf("Error: %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+#define TEST_EVENTS                         ( 100 )
+#define TEST_THREADS                        ( 4 )
+#define TEST_THREAD_EVENTS                  ( 100000 )
+#define TEST_OVERHEAD_EVENTS                ( 1000000 )
+
+#define TEST_FRAME_LENGTH                   ( 256 )
+
+/*================================ typedef ==================================*/
+
+struct TaskName
+{
+    uint16_t id;
+    uint8_t priority;
+    std::string name;
+};
+
+// The trace as the host decoder sees it
+struct Dump
+{
+    uint32_t clock;
+    uint32_t count;
+    uint32_t first;
+    uint32_t overhead;
+    std::vector<TaskName> tasks;
+    std::vector<TraceRecord> records;
+    bool end;
+};
+
+/*=============================== prototypes ================================*/
+
+static uint32_t get16(const uint8_t* buffer);
+static uint32_t get32(const uint8_t* buffer);
+static bool decode(const uint8_t* frame, uint32_t length, Dump& dump);
+static bool read(Dump& dump);
+static bool testOrder(void);
+static bool testWrap(void);
+static bool testTasks(void);
+static bool testConcurrent(void);
+static bool testDump(void);
+static bool testOverhead(void);
+
+/*=============================== variables =================================*/
+
+static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+static Gpio rx, tx;
+static UartConfig config;
+static Uart uart(rx, tx, config);
+static Serial serial(uart);
+
+static uint8_t decoder_rx[TEST_FRAME_LENGTH];
+static uint8_t decoder_tx[16];
+static CircularBuffer decoderRx(decoder_rx, sizeof(decoder_rx));
+static CircularBuffer decoderTx(decoder_tx, sizeof(decoder_tx));
+static Hdlc decoder(decoderRx, decoderTx);
+
+/*================================= public ==================================*/
+
+uint32_t traceHostTimestamp(void)
+{
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+    return (uint32_t) std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+int main(void)
+{
+    bool status = true;
+
+    serial.init();
+
+    status &= testOrder();
+    status &= testWrap();
+    status &= testTasks();
+    status &= testConcurrent();
+    status &= testDump();
+    status &= testOverhead();
+
+    return (status ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+static uint32_t get16(const uint8_t* buffer)
+{
+    return (buffer[0] << 0) | (buffer[1] << 8);
+}
+
+static uint32_t get32(const uint8_t* buffer)
+{
+    return get16(buffer) | (get16(buffer + 2) << 16);
+}
+
+/**
+ * Decodes a dump frame as python/library/Trace.py does.
+ */
+static bool decode(const uint8_t* frame, uint32_t length, Dump& dump)
+{
+    CHECK(length >= 1);
+
+    switch (frame[0])
+    {
+        case 0xE0:
+            CHECK(length == 22);
+            CHECK(frame[1] == 'T' && frame[2] == 'R');
+            CHECK(frame[4] == sizeof(TraceRecord));
+            CHECK(get16(&frame[6]) == TRACE_LENGTH);
+            dump.clock = get32(&frame[8]);
+            dump.count = get32(&frame[12]);
+            dump.first = get32(&frame[16]);
+            dump.overhead = get16(&frame[20]);
+            dump.tasks.clear();
+            dump.records.clear();
+            dump.end = false;
+            break;
+        case 0xE1:
+            CHECK(length == (uint32_t) (2 + frame[1] * (3 + TRACE_NAME_LENGTH)));
+            for (uint32_t i = 0; i < frame[1]; i++)
+            {
+                const uint8_t* task = &frame[2 + i * (3 + TRACE_NAME_LENGTH)];
+                dump.tasks.push_back(TaskName{(uint16_t) get16(task), task[2],
+                                              std::string((const char*) &task[3], strnlen((const char*) &task[3], TRACE_NAME_LENGTH))});
+            }
+            break;
+        case 0xE2:
+            CHECK(length >= 5 && (length - 5) % sizeof(TraceRecord) == 0);
+            CHECK(get32(&frame[1]) == dump.first + dump.records.size());
+            for (uint32_t offset = 5; offset < length; offset += sizeof(TraceRecord))
+            {
+                dump.records.push_back(TraceRecord{get32(&frame[offset]), frame[offset + 4],
+                                                   frame[offset + 5], (uint16_t) get16(&frame[offset + 6])});
+            }
+            break;
+        case 0xE3:
+            CHECK(length == 1);
+            dump.end = true;
+            break;
+        default:
+            CHECK(false);
+    }
+
+    return true;
+}
+
+/**
+ * Reads the trace frame by frame, into a buffer of the size that
+ * Trace::dump uses.
+ */
+static bool read(Dump& dump)
+{
+    uint8_t frame[5 + 16 * sizeof(TraceRecord)];
+    uint32_t cursor = 0;
+    uint32_t length;
+    uint32_t frames = 0;
+
+    while ((length = Trace::getFrame(frame, sizeof(frame), cursor)) > 0)
+    {
+        CHECK(decode(frame, length, dump));
+        frames++;
+    }
+
+    CHECK(dump.end);
+    CHECK(dump.records.size() == dump.count - dump.first);
+    CHECK(frames == 3 + (dump.records.size() + 15) / 16);
+
+    return true;
+}
+
+static bool testOrder(void)
+{
+    Dump dump;
+
+    Trace::start();
+    CHECK(Trace::isEnabled());
+
+    for (uint32_t i = 0; i < TEST_EVENTS; i++)
+    {
+        TRACE_EVENT(TraceEvent_User, i, i * 3);
+    }
+
+    Trace::stop();
+    CHECK(!Trace::isEnabled());
+
+    // Events are not recorded while stopped
+    TRACE_EVENT(TraceEvent_User, 0, 0);
+    CHECK(Trace::getCount() == TEST_EVENTS + 3);
+
+    CHECK(read(dump));
+    CHECK(dump.clock == 1000000000);
+    CHECK(dump.first == 0);
+
+    // Two start records, the events in order, then the stop record
+    CHECK(dump.records[0].event == TraceEvent_Start);
+    CHECK(dump.records[1].event == TraceEvent_Start);
+    CHECK(dump.records[TEST_EVENTS + 2].event == TraceEvent_Stop);
+    CHECK(dump.overhead == dump.records[1].timestamp - dump.records[0].timestamp);
+
+    for (uint32_t i = 0; i < TEST_EVENTS; i++)
+    {
+        const TraceRecord& record = dump.records[2 + i];
+
+        CHECK(record.event == TraceEvent_User);
+        CHECK(record.id == i && record.arg == i * 3);
+        CHECK((int32_t) (record.timestamp - dump.records[1 + i].timestamp) >= 0);
+    }
+
+    return true;
+}
+
+static bool testWrap(void)
+{
+    Dump dump;
+
+    Trace::start();
+
+    // Overwrite the buffer a few times over
+    for (uint32_t i = 0; i < 3 * TRACE_LENGTH; i++)
+    {
+        TRACE_EVENT(TraceEvent_User, 0, i);
+    }
+
+    Trace::stop();
+
+    CHECK(Trace::getCount() == 3 * TRACE_LENGTH + 3);
+
+    // Only the newest records are kept, oldest first
+    CHECK(read(dump));
+    CHECK(dump.count == 3 * TRACE_LENGTH + 3);
+    CHECK(dump.first == dump.count - TRACE_LENGTH);
+    CHECK(dump.records.size() == TRACE_LENGTH);
+
+    for (uint32_t i = 0; i < TRACE_LENGTH - 1; i++)
+    {
+        CHECK(dump.records[i].arg == (uint16_t) (2 * TRACE_LENGTH + 1 + i));
+    }
+    CHECK(dump.records[TRACE_LENGTH - 1].event == TraceEvent_Stop);
+
+    return true;
+}
+
+static bool testTasks(void)
+{
+    uint32_t tasks[2];
+    Dump dump;
+
+    // The kernel hook keeps the task names whether recording or not
+    traceTaskCreate(&tasks[0], "SnifferTaskLongName", 2);
+
+    Trace::start();
+    traceTaskCreate(&tasks[1], "SerialTask", 1);
+    Trace::stop();
+
+    CHECK(read(dump));
+    CHECK(dump.tasks.size() == 2);
+    CHECK(dump.tasks[0].id == TRACE_ID(&tasks[0]));
+    CHECK(dump.tasks[0].name == "SnifferTaskL");
+    CHECK(dump.tasks[0].priority == 2);
+    CHECK(dump.tasks[1].name == "SerialTask");
+
+    // Only the task created while recording shows up in the records
+    CHECK(dump.records.size() == 4);
+    CHECK(dump.records[2].event == TraceEvent_TaskCreate);
+    CHECK(dump.records[2].id == 1 && dump.records[2].arg == TRACE_ID(&tasks[1]));
+
+    return true;
+}
+
+static bool testConcurrent(void)
+{
+    std::vector<std::thread> threads;
+    uint32_t last[TEST_THREADS];
+    Dump dump;
+
+    Trace::start();
+
+    // Threads play the role of interrupts that preempt each other
+    for (uint32_t t = 0; t < TEST_THREADS; t++)
+    {
+        threads.push_back(std::thread([t]()
+        {
+            for (uint32_t i = 0; i < TEST_THREAD_EVENTS; i++)
+            {
+                TRACE_EVENT(TraceEvent_User, t, i);
+            }
+        }));
+    }
+
+    for (uint32_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+    }
+
+    Trace::stop();
+
+    // No event is lost nor counted twice
+    CHECK(Trace::getCount() == TEST_THREADS * TEST_THREAD_EVENTS + 3);
+
+    // The kept records of each thread are in the order they were recorded
+    CHECK(read(dump));
+
+    for (uint32_t t = 0; t < TEST_THREADS; t++)
+    {
+        last[t] = 0xFFFFFFFF;
+    }
+
+    for (uint32_t i = 0; i < dump.records.size() - 1; i++)
+    {
+        const TraceRecord& record = dump.records[i];
+
+        CHECK(record.event == TraceEvent_User && record.id < TEST_THREADS);
+        CHECK(last[record.id] == 0xFFFFFFFF || (int16_t) (record.arg - last[record.id]) > 0);
+        last[record.id] = record.arg;
+    }
+
+    return true;
+}
+
+/**
+ * Dumps the trace over a serial port and decodes the HDLC frames that
+ * come out of the UART, as the host side does.
+ */
+static bool testDump(void)
+{
+    std::atomic<bool> done(false);
+    uint8_t frame[TEST_FRAME_LENGTH];
+    uint32_t length;
+    uint32_t frames = 0;
+    Dump dump;
+    bool status;
+
+    Trace::start();
+
+    for (uint32_t i = 0; i < 2 * TRACE_LENGTH; i++)
+    {
+        TRACE_EVENT(TraceEvent_User, 0, i);
+    }
+
+    uartTxDma = true;
+    uartTxData.clear();
+
+    // The TX interrupts, which drain the frames as Trace::dump queues them
+    std::thread interrupt([&done]()
+    {
+        while (!done || serial.getTxFrames() > 0)
+        {
+            if (serial.getTxFrames() > 0)
+            {
+                InterruptHandler::uartTx(uart);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    status = Trace::dump(serial);
+    done = true;
+    interrupt.join();
+
+    CHECK(status);
+    CHECK(!Trace::isEnabled());
+
+    decoder.rxOpen();
+
+    for (uint32_t i = 0; i < uartTxData.size(); i++)
+    {
+        CHECK(decoder.rxPut(uartTxData[i]) == HdlcResult_Ok);
+
+        if (decoder.getRxStatus() == HdlcStatus_Done)
+        {
+            CHECK(decoder.rxClose() == HdlcResult_Ok);
+            length = decoder.rxRead(frame, sizeof(frame));
+            CHECK(decode(frame, length, dump));
+            frames++;
+            decoder.rxOpen();
+        }
+    }
+
+    CHECK(dump.end);
+    CHECK(dump.count == 2 * TRACE_LENGTH + 3);
+    CHECK(dump.records.size() == TRACE_LENGTH);
+    CHECK(dump.records[TRACE_LENGTH - 1].event == TraceEvent_Stop);
+
+    printf("Dumped %u records in %u frames, %u bytes\n",
+           (uint32_t) dump.records.size(), frames, (uint32_t) uartTxData.size());
+
+    return true;
+}
+
+static bool testOverhead(void)
+{
+    std::chrono::steady_clock::time_point begin;
+    std::chrono::nanoseconds elapsed;
+
+    Trace::start();
+
+    begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < TEST_OVERHEAD_EVENTS; i++)
+    {
+        TRACE_EVENT(TraceEvent_User, 0, i);
+    }
+    elapsed = std::chrono::steady_clock::now() - begin;
+
+    Trace::stop();
+
+    // The host clock dominates here, on the target it is a register read
+    printf("Recorded %u events at %.1f ns per event, %u ns between back to back records\n",
+           TEST_OVERHEAD_EVENTS, (double) elapsed.count() / TEST_OVERHEAD_EVENTS,
+           Trace::getOverhead());
+
+    return true;
+}
@@ -0,0 +1,337 @@
+/**
+ * @file       main.cpp
+ * @author     Pere Tuset-Peiro (peretuset@openmote.com)
+ * @version    v0.1
+ * @date       May, 2016
+ * @brief      Host test of the WorkQueue deferred interrupt callbacks.
+ *
+ * @copyright  Copyright 2015, OpenMote Technologies, S.L.
+ *             This file is licensed under the GNU General Public License v2.
+ */
+
+/*================================ include ==================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "WorkQueue.h"
+
+/*================================ define ===================================*/
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            printf("Error: %s:%d: %s\n", __FILE__, __LINE__, #condition);   \
+            return false;                                                   \
+        }                                                                   \
+    } while (0)
+
+#define TEST_ITEMS                          ( 8 )
+#define TEST_THREADS                        ( 4 )
+#define TEST_ROUNDS                         ( 100000 )
+#define TEST_RESCHEDULES                    ( 100 )
+
+/*================================ typedef ==================================*/
+
+// A work item that records each time the daemon runs it
+class TestItem
+{
+public:
+    TestItem()
+    {
+        item.setCallback(Delegate::create<TestItem, &TestItem::run>(this));
+    }
+    void run(void)
+    {
+        if (blocking)
+        {
+            // Hold the daemon until the test lets it go
+            blocked = true;
+            while (blocking)
+            {
+                std::this_thread::yield();
+            }
+            blocked = false;
+        }
+
+        if (reschedules > 0)
+        {
+            // Schedule again while running, as an interrupt may do
+            reschedules--;
+            item.schedule();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            log.push_back(this);
+        }
+
+        runs++;
+    }
+public:
+    WorkItem item;
+    std::atomic<uint32_t> runs{0};
+    std::atomic<uint32_t> reschedules{0};
+    std::atomic<bool> blocking{false};
+    std::atomic<bool> blocked{false};
+
+    static std::mutex logMutex;
+    static std::vector<TestItem*> log;
+};
+
+/*=============================== prototypes ================================*/
+
+static void block(TestItem& item);
+static void settle(void);
+static bool testOrder(void);
+static bool testCoalesce(void);
+static bool testReschedule(void);
+static bool testConcurrent(void);
+static bool testTrigger(void);
+
+/*=============================== variables =================================*/
+
+std::mutex TestItem::logMutex;
+std::vector<TestItem*> TestItem::log;
+
+static TestItem items[TEST_ITEMS];
+
+/*================================= public ==================================*/
+
+int main(void)
+{
+    bool status = true;
+
+    status &= testOrder();
+    status &= testCoalesce();
+    status &= testReschedule();
+    status &= testConcurrent();
+    status &= testTrigger();
+
+    return (status ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/*=============================== protected =================================*/
+
+/*================================ private ==================================*/
+
+/**
+ * Keeps the daemon busy running the item, so that the items scheduled in
+ * the meantime pile up until the item is released.
+ */
+static void block(TestItem& item)
+{
+    item.blocking = true;
+    item.item.schedule();
+
+    while (!item.blocked)
+    {
+        std::this_thread::yield();
+    }
+}
+
+/**
+ * Waits until the daemon has run every pending item and clears the log.
+ */
+static void settle(void)
+{
+    bool pending = true;
+
+    while (pending)
+    {
+        std::this_thread::yield();
+
+        pending = false;
+        for (uint32_t i = 0; i < TEST_ITEMS; i++)
+        {
+            pending |= items[i].item.isPending() || items[i].blocked;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(TestItem::logMutex);
+    TestItem::log.clear();
+}
+
+static bool testOrder(void)
+{
+    block(items[0]);
+
+    // Items run in the order they are scheduled, whatever the list order
+    CHECK(items[3].item.schedule());
+    CHECK(items[1].item.schedule());
+    CHECK(items[2].item.schedule());
+
+    items[0].blocking = false;
+    settle();
+
+    block(items[0]);
+
+    CHECK(items[2].item.schedule());
+    CHECK(items[3].item.schedule());
+
+    items[0].blocking = false;
+    while (items[3].item.isPending() || items[0].blocked)
+    {
+        std::this_thread::yield();
+    }
+
+    std::lock_guard<std::mutex> lock(TestItem::logMutex);
+    CHECK(TestItem::log.size() == 3);
+    CHECK(TestItem::log[0] == &items[0]);
+    CHECK(TestItem::log[1] == &items[2]);
+    CHECK(TestItem::log[2] == &items[3]);
+    TestItem::log.clear();
+
+    return true;
+}
+
+static bool testCoalesce(void)
+{
+    uint32_t runs = items[1].runs;
+
+    settle();
+    block(items[0]);
+
+    // An item that is already pending runs once
+    CHECK(items[1].item.schedule());
+    CHECK(!items[1].item.schedule());
+    CHECK(!items[1].item.scheduleFromInterrupt());
+    items[1].item.getTrigger().execute();
+    CHECK(items[1].item.isPending());
+
+    items[0].blocking = false;
+    settle();
+
+    CHECK(items[1].runs == runs + 1);
+    CHECK(!items[1].item.isPending());
+
+    // From an interrupt handler too, through the trigger
+    block(items[0]);
+    CHECK(items[1].item.scheduleFromInterrupt());
+    items[1].item.getTrigger().execute();
+
+    items[0].blocking = false;
+    settle();
+
+    CHECK(items[1].runs == runs + 2);
+
+    return true;
+}
+
+static bool testReschedule(void)
+{
+    uint32_t runs = items[4].runs;
+
+    settle();
+
+    // The item is cleared before it runs, so it may schedule itself again
+    items[4].reschedules = TEST_RESCHEDULES;
+    CHECK(items[4].item.schedule());
+
+    settle();
+
+    CHECK(items[4].runs == runs + TEST_RESCHEDULES + 1);
+
+    return true;
+}
+
+static bool testConcurrent(void)
+{
+    std::vector<std::thread> threads;
+    std::atomic<uint32_t> accepted[TEST_ITEMS];
+    uint32_t runs[TEST_ITEMS];
+
+    settle();
+
+    for (uint32_t i = 0; i < TEST_ITEMS; i++)
+    {
+        accepted[i] = 0;
+        runs[i] = items[i].runs;
+    }
+
+    // Each thread plays the role of an interrupt scheduling random items
+    for (uint32_t t = 0; t < TEST_THREADS; t++)
+    {
+        threads.push_back(std::thread([t, &accepted]()
+        {
+            uint32_t seed = 0x3E7 + t;
+
+            for (uint32_t i = 0; i < TEST_ROUNDS; i++)
+            {
+                seed = seed * 1103515245 + 12345;
+                uint32_t index = (seed >> 16) % TEST_ITEMS;
+
+                if (items[index].item.schedule())
+                {
+                    accepted[index]++;
+                }
+            }
+        }));
+    }
+
+    for (uint32_t t = 0; t < TEST_THREADS; t++)
+    {
+        threads[t].join();
+    }
+
+    settle();
+
+    // Every schedule that was accepted ends up in exactly one run
+    for (uint32_t i = 0; i < TEST_ITEMS; i++)
+    {
+        CHECK(items[i].runs - runs[i] == accepted[i]);
+    }
+
+    printf("Scheduled %u times, the daemon ran %u items\n",
+           TEST_THREADS * TEST_ROUNDS, WorkQueue::getInstance().getExecuted());
+
+    return true;
+}
+
+static bool testTrigger(void)
+{
+    uint32_t runs = items[5].runs;
+    Delegate trigger;
+
+    settle();
+
+    // The trigger is what a peripheral runs from its interrupt
+    trigger = items[5].item.getTrigger();
+    CHECK(trigger.isValid());
+    trigger.execute();
+
+    settle();
+
+    CHECK(items[5].runs == runs + 1);
+
+    // A callback bound to the interrupt context is left untouched
+    WorkItem item;
+    Delegate callback = Delegate::create<TestItem, &TestItem::run>(&items[6]);
+
+    trigger = item.bind(callback, CallbackContext_Interrupt);
+    runs = items[6].runs;
+    trigger.execute();
+
+    CHECK(items[6].runs == runs + 1);
+    CHECK(!item.isPending());
+
+    // A deferred one runs once the daemon takes it
+    trigger = item.bind(callback, CallbackContext_Deferred);
+    trigger.execute();
+
+    while (items[6].runs == runs + 1)
+    {
+        std::this_thread::yield();
+    }
+
+    CHECK(items[6].runs == runs + 2);
+
+    settle();
+
+    return true;
+}
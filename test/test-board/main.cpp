@@ -60,10 +60,10 @@ static void txDone(void);
 
 static SemaphoreBinary rxSemaphore, txSemaphore;
 
-static PlainCallback rxInitCallback(&rxInit);
-static PlainCallback rxDoneCallback(&rxDone);
-static PlainCallback txInitCallback(&txInit);
-static PlainCallback txDoneCallback(&txDone);
+static Delegate rxInitCallback = Delegate::create<rxInit>();
+static Delegate rxDoneCallback = Delegate::create<rxDone>();
+static Delegate txInitCallback = Delegate::create<txInit>();
+static Delegate txDoneCallback = Delegate::create<txDone>();
 
 static uint8_t radio_buffer[PAYLOAD_LENGTH];
 static uint8_t* radio_ptr = radio_buffer;
@@ -116,7 +116,7 @@ static void prvRadioRxTask(void *pvParameters)
     static RadioResult result;
 
     // Configure the IEEE 802.15.4 radio
-    radio.setRxCallbacks(&rxInitCallback, &rxDoneCallback);
+    radio.setRxCallbacks(rxInitCallback, rxDoneCallback);
     radio.enable();
     radio.enableInterrupts();
     radio.setChannel(RADIO_CHANNEL);
@@ -160,7 +160,7 @@ static void prvRadioTxTask(void *pvParameters)
     static RadioResult result;
 
     // Configure the IEEE 802.15.4 radio
-    radio.setTxCallbacks(&txInitCallback, &txDoneCallback);
+    radio.setTxCallbacks(txInitCallback, txDoneCallback);
     radio.enable();
     radio.enableInterrupts();
     radio.setChannel(RADIO_CHANNEL);
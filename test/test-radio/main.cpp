@@ -67,10 +67,10 @@ static void txDone(void);
 
 static SemaphoreBinary rxSemaphore, txSemaphore;
 
-static PlainCallback rxInitCallback(&rxInit);
-static PlainCallback rxDoneCallback(&rxDone);
-static PlainCallback txInitCallback(&txInit);
-static PlainCallback txDoneCallback(&txDone);
+static Delegate rxInitCallback = Delegate::create<rxInit>();
+static Delegate rxDoneCallback = Delegate::create<rxDone>();
+static Delegate txInitCallback = Delegate::create<txInit>();
+static Delegate txDoneCallback = Delegate::create<txDone>();
 
 static uint8_t radio_buffer[PAYLOAD_LENGTH];
 static uint8_t* radio_ptr = radio_buffer;
@@ -93,8 +93,8 @@ int main (void)
     tps62730.setBypass();
 
     // Enable the IEEE 802.15.4 radio
-    radio.setTxCallbacks(&txInitCallback, &txDoneCallback);
-    radio.setRxCallbacks(&rxInitCallback, &rxDoneCallback);
+    radio.setTxCallbacks(txInitCallback, txDoneCallback);
+    radio.setRxCallbacks(rxInitCallback, rxDoneCallback);
     radio.enable();
     radio.enableInterrupts();
     radio.setChannel(RADIO_CHANNEL);